@@ -0,0 +1,195 @@
+"""Reads FESD recording sessions into numpy without copying the frames.
+
+The frames are decoded by FESDReader.dll (libFESDReader.so), the arrays handed out are views of its buffers:
+they stay valid until the next frame of the same camera is read, pass copy=True to keep them longer.
+
+    with Session("recordings/session.json") as session:
+        for frame in session.frames(0):
+            depth = frame.depth * session.cameras[0].depth_units   # meters
+            if frame.skeleton is not None:
+                joints, confidence = frame.skeleton
+"""
+
+import ctypes
+import os
+import sys
+from dataclasses import dataclass
+from typing import Iterator, Optional, Tuple
+
+import numpy as np
+
+_VERSION = 1
+_JOINT_COUNT = 8
+
+
+class _CameraInfo(ctypes.Structure):
+    _fields_ = [
+        ("name", ctypes.c_char_p),
+        ("type", ctypes.c_char_p),
+        ("file_name", ctypes.c_char_p),
+        ("width", ctypes.c_uint32),
+        ("height", ctypes.c_uint32),
+        ("depth_units", ctypes.c_float),
+        ("fx", ctypes.c_float),
+        ("fy", ctypes.c_float),
+        ("cx", ctypes.c_float),
+        ("cy", ctypes.c_float),
+        ("frame_count", ctypes.c_int64),
+    ]
+
+
+class _Frame(ctypes.Structure):
+    _fields_ = [
+        ("depth", ctypes.POINTER(ctypes.c_uint16)),
+        ("width", ctypes.c_uint32),
+        ("height", ctypes.c_uint32),
+        ("row_stride", ctypes.c_uint64),
+        ("dtype", ctypes.c_char_p),
+        ("timestamp", ctypes.c_double),
+        ("number", ctypes.c_uint32),
+        ("frame_index", ctypes.c_uint32),
+        ("has_skeleton", ctypes.c_int32),
+        ("has_floor", ctypes.c_int32),
+        ("joints", ctypes.POINTER(ctypes.c_float)),
+        ("confidence", ctypes.POINTER(ctypes.c_float)),
+        ("floor", ctypes.POINTER(ctypes.c_float)),
+    ]
+
+
+def _load_library(path: Optional[str] = None) -> ctypes.CDLL:
+    if path is None:
+        path = os.environ.get("FESD_READER_LIBRARY")
+    if path is None:
+        name = "FESDReader.dll" if sys.platform == "win32" else "libFESDReader.so"
+        # Next to this file or in the build output of the solution
+        here = os.path.dirname(os.path.abspath(__file__))
+        candidates = [os.path.join(here, name)] + [
+            os.path.join(here, "..", "bin", "x64", configuration, name) for configuration in ("Release", "Debug")
+        ]
+        path = next((candidate for candidate in candidates if os.path.exists(candidate)), name)
+
+    # OpenNI2.dll and the vcpkg dlls lie next to the reader, Python 3.8+ no longer searches PATH for them
+    if sys.platform == "win32" and os.path.dirname(path):
+        os.add_dll_directory(os.path.dirname(os.path.abspath(path)))
+
+    library = ctypes.CDLL(path)
+    library.fesd_version.restype = ctypes.c_int
+    library.fesd_open.argtypes = [ctypes.c_char_p]
+    library.fesd_open.restype = ctypes.c_void_p
+    library.fesd_close.argtypes = [ctypes.c_void_p]
+    library.fesd_close.restype = None
+    library.fesd_last_error.argtypes = [ctypes.c_void_p]
+    library.fesd_last_error.restype = ctypes.c_char_p
+    library.fesd_camera_count.argtypes = [ctypes.c_void_p]
+    library.fesd_camera_count.restype = ctypes.c_int
+    library.fesd_get_camera_info.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.POINTER(_CameraInfo)]
+    library.fesd_get_camera_info.restype = ctypes.c_int
+    library.fesd_joint_name.argtypes = [ctypes.c_int]
+    library.fesd_joint_name.restype = ctypes.c_char_p
+    library.fesd_next_frame.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.POINTER(_Frame)]
+    library.fesd_next_frame.restype = ctypes.c_int
+    library.fesd_rewind.argtypes = [ctypes.c_void_p, ctypes.c_int]
+    library.fesd_rewind.restype = ctypes.c_int
+
+    if library.fesd_version() != _VERSION:
+        raise RuntimeError(f"{path} has reader version {library.fesd_version()}, expected {_VERSION}")
+    return library
+
+
+@dataclass
+class CameraInfo:
+    name: str
+    type: str
+    file_name: str
+    width: int
+    height: int
+    depth_units: float
+    fx: float
+    fy: float
+    cx: float
+    cy: float
+    frame_count: int
+
+
+@dataclass
+class Frame:
+    # (height, width) uint16 depth in depth units
+    depth: np.ndarray
+    # Seconds since the first frame
+    timestamp: float
+    number: int
+    frame_index: int
+    # (joints (8, 3) in meters, confidence (8,)), None if no skeleton was detected
+    skeleton: Optional[Tuple[np.ndarray, np.ndarray]]
+    # Plane (nx, ny, nz, d), None if no floor was detected
+    floor: Optional[np.ndarray]
+
+
+class Session:
+    def __init__(self, session_file: str, library: Optional[str] = None):
+        self._library = _load_library(library)
+        self._handle = self._library.fesd_open(os.fsencode(session_file))
+        if not self._handle:
+            raise IOError(self._library.fesd_last_error(None).decode(errors="replace"))
+
+        self.cameras = []
+        for c in range(self._library.fesd_camera_count(self._handle)):
+            info = _CameraInfo()
+            self._check(self._library.fesd_get_camera_info(self._handle, c, ctypes.byref(info)))
+            self.cameras.append(CameraInfo(info.name.decode(), info.type.decode(), info.file_name.decode(), info.width, info.height,
+                                           info.depth_units, info.fx, info.fy, info.cx, info.cy, info.frame_count))
+
+        self.joint_names = [self._library.fesd_joint_name(j).decode() for j in range(_JOINT_COUNT)]
+        self._frame = _Frame()
+
+    def close(self):
+        if self._handle:
+            self._library.fesd_close(self._handle)
+            self._handle = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *_):
+        self.close()
+
+    def __del__(self):
+        self.close()
+
+    def _check(self, result: int) -> int:
+        if result < 0:
+            raise IOError(self._library.fesd_last_error(self._handle).decode(errors="replace"))
+        return result
+
+    def next_frame(self, camera: int, copy: bool = False) -> Optional[Frame]:
+        """Next frame of the camera, None at the end of the recording"""
+        frame = self._frame
+        if self._check(self._library.fesd_next_frame(self._handle, camera, ctypes.byref(frame))) == 0:
+            return None
+
+        # Rows may be padded, the strided view keeps it zero copy
+        rows = np.ctypeslib.as_array(ctypes.cast(frame.depth, ctypes.POINTER(ctypes.c_uint8)), shape=(frame.height * frame.row_stride,))
+        depth = np.lib.stride_tricks.as_strided(rows.view(np.dtype(frame.dtype.decode())), shape=(frame.height, frame.width),
+                                                strides=(frame.row_stride, 2), writeable=False)
+
+        skeleton = None
+        if frame.has_skeleton:
+            joints = np.ctypeslib.as_array(frame.joints, shape=(_JOINT_COUNT, 3))
+            confidence = np.ctypeslib.as_array(frame.confidence, shape=(_JOINT_COUNT,))
+            skeleton = (joints.copy(), confidence.copy()) if copy else (joints, confidence)
+
+        floor = None
+        if frame.has_floor:
+            floor = np.ctypeslib.as_array(frame.floor, shape=(4,))
+            floor = floor.copy() if copy else floor
+
+        return Frame(depth.copy() if copy else depth, frame.timestamp, frame.number, frame.frame_index, skeleton, floor)
+
+    def frames(self, camera: int, copy: bool = False) -> Iterator[Frame]:
+        """All frames of the camera from the first one"""
+        self.rewind(camera)
+        while (frame := self.next_frame(camera, copy)) is not None:
+            yield frame
+
+    def rewind(self, camera: int):
+        self._check(self._library.fesd_rewind(self._handle, camera))
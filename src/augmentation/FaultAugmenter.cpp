@@ -0,0 +1,324 @@
+#include "FaultAugmenter.h"
+
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <execution>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <json/json.h>
+
+#include <recording/SkeletonSidecar.h>
+
+namespace
+{
+	const char ShardMagic[8] = { 'F', 'E', 'S', 'D', 'A', 'U', 'G', '\0' };
+	const uint32_t ShardVersion = 1;
+
+	/// <summary>
+	/// SplitMix64 step, turns the seed and a shard index into well separated stream seeds
+	/// </summary>
+	uint64_t mixSeed(uint64_t seed, uint64_t stream)
+	{
+		uint64_t z = seed + (stream + 1) * 0x9E3779B97F4A7C15ull;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+}
+
+bool FaultAugmenter::addInput(const std::filesystem::path &path)
+{
+	if (std::filesystem::is_regular_file(path))
+	{
+		m_Sources.push_back(path);
+		return true;
+	}
+
+	if (!std::filesystem::is_directory(path))
+	{
+		mp_Logger->log("Augmentation input '" + path.string() + "' does not exist", Logger::LogLevel::ERR);
+		return false;
+	}
+
+	// Session files list the sidecars of their cameras
+	size_t found = m_Sources.size();
+	for (const auto &entry : std::filesystem::directory_iterator(path))
+	{
+		if (!entry.is_regular_file() || entry.path().extension() != ".json")
+			continue;
+
+		std::ifstream configJson(entry.path());
+		Json::Value root;
+		Json::CharReaderBuilder builder;
+		JSONCPP_STRING errs;
+
+		if (!parseFromStream(builder, configJson, &root, &errs))
+		{
+			mp_Logger->log(entry.path().string() + ": " + errs, Logger::LogLevel::WARNING);
+			continue;
+		}
+
+		for (const auto &camera : root["Cameras"])
+		{
+			if (camera.isMember("SkeletonFileName"))
+				m_Sources.push_back(path / camera["SkeletonFileName"].asString());
+		}
+	}
+
+	if (m_Sources.size() == found)
+	{
+		mp_Logger->log("No skeleton recordings in '" + path.string() + "'", Logger::LogLevel::WARNING);
+		return false;
+	}
+	return true;
+}
+
+bool FaultAugmenter::run(const std::filesystem::path &outputDirectory)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	std::error_code error;
+	std::filesystem::create_directories(outputDirectory, error);
+	if (error)
+	{
+		mp_Logger->log("Could not create '" + outputDirectory.string() + "': " + error.message(), Logger::LogLevel::ERR);
+		return false;
+	}
+
+	// Shards never span two sources, so every shard reads a single file from start to end
+	std::vector<Shard> shards;
+	Json::Value sources;
+	const uint32_t shardFrames = (uint32_t)std::max(m_Settings.ShardFrames, 1);
+	for (uint32_t s = 0; s < m_Sources.size(); s++)
+	{
+		SkeletonSidecar::Reader reader;
+		if (!reader.open(m_Sources[s]))
+		{
+			mp_Logger->log("Could not read skeleton recording '" + m_Sources[s].string() + "'", Logger::LogLevel::ERR);
+			return false;
+		}
+
+		for (uint32_t first = 0; first < reader.getRecordCount(); first += shardFrames)
+			shards.push_back({ s, first, std::min(shardFrames, reader.getRecordCount() - first) });
+
+		sources.append(m_Sources[s].string());
+	}
+
+	std::vector<uint32_t> indices(shards.size());
+	std::iota(indices.begin(), indices.end(), 0);
+
+	std::vector<uint64_t> writtenRecords(shards.size(), 0);
+	std::atomic<bool> isFailed{ false };
+	std::for_each(std::execution::par, indices.begin(), indices.end(), [&](uint32_t i)
+		{
+			char name[32];
+			snprintf(name, sizeof(name), "shard_%05u.fesdaug", i);
+			if (!writeShard(shards[i], i, outputDirectory / name, writtenRecords[i]))
+				isFailed = true;
+		});
+
+	if (isFailed)
+	{
+		mp_Logger->log("Augmentation failed, could not write to '" + outputDirectory.string() + "'", Logger::LogLevel::ERR);
+		return false;
+	}
+
+	uint64_t total = std::accumulate(writtenRecords.begin(), writtenRecords.end(), (uint64_t)0);
+	std::chrono::duration<double> runTime = std::chrono::high_resolution_clock::now() - start;
+
+	Json::Value manifest;
+	manifest["Version"] = ShardVersion;
+	manifest["Seed"] = Json::UInt64(m_Settings.Seed);
+	manifest["VariantsPerFrame"] = m_Settings.VariantsPerFrame;
+	manifest["KeepOriginal"] = m_Settings.KeepOriginal;
+	manifest["Distribution"] = m_Settings.Displacement == Distribution::Gaussian ? "Gaussian" : "Uniform";
+	manifest["Sigma"] = m_Settings.Sigma;
+	manifest["MinDisplacement"] = m_Settings.MinDisplacement;
+	manifest["MaxDisplacement"] = m_Settings.MaxDisplacement;
+	manifest["MaxFaultyJoints"] = m_Settings.MaxFaultyJoints;
+	for (int j = 0; j < Skeleton::JointCount; j++)
+	{
+		manifest["Joints"].append(Skeleton::JointNames[j]);
+		manifest["FaultProbability"].append(m_Settings.FaultProbability[j]);
+	}
+	manifest["Sources"] = sources;
+	manifest["ShardCount"] = (Json::UInt)shards.size();
+	manifest["RecordCount"] = Json::UInt64(total);
+
+	std::ofstream manifestJson(outputDirectory / "manifest.json");
+	Json::StreamWriterBuilder builder;
+	manifestJson << Json::writeString(builder, manifest);
+
+	mp_Logger->log("Wrote " + std::to_string(total) + " augmented skeletons from " + std::to_string(m_Sources.size()) + " recordings to " +
+		std::to_string(shards.size()) + " shards in " + std::to_string(runTime.count()) + "s");
+	return manifestJson.good();
+}
+
+bool FaultAugmenter::writeShard(const Shard &shard, uint32_t shardIndex, const std::filesystem::path &path, uint64_t &writtenRecords) const
+{
+	SkeletonSidecar::Reader reader;
+	if (!reader.open(m_Sources[shard.Source]))
+		return false;
+
+	std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		return false;
+
+	ShardHeader header{};
+	std::memcpy(header.Magic, ShardMagic, sizeof(ShardMagic));
+	header.Version = ShardVersion;
+	header.JointCount = Skeleton::JointCount;
+	header.RecordSize = sizeof(AugmentedRecord);
+	header.Seed = m_Settings.Seed;
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	std::mt19937_64 generator(mixSeed(m_Settings.Seed, shardIndex));
+
+	std::vector<AugmentedRecord> records;
+	records.reserve((size_t)shard.RecordCount * (m_Settings.VariantsPerFrame + 1));
+
+	SkeletonSidecar::SkeletonRecord recorded;
+	for (uint32_t r = shard.FirstRecord; r < shard.FirstRecord + shard.RecordCount; r++)
+	{
+		if (!reader.readRecord(r, recorded))
+			return false;
+
+		if (!(recorded.Flags & SkeletonSidecar::HasSkeleton))
+			continue;
+
+		auto original = SkeletonSidecar::Reader::toSkeleton(recorded);
+		for (int v = m_Settings.KeepOriginal ? 0 : 1; v <= m_Settings.VariantsPerFrame; v++)
+		{
+			auto skeleton = original;
+			uint32_t faultMask = v == 0 ? 0 : perturb(generator, skeleton);
+
+			AugmentedRecord &record = records.emplace_back();
+			record.Timestamp = recorded.Timestamp;
+			record.Source = shard.Source;
+			record.FrameIndex = recorded.FrameIndex;
+			record.Variant = (uint32_t)v;
+			record.FaultMask = faultMask;
+			for (int j = 0; j < Skeleton::JointCount; j++)
+			{
+				record.Joints[j][0] = skeleton.Joints[j].x;
+				record.Joints[j][1] = skeleton.Joints[j].y;
+				record.Joints[j][2] = skeleton.Joints[j].z;
+				record.Confidence[j] = skeleton.Confidence[j];
+			}
+		}
+	}
+
+	file.write(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(AugmentedRecord));
+
+	header.RecordCount = (uint32_t)records.size();
+	file.seekp(0);
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	writtenRecords = records.size();
+	return file.good();
+}
+
+uint32_t FaultAugmenter::perturb(std::mt19937_64 &generator, Skeleton &skeleton) const
+{
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::normal_distribution<float> normal(0.0f, 1.0f);
+
+	uint32_t faultMask = 0;
+	int faultCount = 0;
+	// Drawing in random order keeps the joint limit from favouring the first joints
+	std::array<int, Skeleton::JointCount> order;
+	std::iota(order.begin(), order.end(), 0);
+	std::shuffle(order.begin(), order.end(), generator);
+
+	for (int j : order)
+	{
+		if (faultCount == m_Settings.MaxFaultyJoints)
+			break;
+
+		if (unit(generator) < m_Settings.FaultProbability[j])
+		{
+			faultMask |= 1u << j;
+			faultCount++;
+		}
+	}
+
+	if (faultMask == 0)
+	{
+		std::discrete_distribution<int> joint(m_Settings.FaultProbability.begin(), m_Settings.FaultProbability.end());
+		faultMask = 1u << joint(generator);
+	}
+
+	for (int j = 0; j < Skeleton::JointCount; j++)
+	{
+		if (!(faultMask & (1u << j)))
+			continue;
+
+		// Uniform direction, the length follows the chosen distribution
+		glm::vec3 direction{ normal(generator), normal(generator), normal(generator) };
+		direction = glm::length(direction) > 1e-6f ? glm::normalize(direction) : glm::vec3{ 0.0f, 1.0f, 0.0f };
+
+		float length;
+		if (m_Settings.Displacement == Distribution::Gaussian)
+			length = std::max(std::abs(normal(generator)) * m_Settings.Sigma, m_Settings.MinDisplacement);
+		else
+			length = m_Settings.MinDisplacement + unit(generator) * (m_Settings.MaxDisplacement - m_Settings.MinDisplacement);
+
+		skeleton.Joints[j] += direction * length;
+	}
+
+	return faultMask;
+}
+
+int runAugmentationCommand(int argc, char **argv)
+{
+	Logger::Logger logger;
+	FaultAugmenter augmenter(&logger);
+	auto &settings = augmenter.m_Settings;
+
+	std::filesystem::path output;
+	bool hasInput = false;
+	try
+	{
+		for (int i = 0; i < argc; i++)
+		{
+			std::string argument = argv[i];
+			bool hasValue = i + 1 < argc;
+
+			if (argument == "--output" && hasValue)
+				output = argv[++i];
+			else if (argument == "--variants" && hasValue)
+				settings.VariantsPerFrame = std::max(std::stoi(argv[++i]), 1);
+			else if (argument == "--seed" && hasValue)
+				settings.Seed = std::stoull(argv[++i]);
+			else if (argument == "--shard-frames" && hasValue)
+				settings.ShardFrames = std::max(std::stoi(argv[++i]), 1);
+			else if (argument == "--sigma" && hasValue)
+				settings.Sigma = std::stof(argv[++i]);
+			else if (argument == "--uniform")
+				settings.Displacement = FaultAugmenter::Distribution::Uniform;
+			else if (argument.starts_with("--"))
+			{
+				logger.log("Unknown or incomplete option " + argument, Logger::LogLevel::ERR);
+				return 1;
+			}
+			else
+				hasInput |= augmenter.addInput(argument);
+		}
+	}
+	catch (const std::exception &e)
+	{
+		logger.log(std::string("Invalid option value: ") + e.what(), Logger::LogLevel::ERR);
+		return 1;
+	}
+
+	if (!hasInput || output.empty())
+	{
+		logger.log("Usage: FESD --augment <session directory or .skel>... --output <directory> [--variants n] [--seed n] [--shard-frames n] [--sigma m] [--uniform]",
+			Logger::LogLevel::ERR);
+		return 1;
+	}
+
+	return augmenter.run(output) ? 0 : 1;
+}
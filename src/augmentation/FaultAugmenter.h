@@ -0,0 +1,136 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <string>
+#include <random>
+#include <filesystem>
+
+#include <obj/Logger.h>
+#include <skeleton/Skeleton.h>
+
+/// <summary>
+/// Generates training data for the fault estimator from recorded skeleton sidecars.
+/// Every recorded skeleton yields several variants in which some joints are moved away from their position,
+/// the joints that were moved are the labels. The records are split into shards that are generated in parallel,
+/// each shard draws from its own random stream seeded with the seed and the shard index, so the output only
+/// depends on the settings and never on the number of threads.
+/// </summary>
+class FaultAugmenter
+{
+public:
+	enum class Distribution
+	{
+		/// <summary>
+		/// Displacement length |N(0, Sigma)|, at least MinDisplacement
+		/// </summary>
+		Gaussian,
+
+		/// <summary>
+		/// Displacement length uniform between MinDisplacement and MaxDisplacement
+		/// </summary>
+		Uniform
+	};
+
+	struct Settings
+	{
+		int VariantsPerFrame{ 4 };
+
+		/// <summary>
+		/// Also write the recorded skeleton without faults as variant 0
+		/// </summary>
+		bool KeepOriginal{ true };
+
+		uint64_t Seed{ 0x5EED };
+
+		/// <summary>
+		/// Recorded skeletons per output file, about 10 s at 30 fps so even a single session keeps all cores busy
+		/// </summary>
+		int ShardFrames{ 300 };
+
+		Distribution Displacement{ Distribution::Gaussian };
+		float Sigma{ 0.25f };
+		float MinDisplacement{ 0.1f };
+		float MaxDisplacement{ 0.6f };
+
+		/// <summary>
+		/// Chance of every joint to be moved in a variant, hands and feet are the most likely detection faults.
+		/// A variant without any drawn joint moves one joint picked by these weights.
+		/// </summary>
+		std::array<float, Skeleton::JointCount> FaultProbability{ 0.1f, 0.02f, 0.02f, 0.05f, 0.3f, 0.3f, 0.2f, 0.2f };
+		int MaxFaultyJoints{ 2 };
+	};
+
+	/// <summary>
+	/// One variant in a shard file. Shard files are a ShardHeader followed by RecordCount records.
+	/// </summary>
+	struct AugmentedRecord
+	{
+		/// <summary>
+		/// Seconds since the start of the recording
+		/// </summary>
+		double Timestamp;
+
+		/// <summary>
+		/// Index of the sidecar in the manifest
+		/// </summary>
+		uint32_t Source;
+		uint32_t FrameIndex;
+		uint32_t Variant;
+
+		/// <summary>
+		/// Bit j is set if joint j was moved
+		/// </summary>
+		uint32_t FaultMask;
+
+		float Joints[Skeleton::JointCount][3];
+		float Confidence[Skeleton::JointCount];
+	};
+	static_assert(sizeof(AugmentedRecord) == 152);
+
+	struct ShardHeader
+	{
+		char Magic[8];
+		uint32_t Version;
+		uint32_t JointCount;
+		uint32_t RecordSize;
+		uint32_t RecordCount;
+		uint64_t Seed;
+	};
+	static_assert(sizeof(ShardHeader) == 32);
+
+	FaultAugmenter(Logger::Logger *logger) : mp_Logger(logger) { }
+
+	/// <summary>
+	/// Adds a sidecar file or every sidecar referenced by the session files in a directory
+	/// </summary>
+	/// <returns>False if nothing was found</returns>
+	bool addInput(const std::filesystem::path &path);
+
+	/// <summary>
+	/// Writes the shards and a manifest.json to the output directory
+	/// </summary>
+	/// <returns>False if an input could not be read or an output could not be written</returns>
+	bool run(const std::filesystem::path &outputDirectory);
+
+	Settings m_Settings;
+private:
+	struct Shard
+	{
+		uint32_t Source;
+		uint32_t FirstRecord;
+		uint32_t RecordCount;
+	};
+
+	bool writeShard(const Shard &shard, uint32_t shardIndex, const std::filesystem::path &path, uint64_t &writtenRecords) const;
+	uint32_t perturb(std::mt19937_64 &generator, Skeleton &skeleton) const;
+
+	Logger::Logger *mp_Logger;
+	std::vector<std::filesystem::path> m_Sources;
+};
+
+/// <summary>
+/// Entry point of the headless batch job:
+/// FESD --augment &lt;session directory or .skel&gt;... --output &lt;directory&gt; [--variants n] [--seed n] [--shard-frames n] [--sigma m] [--uniform]
+/// </summary>
+/// <returns>Process exit code</returns>
+int runAugmentationCommand(int argc, char **argv);
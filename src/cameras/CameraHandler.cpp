@@ -15,8 +15,10 @@
 
 #include <utilities/Consts.h>
 #include <utilities/helper/ImGuiHelper.h>
+#include <GLCore/Profiler.h>
 
-CameraHandler::CameraHandler(Camera *cam, Renderer *renderer, Logger::Logger* logger) : mp_Camera(cam), mp_Renderer(renderer), mp_Logger(logger)
+CameraHandler::CameraHandler(Camera *cam, Renderer *renderer, Logger::Logger* logger) : mp_Camera(cam), mp_Renderer(renderer), mp_Logger(logger),
+    m_Catalog(logger, m_RecordingDirectory, { RealSenseCamera::getType(), OrbbecCamera::getType() })
 {
     if (openni::OpenNI::initialize() != openni::STATUS_OK) {
         auto msg = (std::string)"Initialization of OpenNi failed: " + openni::OpenNI::getExtendedError();
@@ -53,8 +55,9 @@ void CameraHandler::OnRender()
 {
     if (m_State == Recording) {
         m_RecordedSeconds = std::chrono::system_clock::now() - m_RecordingStart;
+        m_RecordedFrames = countRecordedFrames();
 
-        if (m_RecordedFrames > m_FrameLimit && m_LimitFrames) {
+        if (m_RecordedFrames >= m_FrameLimit && m_LimitFrames) {
             stopRecording();
             return;
         }
@@ -63,21 +66,33 @@ void CameraHandler::OnRender()
             stopRecording();
             return;
         }
-
-        m_RecordedFrames += 1;
     }
     
+    // Picks the frames the cameras show in this update
+    if (m_State == Playback)
+    {
+        PROFILE_SCOPE("Playback Scheduler");
+        m_PlaybackScheduler.update();
+    }
+
     // This sould probably be asynchronous/Multi-threaded/Parallel
     for (auto cam : m_DepthCameras)
     {
-        if (cam->m_IsEnabled || (m_State == Playback && !m_PlaybackPaused))
+        if (cam->m_IsEnabled || m_State == Playback)
         {
             if (m_State == Recording && !m_StreamWhileRecording) {
-                cam->saveFrame();
+                // Saved by the capture threads
+                continue;
             }
             else {
-                cam->OnUpdate();
-                cam->OnRender();
+                {
+                    PROFILE_SCOPE("Camera Update");
+                    cam->OnUpdate();
+                }
+                {
+                    PROFILE_SCOPE("Camera Render");
+                    cam->OnRender();
+                }
             }
         }
     }
@@ -104,9 +119,12 @@ void CameraHandler::OnImGuiRender()
     if (!m_DepthCameras.empty() && m_State != Playback) {
         ImGui::Begin("Recorder");
 
+        // The selection decides which files are written, it is fixed until the recording stops
+        ImGui::BeginDisabled(m_State == Recording);
         for (auto cam : m_DepthCameras) {
             ImGui::Checkbox(("Record " + cam->getCameraName()).c_str(), &cam->m_IsSelectedForRecording);
         }
+        ImGui::EndDisabled();
 
         showSessionSettings();
         showRecordingStats();
@@ -123,12 +141,13 @@ void CameraHandler::OnImGuiRender()
     ImGui::Begin("Recorded Sessions");
 
     if (m_State == Playback) {
-        ImGui::Checkbox("Pause Playback", &m_PlaybackPaused);
+        m_PlaybackScheduler.OnImGuiRender();
     }
 
     if (m_State == Playback && ImGui::Button("Stop Playback")) {
         mp_Logger->log("Stopping Playback");
         m_State = Streaming;
+        m_PlaybackScheduler.clear();
         for (auto cam : m_DepthCameras)
             delete cam;
         m_DepthCameras.clear();
@@ -140,6 +159,8 @@ void CameraHandler::OnImGuiRender()
         findRecordings();
     }
 
+    showRecordingFilter();
+
     if (m_Recordings.empty()) {
         ImGui::Text("No Recordings Found!");
     }
@@ -164,6 +185,9 @@ void CameraHandler::showSessionSettings() {
             ImGui::Checkbox("Stream While Recording", &m_StreamWhileRecording);
             ImGui::SameLine(); ImGuiHelper::HelpMarker("Show the Live Pointcloud while recording, might decrease performance.");
 
+            ImGui::Checkbox("Native Depth Recording", &m_RecordNativeDepth);
+            ImGui::SameLine(); ImGuiHelper::HelpMarker("Also writes the depth stream to a compressed .fdr file next to the vendor recording.");
+
             ImGui::Checkbox("Limit Frames", &m_LimitFrames);
 
             ImGui::BeginDisabled(!m_LimitFrames);
@@ -215,50 +239,119 @@ void CameraHandler::showRecordingStats() {
             ImGui::Text("Time Limit:");
             ImGui::ProgressBar(m_RecordedSeconds.count() / (float)m_TimeLimit);
         }
+
+        for (auto cam : m_DepthCameras) {
+            DepthRecording::Writer::Stats stats;
+            if (!cam->getRecordingStats(stats))
+                continue;
+
+            ImGui::Text("%s: %u frames, %u dropped, %.1f MB/s", cam->getCameraName().c_str(), stats.Frames, stats.DroppedFrames, stats.WriteThroughput / 1e6);
+            char queue[32];
+            snprintf(queue, sizeof(queue), "Queue %u / %u", stats.QueuedFrames, stats.QueueCapacity);
+            ImGui::ProgressBar(stats.QueueCapacity > 0 ? (float)stats.QueuedFrames / stats.QueueCapacity : 0.0f, ImVec2(-FLT_MIN, 0), queue);
+        }
         ImGui::EndDisabled();
 
         ImGui::TreePop();
     }
 }
 
+void CameraHandler::showRecordingFilter() {
+    if (!ImGui::TreeNode("Filter")) {
+        return;
+    }
+
+    bool isChanged = ImGui::InputText("Name", &m_RecordingFilter.Name);
+
+    const auto &types = m_Catalog.getCameraTypes();
+    for (int t = 0; t < types.size(); t++) {
+        if (t > 0) {
+            ImGui::SameLine();
+        }
+        bool isRequired = m_RecordingFilter.Cameras & (1u << t);
+        if (ImGui::Checkbox(types[t].c_str(), &isRequired)) {
+            m_RecordingFilter.Cameras ^= 1u << t;
+            isChanged = true;
+        }
+    }
+    ImGui::SameLine(); ImGuiHelper::HelpMarker("Only show sessions that recorded all checked camera types.");
+
+    float minDuration = (float)m_RecordingFilter.MinDuration;
+    if (ImGui::DragFloat("Min Duration (s)", &minDuration, 1.0f, 0.0f, 3600.0f, "%.0f")) {
+        m_RecordingFilter.MinDuration = minDuration;
+        isChanged = true;
+    }
+
+    isChanged |= ImGui::Combo("Recorded", &m_RecordingAge, "Any Time\0Last Day\0Last Week\0Last Month\0Last Year\0");
+
+    int sort = (int)m_RecordingSort;
+    if (ImGui::Combo("Sort By", &sort, "Date\0Duration\0Name\0")) {
+        m_RecordingSort = (SessionCatalog::SortKey)sort;
+        isChanged = true;
+    }
+    ImGui::SameLine();
+    isChanged |= ImGui::Checkbox("Descending", &m_SortDescending);
+
+    if (isChanged) {
+        filterRecordings();
+    }
+
+    ImGui::Text("Showing %d of %d sessions", (int)m_Recordings.size(), (int)m_Catalog.getSessions().size());
+    ImGui::TreePop();
+}
+
 void CameraHandler::showRecordings() {
-    for (auto recording : m_Recordings) {
-        bool isValid = false;
+    const auto &sessions = m_Catalog.getSessions();
+    for (auto index : m_Recordings) {
+        const auto &session = sessions[index];
+        bool isValid = !session.CameraTypes.empty() && !(session.CameraMask & SessionCatalog::UnknownCamera);
         std::string tabName = "(";
-        for (auto camera : recording["Cameras"]) {
-            if (camera["Type"].asString() == RealSenseCamera::getType()) {
+        for (const auto &type : session.CameraTypes) {
+            if (type == RealSenseCamera::getType()) {
                 tabName += "RS";
-                isValid = true;
             }
-            else if (camera["Type"].asString() == OrbbecCamera::getType()) {
+            else if (type == OrbbecCamera::getType()) {
                 tabName += "OB";
-                isValid = true;
             }
             else {
-                isValid = false;
                 tabName += "??";
             }
         }
 
         tabName += ") - ";
-        tabName += recording["Name"].asString();
+        tabName += session.Name;
 
+        ImGui::PushID((int)index);
         ImGui::BeginDisabled(!isValid);
         if (ImGui::TreeNode(tabName.c_str())) {
-            ImGui::Text("Duration (s): %.2f", recording["DurationInSec"].asFloat());
-            ImGui::Text("Recorded Frames: %d", recording["RecordedFrames"].asInt());
+            ImGui::Text("Duration (s): %.2f", session.Duration);
+            ImGui::Text("Recorded Frames: %d", session.RecordedFrames);
+
+            // Only the catalog summary is kept for every session, the camera files come from the session file
+            auto details = m_RecordingDetails.find(session.FileName);
+            if (details == m_RecordingDetails.end()) {
+                Json::Value root;
+                m_Catalog.load(session, root);
+                details = m_RecordingDetails.emplace(session.FileName, std::move(root)).first;
+            }
+            const Json::Value &recording = details->second;
 
             ImGui::Text("Cameras:");
             for (auto camera : recording["Cameras"]) {
                 if (ImGui::TreeNode(camera["Name"].asCString())) {
                     ImGui::Text("Type: %s", camera["Type"].asCString());
                     ImGui::Text("FileName: %s", camera["FileName"].asCString());
+                    if (camera.isMember("SkeletonFileName"))
+                        ImGui::Text("Skeletons: %s", camera["SkeletonFileName"].asCString());
+                    if (camera.isMember("DepthFileName"))
+                        ImGui::Text("Depth: %s", camera["DepthFileName"].asCString());
                     ImGui::TreePop();
                 }
             }
 
+            ImGui::BeginDisabled(recording["Cameras"].empty());
             if (ImGui::Button("Start Playback")) {
-                mp_Logger->log("Started Playback of Recording \"" + recording["Name"].asString() + "\"");
+                mp_Logger->log("Started Playback of Recording \"" + session.Name + "\"");
                 m_State = Playback;
 
                 clearCameras();
@@ -274,11 +367,15 @@ void CameraHandler::showRecordings() {
                         mp_Logger->log("Camera Type '" + camera["Type"].asString() + "' unknown", Logger::LogLevel::WARNING);
                     }
                 }
+
+                m_PlaybackScheduler.setCameras(m_DepthCameras);
             }
+            ImGui::EndDisabled();
 
             ImGui::TreePop();
         }
         ImGui::EndDisabled();
+        ImGui::PopID();
     }
 }
 
@@ -289,16 +386,57 @@ void CameraHandler::startRecording() {
     m_RecordedSeconds = std::chrono::duration<double>::zero();
 
     for (auto cam : m_DepthCameras) {
+        if (!cam->m_IsSelectedForRecording) {
+            continue;
+        }
+
         cam->m_IsEnabled = true;
+        cam->m_RecordNativeDepth = m_RecordNativeDepth;
         cam->startRecording(getFileSafeSessionName());
     }
 
+    if (!m_StreamWhileRecording)
+        startCapture();
+
     m_RecordingStart = std::chrono::system_clock::now();
 }
 
+void CameraHandler::startCapture() {
+    m_IsCapturing = true;
+    for (auto cam : m_DepthCameras) {
+        if (!cam->m_IsSelectedForRecording) {
+            continue;
+        }
+
+        m_CaptureThreads.emplace_back([this, cam] {
+            Profiler::setThreadName("Capture " + cam->getCameraName());
+            while (m_IsCapturing) {
+                try {
+                    PROFILE_SCOPE("Save Frame");
+                    cam->saveFrame();
+                }
+                catch (const std::exception &e) {
+                    mp_Logger->log("Capture of " + cam->getCameraName() + " stopped: " + e.what(), Logger::LogLevel::ERR);
+                    return;
+                }
+            }
+        });
+    }
+}
+
+void CameraHandler::stopCapture() {
+    // Every thread finishes the frame it waits for, at most the wait timeout of its camera
+    m_IsCapturing = false;
+    for (auto &thread : m_CaptureThreads)
+        thread.join();
+    m_CaptureThreads.clear();
+}
+
 #pragma warning(disable : 4996)
 void CameraHandler::stopRecording() {
     mp_Logger->log("Stopping recording");
+    stopCapture();
+    m_RecordedFrames = countRecordedFrames();
 
     m_RecordingEnd = std::chrono::system_clock::now();
 
@@ -312,6 +450,7 @@ void CameraHandler::stopRecording() {
     Json::Value root;
 
     root["Name"] = m_SessionName;
+    root["StartTime"] = (Json::Int64)std::chrono::duration_cast<std::chrono::seconds>(m_RecordingStart.time_since_epoch()).count();
     root["DurationInSec"] = m_RecordedSeconds.count();
     root["RecordedFrames"] = m_RecordedFrames;
 
@@ -319,7 +458,9 @@ void CameraHandler::stopRecording() {
 
     for (auto cam : m_DepthCameras) {
         if (cam->m_IsSelectedForRecording) {
-            cameras.append(cam->getCameraConfig());
+            auto config = cam->getCameraConfig();
+            config["RecordedFrames"] = cam->getRecordedFrames();
+            cameras.append(config);
         }
     }
     std::cout << cameras;
@@ -342,29 +483,31 @@ void CameraHandler::stopRecording() {
     } 
 }
 
-void CameraHandler::findRecordings() {
-    m_Recordings.clear();
-
-    for (const auto& entry : std::filesystem::directory_iterator(m_RecordingDirectory))
-    {
-        if (entry.is_regular_file() && entry.path().extension() == ".json") {
-            std::ifstream configJson(entry.path());
-            Json::Value root;
-
-            Json::CharReaderBuilder builder;
-
-            builder["collectComments"] = true;
-
-            JSONCPP_STRING errs;
-
-            if (!parseFromStream(builder, configJson, &root, &errs)) {
-                mp_Logger->log(errs, Logger::LogLevel::ERR);
-            }
-            else {
-                m_Recordings.push_back(root);
-            }
+int CameraHandler::countRecordedFrames() const {
+    // Every recorded camera has at least this many frames
+    int frames = -1;
+    for (auto cam : m_DepthCameras) {
+        if (cam->m_IsSelectedForRecording) {
+            int cameraFrames = (int)cam->getRecordedFrames();
+            frames = frames < 0 ? cameraFrames : std::min(frames, cameraFrames);
         }
     }
+    return std::max(frames, 0);
+}
+
+void CameraHandler::findRecordings() {
+    // Only new and changed session files are parsed, the rest comes from the catalog
+    m_Catalog.refresh();
+    m_RecordingDetails.clear();
+    filterRecordings();
 
     mp_Logger->log("Found " + std::to_string(m_Recordings.size()) + " Recordings in '" + m_RecordingDirectory.generic_string() + "'");
-}
\ No newline at end of file
+}
+
+void CameraHandler::filterRecordings() {
+    static const int64_t ageDays[] = { 0, 1, 7, 30, 365 };
+    auto now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    m_RecordingFilter.After = m_RecordingAge > 0 ? now - ageDays[m_RecordingAge] * 24 * 3600 : 0;
+
+    m_Recordings = m_Catalog.query(m_RecordingFilter, m_RecordingSort, m_SortDescending);
+}
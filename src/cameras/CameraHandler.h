@@ -1,9 +1,14 @@
 #pragma once
 #include <vector>
 #include <chrono>
+#include <thread>
+#include <atomic>
+#include <unordered_map>
 #include <json/json.h>
 
 #include "DepthCamera.h"
+#include "PlaybackScheduler.h"
+#include "recording/SessionCatalog.h"
 #include "GLCore/Camera.h"
 #include "GLCore/Renderer.h"
 #include "obj/Logger.h"
@@ -20,12 +25,30 @@ public:
 private:
 	void showSessionSettings();
 	void showRecordingStats();
+	void showRecordingFilter();
 	void showRecordings();
 	void startRecording();
 	void stopRecording();
 	void findRecordings();
 
+	/// <summary>
+	/// Applies the filter and sort order to the catalog, only the shown sessions are listed
+	/// </summary>
+	void filterRecordings();
+
+	/// <summary>
+	/// Saves frames on one thread per camera while recording without streaming, saveFrame blocks until the camera delivers
+	/// </summary>
+	void startCapture();
+	void stopCapture();
+
+	/// <summary>
+	/// Frames recorded by the slowest selected camera, counted where the frames are captured
+	/// </summary>
+	int countRecordedFrames() const;
+
 	void clearCameras() {
+		m_PlaybackScheduler.clear();
 		for (auto cam : m_DepthCameras)
 			delete cam;
 		m_DepthCameras.clear();
@@ -60,16 +83,39 @@ private:
 	Logger::Logger* mp_Logger;
 
 	std::vector<DepthCamera *> m_DepthCameras;
-	std::vector<Json::Value> m_Recordings;
+	PlaybackScheduler m_PlaybackScheduler;
+	SessionCatalog m_Catalog;
+
+	/// <summary>
+	/// Catalog indices of the shown sessions
+	/// </summary>
+	std::vector<uint32_t> m_Recordings;
+
+	/// <summary>
+	/// Full session files of the sessions opened in the list, parsed on demand
+	/// </summary>
+	std::unordered_map<std::string, Json::Value> m_RecordingDetails;
+
+	SessionCatalog::Filter m_RecordingFilter;
+	SessionCatalog::SortKey m_RecordingSort{ SessionCatalog::SortKey::Date };
+	bool m_SortDescending{ true };
+
+	/// <summary>
+	/// Index into the age choices of the filter, 0 for any age
+	/// </summary>
+	int m_RecordingAge{ 0 };
+
+	std::vector<std::thread> m_CaptureThreads;
+	std::atomic<bool> m_IsCapturing{ false };
 
 	std::chrono::time_point<std::chrono::system_clock> m_RecordingStart;
 	std::chrono::time_point<std::chrono::system_clock> m_RecordingEnd;
 	std::chrono::duration<double> m_RecordedSeconds;
 
 	bool m_StreamWhileRecording{ true };
+	bool m_RecordNativeDepth{ true };
 	bool m_LimitFrames{ false };
 	bool m_LimitTime{ true };
-	bool m_PlaybackPaused{ false };
 
 	int m_FrameLimit{ 100 };
 
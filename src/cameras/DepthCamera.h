@@ -1,8 +1,10 @@
 #pragma once
 #include <stdexcept>
+#include <cstdint>
 #include <string>
 #include <GLCore/GLObject.h>
 #include <json/json.h>
+#include <recording/DepthRecording.h>
 
 namespace GLObject
 {
@@ -28,6 +30,12 @@ public:
 	/// <returns>Pointer to first depth pixel</returns>
 	virtual const void *getDepth() = 0;
 
+	/// <summary>
+	/// Device frame number and timestamp (seconds, device clock) of the last depth frame from getDepth or saveFrame
+	/// </summary>
+	/// <returns>False if the camera does not number its frames</returns>
+	virtual bool getFrameInfo(uint64_t &/*frameNumber*/, double &/*timestamp*/) const { return false; }
+
 	/// <summary>
 	/// Gets the Type of the Camera
 	/// </summary>
@@ -80,6 +88,48 @@ public:
 	virtual float getIntrinsics(INTRINSICS intrin) const = 0;
 	virtual glm::mat3 getIntrinsics() const = 0;
 
+	/// <summary>
+	/// Direction of gravity in camera coordinates (x right, y down, z forward) if the camera has an IMU
+	/// </summary>
+	/// <returns>False if gravity is not available</returns>
+	virtual bool getGravity(glm::vec3 &/*gravity*/) const { return false; }
+
+	/// <returns>False if the camera does not record native depth right now</returns>
+	virtual bool getRecordingStats(DepthRecording::Writer::Stats &/*stats*/) const { return false; }
+
+	/// <returns>Frames captured since the last recording started, safe to call while the capture thread runs</returns>
+	virtual unsigned int getRecordedFrames() const { return 0; }
+
+	/// <returns>True if the camera plays back a recording</returns>
+	virtual bool isPlayback() const { return false; }
+
+	/// <summary>
+	/// Hands the playback to a PlaybackScheduler. The recording restarts and getDepth only returns
+	/// the frames picked by advancePlayback.
+	/// </summary>
+	virtual void setExternalPlayback(bool /*isExternal*/) { }
+
+	/// <summary>
+	/// Restarts the recording at its first frame
+	/// </summary>
+	virtual void restartPlayback() { }
+
+	/// <returns>Recording time of the next frame in seconds since the first frame, negative at the end of the recording</returns>
+	virtual double getNextPlaybackTime() { return -1.0; }
+
+	/// <summary>
+	/// Picks the last frame recorded at or before time (seconds since the first frame), waits until it is read
+	/// </summary>
+	virtual void advancePlayback(double /*time*/) { }
+
+	/// <summary>
+	/// Jumps to the frame recorded closest to time (seconds since the first frame), the next advancePlayback goes on from there
+	/// </summary>
+	virtual void seekPlayback(double /*time*/) { }
+
+	/// <returns>Recording time of the last frame in seconds since the first frame, 0 if unknown</returns>
+	virtual double getPlaybackDuration() const { return 0.0; }
+
 	/// <returns>Window Name (Display: *Camera Name*)</returns>
 	virtual std::string getWindowName() const = 0;
 
@@ -100,6 +150,11 @@ public:
 
 	bool m_IsEnabled{ true };
 	bool m_IsSelectedForRecording{ true };
+
+	/// <summary>
+	/// Also record the depth stream in the native format (see DepthRecording.h)
+	/// </summary>
+	bool m_RecordNativeDepth{ true };
 protected:
 	unsigned int m_CameraId;
 	Json::Value m_CameraInfromation;
@@ -0,0 +1,320 @@
+#include "OniPlayback.h"
+
+#include <algorithm>
+#include <cstring>
+#include <imgui.h>
+
+OniPlayback::OniPlayback(openni::Device &device, openni::VideoStream &stream, int prefetchFrames)
+	: mp_Stream(&stream), mp_Control(device.getPlaybackControl()), m_PrefetchFrames(std::max(prefetchFrames, 1))
+{
+	// Manual speed, every readFrame returns the next recorded frame and the reader thread sets the pace
+	mp_Control->setSpeed(-1.0f);
+	mp_Control->setRepeatEnabled(false);
+
+	m_FrameCount = mp_Control->getNumberOfFrames(stream);
+	m_Timestamps.assign(m_FrameCount, 0);
+
+	m_Thread = std::thread(&OniPlayback::run, this);
+}
+
+OniPlayback::~OniPlayback()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_Condition.notify_all();
+	m_Thread.join();
+}
+
+void OniPlayback::run()
+{
+	// Index of the frame the next readFrame returns
+	int position = 0;
+	bool isStart = false;
+	openni::VideoFrameRef frameRef;
+
+	while (true)
+	{
+		Frame frame;
+		unsigned int generation;
+		int seekFrame = -1;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this] { return m_Stop || m_SeekFrame >= 0 || (!m_IsAtEnd && (int)m_Queue.size() < m_PrefetchFrames); });
+			if (m_Stop)
+				return;
+
+			if (m_SeekFrame >= 0)
+			{
+				seekFrame = std::clamp(m_SeekFrame, 0, std::max(m_FrameCount - 1, 0));
+				m_SeekFrame = -1;
+				m_IsAtEnd = false;
+				for (auto &queued : m_Queue)
+					m_FreeFrames.push_back(std::move(queued));
+				m_Queue.clear();
+			}
+			else if (position >= m_FrameCount)
+			{
+				if (!m_Loop)
+				{
+					m_IsAtEnd = true;
+					m_Condition.notify_all();
+					continue;
+				}
+				seekFrame = 0;
+			}
+
+			if (!m_FreeFrames.empty())
+			{
+				frame = std::move(m_FreeFrames.back());
+				m_FreeFrames.pop_back();
+			}
+			generation = m_Generation;
+		}
+
+		if (seekFrame >= 0)
+		{
+			mp_Control->seek(*mp_Stream, seekFrame);
+			position = seekFrame;
+			isStart = true;
+		}
+
+		if (mp_Stream->readFrame(&frameRef) != openni::STATUS_OK)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_IsAtEnd = true;
+			m_FreeFrames.push_back(std::move(frame));
+			m_Condition.notify_all();
+			continue;
+		}
+
+		frame.Depth.resize((size_t)frameRef.getWidth() * frameRef.getHeight());
+		std::memcpy(frame.Depth.data(), frameRef.getData(), std::min((size_t)frameRef.getDataSize(), frame.Depth.size() * sizeof(uint16_t)));
+		frame.Timestamp = frameRef.getTimestamp();
+		frame.Index = position++;
+		frame.IsStart = isStart;
+		isStart = false;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (frame.Index < m_FrameCount)
+			m_Timestamps[frame.Index] = frame.Timestamp;
+
+		// A seek arrived while reading, the frame is from the old position
+		if (generation != m_Generation)
+		{
+			m_FreeFrames.push_back(std::move(frame));
+			continue;
+		}
+
+		m_Queue.push_back(std::move(frame));
+		m_Condition.notify_all();
+	}
+}
+
+void OniPlayback::takeFrame()
+{
+	if (!m_Current.Depth.empty())
+		m_FreeFrames.push_back(std::move(m_Current));
+
+	m_Current = std::move(m_Queue.front());
+	m_Queue.pop_front();
+	m_Condition.notify_all();
+}
+
+const uint16_t *OniPlayback::update()
+{
+	auto now = std::chrono::steady_clock::now();
+	double elapsed = std::chrono::duration<double, std::micro>(now - m_LastUpdate).count();
+	m_LastUpdate = now;
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_Queue.empty())
+	{
+		// The reader is behind, hold the clock at the shown frame
+		m_Clock = (double)m_Current.Timestamp;
+		return nullptr;
+	}
+
+	if (m_ShowNext || m_Queue.front().IsStart)
+	{
+		m_ShowNext = false;
+		takeFrame();
+		m_Clock = (double)m_Current.Timestamp;
+		return m_Current.Depth.data();
+	}
+
+	if (!m_IsPlaying)
+		return nullptr;
+
+	m_Clock += elapsed * m_Speed;
+
+	bool isNew = false;
+	while (!m_Queue.empty() && !m_Queue.front().IsStart && (double)m_Queue.front().Timestamp <= m_Clock)
+	{
+		takeFrame();
+		isNew = true;
+	}
+
+	if (m_Queue.empty())
+		m_Clock = std::min(m_Clock, (double)m_Current.Timestamp);
+
+	return isNew ? m_Current.Depth.data() : nullptr;
+}
+
+const uint16_t *OniPlayback::advanceTo(uint64_t timestamp, bool wait)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+
+	bool isNew = false;
+	while (true)
+	{
+		if (m_Queue.empty())
+		{
+			if (!wait || m_IsAtEnd)
+				break;
+
+			m_Condition.wait(lock, [this] { return !m_Queue.empty() || m_IsAtEnd || m_Stop; });
+			if (m_Stop)
+				break;
+			continue;
+		}
+
+		// Never run over a loop or seek, the next call starts there
+		auto &next = m_Queue.front();
+		if (next.Timestamp > timestamp || (isNew && next.IsStart))
+			break;
+
+		takeFrame();
+		isNew = true;
+	}
+
+	m_Clock = (double)m_Current.Timestamp;
+	return isNew ? m_Current.Depth.data() : nullptr;
+}
+
+bool OniPlayback::peekTimestamp(uint64_t &timestamp)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Condition.wait(lock, [this] { return !m_Queue.empty() || m_IsAtEnd || m_Stop; });
+	if (m_Queue.empty())
+		return false;
+
+	timestamp = m_Queue.front().Timestamp;
+	return true;
+}
+
+void OniPlayback::seek(int frameIndex)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_SeekFrame = frameIndex;
+		m_IsAtEnd = false;
+		m_Generation++;
+		for (auto &queued : m_Queue)
+			m_FreeFrames.push_back(std::move(queued));
+		m_Queue.clear();
+	}
+	m_ShowNext = true;
+	m_Condition.notify_all();
+}
+
+void OniPlayback::seekTime(uint64_t timestamp)
+{
+	int frame;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		// Timestamps grow with the index, frames not read yet are interpolated from their read neighbours
+		int known = -1;
+		for (int i = 0; i < m_FrameCount && (m_Timestamps[i] == 0 || m_Timestamps[i] <= timestamp); i++)
+		{
+			if (m_Timestamps[i] != 0)
+				known = i;
+		}
+
+		frame = std::max(known, 0);
+		if (known >= 0 && known + 1 < m_FrameCount && m_Timestamps[known] < timestamp)
+		{
+			// Assume the rate of the read frames
+			auto first = std::find_if(m_Timestamps.begin(), m_Timestamps.end(), [](uint64_t t) { return t != 0; }) - m_Timestamps.begin();
+			if (known > first)
+			{
+				double interval = (double)(m_Timestamps[known] - m_Timestamps[first]) / (double)(known - first);
+				frame = known + (int)((timestamp - m_Timestamps[known]) / interval + 0.5);
+			}
+		}
+	}
+	seek(std::min(frame, m_FrameCount - 1));
+}
+
+void OniPlayback::setLoop(bool loop)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Loop = loop;
+
+		// The reader waits while at the end, the last frames may still be queued
+		if (loop)
+			m_IsAtEnd = false;
+	}
+	m_Condition.notify_all();
+}
+
+bool OniPlayback::isLooping() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Loop;
+}
+
+uint64_t OniPlayback::getDuration() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto first = std::find_if(m_Timestamps.begin(), m_Timestamps.end(), [](uint64_t t) { return t != 0; });
+	auto last = std::find_if(m_Timestamps.rbegin(), m_Timestamps.rend(), [](uint64_t t) { return t != 0; }).base() - 1;
+	if (first == m_Timestamps.end() || last <= first)
+		return 0;
+
+	double interval = (double)(*last - *first) / (double)(last - first);
+	return (uint64_t)(interval * (m_FrameCount - 1));
+}
+
+bool OniPlayback::isAtEnd() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_IsAtEnd && m_Queue.empty();
+}
+
+void OniPlayback::OnImGuiRender()
+{
+	if (ImGui::Button(m_IsPlaying ? "Pause" : "Play"))
+		m_IsPlaying = !m_IsPlaying;
+
+	ImGui::SameLine();
+	ImGui::BeginDisabled(m_IsPlaying);
+	if (ImGui::Button("Step"))
+		step();
+	ImGui::EndDisabled();
+
+	ImGui::SameLine();
+	bool loop = isLooping();
+	if (ImGui::Checkbox("Loop", &loop))
+		setLoop(loop);
+
+	ImGui::SliderFloat("Speed", &m_Speed, 0.1f, 8.0f, "%.2fx", ImGuiSliderFlags_Logarithmic);
+
+	// Seeking on release keeps the reader from restarting on every pixel the slider moves
+	if (!m_IsScrubbing && m_Current.Index >= 0)
+		m_ScrubFrame = m_Current.Index;
+	ImGui::SliderInt("Frame", &m_ScrubFrame, 0, std::max(m_FrameCount - 1, 0));
+	m_IsScrubbing = ImGui::IsItemActive();
+	if (ImGui::IsItemDeactivatedAfterEdit())
+		seek(m_ScrubFrame);
+
+	int prefetched;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		prefetched = (int)m_Queue.size();
+	}
+	ImGui::Text("Time: %.2f s, Prefetched: %d / %d", m_Current.Timestamp * 1e-6, prefetched, m_PrefetchFrames);
+}
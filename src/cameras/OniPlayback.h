@@ -0,0 +1,143 @@
+#pragma once
+#include <OpenNI.h>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/// <summary>
+/// Plays back the depth stream of an .oni recording.
+/// The device runs in manual speed mode and a background thread reads the frames in order into a queue of
+/// prefetched frames, the recording is only seeked when the position jumps (scrubbing, looping).
+/// The shown frame follows a playback clock built from the recorded timestamps, so the recording plays at its
+/// recorded rate times the speed. Frames the reader can not deliver in time slow the clock down instead of being skipped.
+/// </summary>
+class OniPlayback
+{
+public:
+	OniPlayback(openni::Device &device, openni::VideoStream &stream, int prefetchFrames = 8);
+	~OniPlayback();
+
+	OniPlayback(const OniPlayback &) = delete;
+	OniPlayback &operator=(const OniPlayback &) = delete;
+
+	/// <summary>
+	/// Advances the playback clock by the time since the last call
+	/// </summary>
+	/// <returns>Depth of the new frame, nullptr if the shown frame did not change</returns>
+	const uint16_t *update();
+
+	/// <summary>
+	/// Shows the last frame recorded at or before the timestamp (microseconds), independent of the playback clock
+	/// </summary>
+	/// <param name="wait">Block until the frame is read, otherwise only prefetched frames are used</param>
+	/// <returns>Depth of the new frame, nullptr if the shown frame did not change</returns>
+	const uint16_t *advanceTo(uint64_t timestamp, bool wait);
+
+	/// <summary>
+	/// Recorded timestamp of the next frame (microseconds), waits until it is read
+	/// </summary>
+	/// <returns>False at the end of the recording</returns>
+	bool peekTimestamp(uint64_t &timestamp);
+
+	/// <returns>Depth of the shown frame, nullptr before the first frame</returns>
+	const uint16_t *getDepth() const { return m_Current.Depth.empty() ? nullptr : m_Current.Depth.data(); }
+
+	int getFrameCount() const { return m_FrameCount; }
+
+	/// <returns>Index of the shown frame</returns>
+	int getFrameIndex() const { return m_Current.Index; }
+
+	/// <returns>Recorded timestamp of the shown frame in microseconds</returns>
+	uint64_t getTimestamp() const { return m_Current.Timestamp; }
+
+	/// <returns>Time from the first to the last frame in microseconds, estimated from the rate of the frames read so far</returns>
+	uint64_t getDuration() const;
+
+	/// <summary>
+	/// Jumps to a frame, shown on the next update even while paused
+	/// </summary>
+	void seek(int frameIndex);
+
+	/// <summary>
+	/// Jumps to the frame recorded closest to the timestamp, using the timestamps of the frames read so far
+	/// </summary>
+	void seekTime(uint64_t timestamp);
+
+	/// <returns>True once the last frame was read and looping is off</returns>
+	bool isAtEnd() const;
+
+	void play() { m_IsPlaying = true; }
+	void pause() { m_IsPlaying = false; }
+	bool isPlaying() const { return m_IsPlaying; }
+
+	/// <summary>
+	/// Shows the next frame while paused
+	/// </summary>
+	void step() { m_ShowNext = true; }
+
+	/// <summary>
+	/// Start over after the last frame, a reader that already stopped at the end goes on at the first frame
+	/// </summary>
+	void setLoop(bool loop);
+	bool isLooping() const;
+
+	/// <summary>
+	/// Playback speed as a multiple of the recorded rate
+	/// </summary>
+	float m_Speed{ 1.0f };
+
+	void OnImGuiRender();
+private:
+	struct Frame
+	{
+		std::vector<uint16_t> Depth;
+		uint64_t Timestamp{ 0 };
+		int Index{ -1 };
+
+		/// <summary>
+		/// First frame after a seek or loop, the playback clock restarts at its timestamp
+		/// </summary>
+		bool IsStart{ false };
+	};
+
+	void run();
+
+	/// <summary>
+	/// Makes the oldest prefetched frame the shown one, m_Mutex must be held
+	/// </summary>
+	void takeFrame();
+
+	openni::VideoStream *mp_Stream;
+	openni::PlaybackControl *mp_Control;
+	const int m_PrefetchFrames;
+	int m_FrameCount{ 0 };
+
+	std::thread m_Thread;
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	bool m_Stop{ false };
+	bool m_IsAtEnd{ false };
+	bool m_Loop{ true };
+	int m_SeekFrame{ 0 };
+
+	// Incremented by every seek, frames read before it are dropped
+	unsigned int m_Generation{ 0 };
+
+	std::deque<Frame> m_Queue;
+	std::vector<Frame> m_FreeFrames;
+
+	// Recorded timestamp of every frame read so far, 0 if not read yet
+	std::vector<uint64_t> m_Timestamps;
+
+	// Only used by the consumer
+	Frame m_Current;
+	bool m_IsPlaying{ true };
+	bool m_ShowNext{ true };
+	double m_Clock{ 0.0 };
+	std::chrono::steady_clock::time_point m_LastUpdate{ std::chrono::steady_clock::now() };
+	int m_ScrubFrame{ 0 };
+	bool m_IsScrubbing{ false };
+};
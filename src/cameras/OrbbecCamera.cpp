@@ -3,6 +3,8 @@
 #include <iostream>
 #include <vector>
 #include <chrono>
+#include <cmath>
+#include <utility>
 
 #include <imgui.h>
 #include <filesystem>
@@ -95,10 +97,6 @@ OrbbecCamera::OrbbecCamera(Camera* cam, Renderer* renderer, Logger::Logger* logg
     m_RC = m_DepthStream.start();
     errorHandling("Couldn't start depth stream!");
 
-    mp_PlaybackController = m_Device.getPlaybackControl();
-
-    mp_PlaybackController->seek(m_DepthStream, 0);
-
     m_RC = m_DepthStream.readFrame(&m_DepthFrameRef);
     errorHandling("Depth Stream read failed!");
 
@@ -108,6 +106,9 @@ OrbbecCamera::OrbbecCamera(Camera* cam, Renderer* renderer, Logger::Logger* logg
     m_DepthWidth = m_DepthFrameRef.getWidth();
     m_DepthHeight = m_DepthFrameRef.getHeight();
 
+    // From here on only the playback reads the stream
+    mp_Playback = std::make_unique<OniPlayback>(m_Device, m_DepthStream);
+
     m_IsPlayback = true;
     m_IsEnabled = true;
 
@@ -117,6 +118,7 @@ OrbbecCamera::OrbbecCamera(Camera* cam, Renderer* renderer, Logger::Logger* logg
 OrbbecCamera::~OrbbecCamera() {
     mp_Logger->log("Shutting down [Orbbec] " + getCameraName());
 
+    mp_Playback.reset();
     m_DepthStream.stop();
     m_DepthStream.destroy();
 
@@ -125,9 +127,11 @@ OrbbecCamera::~OrbbecCamera() {
 
 const void *OrbbecCamera::getDepth()
 {
-    if (m_IsPlayback) {
-        mp_PlaybackController->seek(m_DepthStream, m_CurrentPlaybackFrame);
-        m_CurrentPlaybackFrame = ++m_CurrentPlaybackFrame % mp_PlaybackController->getNumberOfFrames(m_DepthStream);
+    if (m_IsExternalPlayback) {
+        return std::exchange(mp_ScheduledDepth, nullptr);
+    }
+    else if (m_IsPlayback) {
+        return mp_Playback->update();
     }
     else {
         int changedStreamDummy;
@@ -155,25 +159,91 @@ const void *OrbbecCamera::getDepth()
     return (uint16_t*)m_DepthFrameRef.getData();
 }
 
+bool OrbbecCamera::getFrameInfo(uint64_t &frameNumber, double &timestamp) const
+{
+    // Only live frames are read into the frame reference
+    if (m_IsPlayback || !m_DepthFrameRef.isValid())
+        return false;
+
+    frameNumber = (uint64_t)m_DepthFrameRef.getFrameIndex();
+    timestamp = (double)m_DepthFrameRef.getTimestamp() * 1e-6;
+    return true;
+}
+
 void OrbbecCamera::showCameraInfo() {
     if (ImGui::TreeNode(getCameraName().c_str())) {
         if (m_IsPlayback) {
             ImGui::Text("Recording");
-            float progress_saturated = (float)m_CurrentPlaybackFrame / (float)mp_PlaybackController->getNumberOfFrames(m_DepthStream);
             char buf[32];
-            sprintf(buf, "frame %d/%d", (int)(progress_saturated * mp_PlaybackController->getNumberOfFrames(m_DepthStream)), mp_PlaybackController->getNumberOfFrames(m_DepthStream));
-            ImGui::ProgressBar((float)m_CurrentPlaybackFrame / (float)mp_PlaybackController->getNumberOfFrames(m_DepthStream), ImVec2(0.f, 0.f), buf);
+            sprintf(buf, "frame %d/%d", mp_Playback->getFrameIndex() + 1, mp_Playback->getFrameCount());
+            ImGui::ProgressBar((float)(mp_Playback->getFrameIndex() + 1) / (float)std::max(mp_Playback->getFrameCount(), 1), ImVec2(0.f, 0.f), buf);
+            if (!m_IsExternalPlayback)
+                mp_Playback->OnImGuiRender();
         }
         else {
             ImGui::Text("Device: %s\n", m_DeviceInfo.getName());
             ImGui::Text("URI: %s\n", m_DeviceInfo.getUri());
             ImGui::Text("USB Product Id: %d\n", m_DeviceInfo.getUsbProductId());
             ImGui::Text("Vendor: %s\n", m_DeviceInfo.getVendor());
-            ImGui::TreePop();
         }
+        ImGui::TreePop();
     }
 }
 
+void OrbbecCamera::setExternalPlayback(bool isExternal)
+{
+    if (!m_IsPlayback)
+        return;
+
+    m_IsExternalPlayback = isExternal;
+    mp_Playback->setLoop(!isExternal);
+    restartPlayback();
+}
+
+void OrbbecCamera::restartPlayback()
+{
+    if (!m_IsPlayback)
+        return;
+
+    mp_Playback->seek(0);
+    mp_ScheduledDepth = nullptr;
+    mp_Playback->peekTimestamp(m_FirstTimestamp);
+}
+
+double OrbbecCamera::getNextPlaybackTime()
+{
+    uint64_t timestamp;
+    if (!m_IsPlayback || !mp_Playback->peekTimestamp(timestamp))
+        return -1.0;
+
+    return (double)(timestamp - m_FirstTimestamp) * 1e-6;
+}
+
+void OrbbecCamera::advancePlayback(double time)
+{
+    if (!m_IsPlayback)
+        return;
+
+    // Rounded so a time taken from getNextPlaybackTime hits its frame exactly
+    auto depth = mp_Playback->advanceTo(m_FirstTimestamp + (uint64_t)std::llround(time * 1e6), true);
+    if (depth)
+        mp_ScheduledDepth = depth;
+}
+
+void OrbbecCamera::seekPlayback(double time)
+{
+    if (!m_IsPlayback)
+        return;
+
+    mp_Playback->seekTime(m_FirstTimestamp + (uint64_t)std::llround(std::max(time, 0.0) * 1e6));
+    mp_ScheduledDepth = nullptr;
+}
+
+double OrbbecCamera::getPlaybackDuration() const
+{
+    return m_IsPlayback ? mp_Playback->getDuration() * 1e-6 : 0.0;
+}
+
 std::string OrbbecCamera::startRecording(std::string sessionName)
 {
     auto cameraName = getCameraName();
@@ -184,6 +254,23 @@ std::string OrbbecCamera::startRecording(std::string sessionName)
     m_CameraInfromation["Type"] = getType();
     m_CameraInfromation["FileName"] = filepath.filename().string();
 
+    auto skeletonPath = m_RecordingDirectory / (sessionName + "_" + cameraName + ".skel");
+    if (m_PointCloud->startSkeletonRecording(skeletonPath))
+        m_CameraInfromation["SkeletonFileName"] = skeletonPath.filename().string();
+    else
+        mp_Logger->log("Could not create " + skeletonPath.string(), Logger::LogLevel::ERR);
+
+    if (m_RecordNativeDepth) {
+        auto depthPath = m_RecordingDirectory / (sessionName + "_" + cameraName + ".fdr");
+        if (m_PointCloud->startDepthRecording(depthPath))
+            m_CameraInfromation["DepthFileName"] = depthPath.filename().string();
+        else
+            mp_Logger->log("Could not create " + depthPath.string(), Logger::LogLevel::ERR);
+    }
+    else {
+        m_CameraInfromation.removeMember("DepthFileName");
+    }
+
     m_RC = m_Recorder.create(filepath.string().c_str());
     errorHandling("Recorder Creation Failed!");
 
@@ -201,6 +288,7 @@ std::string OrbbecCamera::startRecording(std::string sessionName)
     }
 
     m_IsEnabled = true;
+    m_IsRecording = true;
 
     return filepath.filename().string();
 }
@@ -216,12 +304,29 @@ void OrbbecCamera::saveFrame() {
     // Get depth frame
     m_RC = m_DepthStream.readFrame(&m_DepthFrameRef);
     errorHandling("Depth Stream read failed!");
+
+    if (m_RC == openni::STATUS_OK)
+        m_PointCloud->recordDepth(m_DepthFrameRef.getData());
 }
 
 void OrbbecCamera::stopRecording()
 {
+    m_PointCloud->stopSkeletonRecording();
+    m_PointCloud->stopDepthRecording();
+
     m_Recorder.stop();
     m_Recorder.destroy();
+    m_IsRecording = false;
+}
+
+bool OrbbecCamera::getRecordingStats(DepthRecording::Writer::Stats &stats) const
+{
+    return m_PointCloud->getDepthRecordingStats(stats);
+}
+
+unsigned int OrbbecCamera::getRecordedFrames() const
+{
+    return m_PointCloud->getRecordedFrames();
 }
 
 void OrbbecCamera::OnUpdate()
@@ -237,7 +342,7 @@ void OrbbecCamera::OnRender()
 void OrbbecCamera::OnImGuiRender()
 {
     ImGui::Begin(getCameraName().c_str());
-    ImGui::BeginDisabled(!m_IsEnabled);
+    ImGui::BeginDisabled(!m_IsEnabled || m_IsRecording);
     m_PointCloud->OnImGuiRender();
     ImGui::EndDisabled();
     ImGui::End();
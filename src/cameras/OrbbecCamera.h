@@ -6,6 +6,7 @@
 #include <glm/glm.hpp>
 
 #include "DepthCamera.h"
+#include "OniPlayback.h"
 #include "GLCore/Renderer.h"
 #include "obj/Logger.h"
 
@@ -16,6 +17,7 @@ public:
 	~OrbbecCamera() override;
 
 	const void * getDepth() override;
+	bool getFrameInfo(uint64_t &frameNumber, double &timestamp) const override;
 
 	static std::string getType() { return "Orbbec"; }
 
@@ -40,6 +42,17 @@ public:
 	void saveFrame() override;
 	void stopRecording() override;
 
+	bool getRecordingStats(DepthRecording::Writer::Stats &stats) const override;
+	unsigned int getRecordedFrames() const override;
+
+	bool isPlayback() const override { return m_IsPlayback; }
+	void setExternalPlayback(bool isExternal) override;
+	void restartPlayback() override;
+	double getNextPlaybackTime() override;
+	void advancePlayback(double time) override;
+	void seekPlayback(double time) override;
+	double getPlaybackDuration() const override;
+
 	void OnUpdate() override;
 	void OnRender() override;
 	void OnImGuiRender() override;
@@ -86,10 +99,17 @@ private:
 	openni::Status m_RC;
 
 	openni::Recorder m_Recorder;
-	openni::PlaybackControl *mp_PlaybackController;
-	int m_CurrentPlaybackFrame{ 0 };
+
+	// The capture thread records into the point cloud, its panel stays disabled until the recording stops
+	bool m_IsRecording{ false };
+	std::unique_ptr<OniPlayback> mp_Playback;
 	bool m_IsPlayback{ false };
 
+	// Driven by a PlaybackScheduler, getDepth hands out the frame of the last advancePlayback once
+	bool m_IsExternalPlayback{ false };
+	const uint16_t *mp_ScheduledDepth{ nullptr };
+	uint64_t m_FirstTimestamp{ 0 };
+
 	Logger::Logger* mp_Logger;
 
 	const float m_hfov{ glm::radians(60.0f) };
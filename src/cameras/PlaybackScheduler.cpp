@@ -0,0 +1,153 @@
+#include "PlaybackScheduler.h"
+
+#include <algorithm>
+#include <imgui.h>
+
+#include <utilities/helper/ImGuiHelper.h>
+
+namespace
+{
+	/// <summary>
+	/// Longest wall clock step of the timeline, a hitch of the application does not skip recorded frames
+	/// </summary>
+	const double MaxStep = 0.1;
+}
+
+void PlaybackScheduler::setCameras(const std::vector<DepthCamera *> &cameras)
+{
+	m_Cameras.clear();
+	for (auto cam : cameras)
+	{
+		if (!cam->isPlayback())
+			continue;
+
+		cam->setExternalPlayback(true);
+		m_Cameras.push_back(cam);
+	}
+
+	m_Time = 0.0;
+	m_Framesets = 0;
+	m_Step = false;
+	m_LastUpdate = std::chrono::steady_clock::now();
+}
+
+void PlaybackScheduler::clear()
+{
+	m_Cameras.clear();
+}
+
+void PlaybackScheduler::restart()
+{
+	for (auto cam : m_Cameras)
+		cam->restartPlayback();
+
+	m_Time = 0.0;
+	m_Framesets = 0;
+}
+
+void PlaybackScheduler::seek(double time)
+{
+	for (auto cam : m_Cameras)
+		cam->seekPlayback(time);
+
+	// The next update jumps to the first frame after the seek
+	m_Time = time;
+	m_Step = true;
+}
+
+double PlaybackScheduler::getNextTime() const
+{
+	double next = -1.0;
+	for (auto cam : m_Cameras)
+	{
+		double time = cam->getNextPlaybackTime();
+		if (time >= 0.0 && (next < 0.0 || time < next))
+			next = time;
+	}
+	return next;
+}
+
+void PlaybackScheduler::update()
+{
+	auto now = std::chrono::steady_clock::now();
+	double elapsed = std::chrono::duration<double>(now - m_LastUpdate).count();
+	m_LastUpdate = now;
+
+	if (m_Cameras.empty() || (m_IsPaused && !m_Step))
+		return;
+
+	double next = getNextTime();
+	if (next < 0.0)
+	{
+		if (!m_Loop)
+		{
+			m_IsPaused = true;
+			m_Step = false;
+			return;
+		}
+
+		restart();
+		next = getNextTime();
+		if (next < 0.0)
+			return;
+	}
+
+	if (m_Mode == Mode::Lockstep || m_Step)
+		m_Time = next;
+	else
+	{
+		m_Time += std::min(elapsed, MaxStep) * m_Speed;
+		if (m_Time < next)
+			return;
+	}
+	m_Step = false;
+
+	// Cameras without a frame at this time keep their last one. The playbacks read ahead on their own threads,
+	// advancing mostly hands over a frame that is already read, a loop over one or two cameras is enough.
+	for (auto cam : m_Cameras)
+		cam->advancePlayback(m_Time);
+	m_Framesets++;
+}
+
+void PlaybackScheduler::OnImGuiRender()
+{
+	if (ImGui::Button(m_IsPaused ? "Play" : "Pause"))
+		m_IsPaused = !m_IsPaused;
+
+	ImGui::SameLine();
+	ImGui::BeginDisabled(!m_IsPaused);
+	if (ImGui::Button("Step"))
+		m_Step = true;
+	ImGui::EndDisabled();
+
+	ImGui::SameLine();
+	if (ImGui::Button("Restart"))
+		restart();
+
+	ImGui::SameLine();
+	ImGui::Checkbox("Loop", &m_Loop);
+
+	int mode = (int)m_Mode;
+	ImGui::RadioButton("Real Time", &mode, (int)Mode::RealTime);
+	ImGui::SameLine();
+	ImGui::RadioButton("Lockstep", &mode, (int)Mode::Lockstep);
+	ImGui::SameLine(); ImGuiHelper::HelpMarker("Lockstep shows every recorded frameset once per rendered frame, the result does not depend on the frame rate.");
+	m_Mode = (Mode)mode;
+
+	ImGui::BeginDisabled(m_Mode == Mode::Lockstep);
+	ImGui::SliderFloat("Speed", &m_Speed, 0.1f, 8.0f, "%.2fx", ImGuiSliderFlags_Logarithmic);
+	ImGui::EndDisabled();
+
+	double duration = 0.0;
+	for (auto cam : m_Cameras)
+		duration = std::max(duration, cam->getPlaybackDuration());
+
+	if (!m_IsScrubbing)
+		m_ScrubTime = (float)m_Time;
+	ImGui::SliderFloat("Time", &m_ScrubTime, 0.0f, (float)duration, "%.2f s");
+	m_IsScrubbing = ImGui::IsItemActive();
+	if (ImGui::IsItemDeactivatedAfterEdit())
+		seek(m_ScrubTime);
+
+	ImGui::Text("Time: %.3f s, Framesets: %d, Cameras: %d", m_Time, m_Framesets, (int)m_Cameras.size());
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include <chrono>
+
+#include "DepthCamera.h"
+
+/// <summary>
+/// Plays back the recordings of a session on one shared timeline.
+/// Every recording is timed relative to its own first frame, the clocks of .bag and .oni files are unrelated.
+/// In real time the timeline follows the wall clock times the speed, in lockstep it jumps to the next recorded
+/// frame of any camera on every update, so every recorded frameset is shown exactly once and in the same order on every run.
+/// </summary>
+class PlaybackScheduler
+{
+public:
+	enum class Mode
+	{
+		RealTime,
+		Lockstep
+	};
+
+	/// <summary>
+	/// Takes over the playback of the cameras, all recordings restart at their first frame
+	/// </summary>
+	void setCameras(const std::vector<DepthCamera *> &cameras);
+
+	/// <summary>
+	/// Releases the cameras, call before they are deleted
+	/// </summary>
+	void clear();
+
+	/// <summary>
+	/// Advances the timeline, the cameras get their frames for it through getDepth
+	/// </summary>
+	void update();
+
+	/// <summary>
+	/// Restarts all recordings at their first frame
+	/// </summary>
+	void restart();
+
+	/// <summary>
+	/// Moves all recordings to the time (seconds since their first frame), shown on the next update even while paused
+	/// </summary>
+	void seek(double time);
+
+	void OnImGuiRender();
+
+	bool m_IsPaused{ false };
+	bool m_Loop{ true };
+	float m_Speed{ 1.0f };
+	Mode m_Mode{ Mode::RealTime };
+private:
+	/// <returns>Time of the next recorded frame of any camera, negative if all recordings ended</returns>
+	double getNextTime() const;
+
+	std::vector<DepthCamera *> m_Cameras;
+
+	/// <summary>
+	/// Seconds since the first frame of the recordings
+	/// </summary>
+	double m_Time{ 0.0 };
+	int m_Framesets{ 0 };
+	bool m_Step{ false };
+
+	// Seeking on release keeps the playbacks from restarting on every pixel the slider moves
+	float m_ScrubTime{ 0.0f };
+	bool m_IsScrubbing{ false };
+	std::chrono::steady_clock::time_point m_LastUpdate{ std::chrono::steady_clock::now() };
+};
@@ -1,5 +1,7 @@
 #include "RealsenseCamera.h"
 #include <iostream>
+#include <thread>
+#include <chrono>
 #include <exception>
 #include "obj/PointCloud.h"
 #include <utilities/Consts.h>
@@ -35,10 +37,14 @@ RealSenseCamera::RealSenseCamera(rs2::context *ctx, rs2::device *device, Camera
 	m_CameraId = camera_id;
 
 	printDeviceInfo();
-	m_Device.query_sensors();
 	m_Config.enable_device(m_Device.get_info(RS2_CAMERA_INFO_SERIAL_NUMBER));
-	
+
+	// The pipeline only streams depth and color, the accelerometer is read by its own sensor callback
+	m_Config.enable_stream(RS2_STREAM_DEPTH);
+	m_Config.enable_stream(RS2_STREAM_COLOR);
+
 	auto profile = mp_Pipe->start(m_Config);
+	startMotionSensor();
 
 	rs2::frameset data = mp_Pipe->wait_for_frames(); // Wait for next set of frames from the camera
 	rs2::frame depth = data.get_depth_frame();
@@ -57,7 +63,8 @@ RealSenseCamera::RealSenseCamera(rs2::context *ctx, rs2::device *device, Camera
 }
 
 RealSenseCamera::RealSenseCamera(Camera* cam, Renderer* renderer, Logger::Logger* logger, std::filesystem::path recording) :
-	mp_Logger(logger)
+	mp_Logger(logger),
+	m_RecordingPath(recording)
 {
 	rs2::context ctx;
 	mp_Pipe = std::make_shared<rs2::pipeline>();
@@ -72,9 +79,13 @@ RealSenseCamera::RealSenseCamera(Camera* cam, Renderer* renderer, Logger::Logger
 	mp_Pipe->start(cfg); //File will be opened in read mode at this point
 	m_Device = mp_Pipe->get_active_profile().get_device();
 
-	// Wait for first frame
+	// Wait for first frame, bags recorded with the IMU in the pipeline also hold framesets without depth
 	rs2::frameset data = mp_Pipe->wait_for_frames(); 
 	rs2::frame depth = data.get_depth_frame();
+	while (!depth) {
+		data = mp_Pipe->wait_for_frames();
+		depth = data.get_depth_frame();
+	}
 
 	// Get Intrinsics
 	auto depth_profile = depth.get_profile().as<rs2::video_stream_profile>();
@@ -91,6 +102,16 @@ RealSenseCamera::RealSenseCamera(Camera* cam, Renderer* renderer, Logger::Logger
 RealSenseCamera::~RealSenseCamera() {
 	mp_Logger->log("Shutting down [Realsense] " + getCameraName());
 
+	if (m_HasMotionSensor) {
+		try {
+			m_MotionSensor.stop();
+			m_MotionSensor.close();
+		}
+		catch (...) {
+			mp_Logger->log("An exception occured while stopping the IMU of [Realsense] Camera " + getCameraName());
+		}
+	}
+
 	if (m_Device.as<rs2::recorder>()) {
 		stopRecording();
 	}
@@ -105,26 +126,226 @@ RealSenseCamera::~RealSenseCamera() {
 
 const void *RealSenseCamera::getDepth()
 {
-	if (!m_Device.as<rs2::playback>()) {
+	if (m_IsExternalPlayback) {
+		if (!m_HasScheduledDepth)
+			return nullptr;
+
+		m_HasScheduledDepth = false;
+		auto depth = m_ScheduledFrames.get_depth_frame();
+		return depth ? depth.get_data() : nullptr;
+	}
+	else if (!m_Device.as<rs2::playback>()) {
 		rs2::frameset data = mp_Pipe->wait_for_frames(); // Wait for next set of frames from the camera
 		rs2::depth_frame depth = data.get_depth_frame();
 		if (m_Device.as<rs2::recorder>())
 			rs2::video_frame color = data.get_color_frame();
+		if (!depth)
+			return nullptr;
+
+		updateFrameInfo(depth);
 		return depth.get_data();
 	}
 	else {
 		rs2::frameset frames;
 		if (mp_Pipe->poll_for_frames(&frames)) // Check if new frames are ready
 		{
+			// Bags recorded with the IMU in the pipeline also hold framesets without depth
+			updateGravity(frames);
 			rs2::depth_frame depth = frames.get_depth_frame();
-			rs2::video_frame color = frames.get_color_frame();
-			return depth.get_data();
+			return depth ? depth.get_data() : nullptr;
 		}
 
 		return nullptr;
 	}
 }
 
+void RealSenseCamera::updateFrameInfo(const rs2::frame &depth)
+{
+	m_FrameNumber = depth.get_frame_number();
+	m_FrameTimestamp = depth.get_timestamp() * 1e-3;
+	m_HasFrameInfo = true;
+}
+
+bool RealSenseCamera::getFrameInfo(uint64_t &frameNumber, double &timestamp) const
+{
+	if (!m_HasFrameInfo)
+		return false;
+
+	frameNumber = m_FrameNumber;
+	timestamp = m_FrameTimestamp;
+	return true;
+}
+
+void RealSenseCamera::startMotionSensor()
+{
+	for (auto &&sensor : m_Device.query_sensors())
+	{
+		if (!sensor.is<rs2::motion_sensor>())
+			continue;
+
+		for (auto &&profile : sensor.get_stream_profiles())
+		{
+			if (profile.stream_type() != RS2_STREAM_ACCEL)
+				continue;
+
+			try {
+				sensor.open(profile);
+				sensor.start([this](rs2::frame frame) {
+					if (auto motion = frame.as<rs2::motion_frame>())
+						updateAcceleration(motion);
+				});
+				m_MotionSensor = sensor;
+				m_HasMotionSensor = true;
+			}
+			catch (const rs2::error &e) {
+				mp_Logger->log("Could not start the IMU of " + getCameraName() + ": " + e.what(), Logger::LogLevel::WARNING);
+			}
+			return;
+		}
+	}
+}
+
+void RealSenseCamera::updateGravity(const rs2::frameset &frames)
+{
+	auto accel = frames.first_or_default(RS2_STREAM_ACCEL);
+	if (accel)
+		updateAcceleration(accel.as<rs2::motion_frame>());
+}
+
+void RealSenseCamera::updateAcceleration(const rs2::motion_frame &frame)
+{
+	auto data = frame.get_motion_data();
+	glm::vec3 acceleration{ data.x, data.y, data.z };
+
+	// Smooths out vibrations, the camera is assumed to move slowly
+	const float alpha = 0.05f;
+	std::lock_guard<std::mutex> lock(m_AccelerationMutex);
+	m_Acceleration = m_HasAcceleration ? glm::mix(m_Acceleration, acceleration, alpha) : acceleration;
+	m_HasAcceleration = true;
+}
+
+bool RealSenseCamera::getGravity(glm::vec3 &gravity) const
+{
+	std::lock_guard<std::mutex> lock(m_AccelerationMutex);
+	if (!m_HasAcceleration || glm::dot(m_Acceleration, m_Acceleration) == 0.0f)
+		return false;
+
+	gravity = -glm::normalize(m_Acceleration);
+	return true;
+}
+
+void RealSenseCamera::setExternalPlayback(bool isExternal)
+{
+	if (!isPlayback())
+		return;
+
+	m_IsExternalPlayback = isExternal;
+	restartPlayback();
+}
+
+void RealSenseCamera::restartPlayback()
+{
+	if (!isPlayback())
+		return;
+
+	mp_Pipe->stop();
+	mp_Pipe = std::make_shared<rs2::pipeline>();
+
+	// A scheduled recording does not repeat, the scheduler decides when it starts over
+	rs2::config cfg;
+	cfg.enable_device_from_file(m_RecordingPath.string(), !m_IsExternalPlayback);
+	mp_Pipe->start(cfg);
+	m_Device = mp_Pipe->get_active_profile().get_device();
+
+	// Outside of real time the file is only read as fast as the frames are consumed, no frame is dropped
+	m_Device.as<rs2::playback>().set_real_time(!m_IsExternalPlayback);
+
+	m_ScheduledFrames = rs2::frameset();
+	m_HasScheduledDepth = false;
+	m_HasNextFrames = m_IsExternalPlayback && readPlaybackFrames(m_NextFrames);
+	m_FirstTimestamp = m_HasNextFrames ? m_NextFrames.get_depth_frame().get_timestamp() : 0.0;
+}
+
+bool RealSenseCamera::readPlaybackFrames(rs2::frameset &frames)
+{
+	auto playback = m_Device.as<rs2::playback>();
+	const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+
+	while (std::chrono::steady_clock::now() < timeout)
+	{
+		if (mp_Pipe->poll_for_frames(&frames))
+		{
+			if (frames.get_depth_frame())
+				return true;
+
+			updateGravity(frames);
+			continue;
+		}
+
+		// Frames still queued when the file ended were read above
+		if (playback.current_status() == RS2_PLAYBACK_STATUS_STOPPED)
+			return mp_Pipe->poll_for_frames(&frames) && frames.get_depth_frame();
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	mp_Logger->log(getCameraName() + " timed out reading " + m_RecordingPath.filename().string(), Logger::LogLevel::WARNING);
+	return false;
+}
+
+double RealSenseCamera::getNextPlaybackTime()
+{
+	if (!m_HasNextFrames)
+		return -1.0;
+
+	// Frame timestamps are in milliseconds
+	return (m_NextFrames.get_depth_frame().get_timestamp() - m_FirstTimestamp) * 1e-3;
+}
+
+void RealSenseCamera::advancePlayback(double time)
+{
+	while (m_HasNextFrames && getNextPlaybackTime() <= time)
+	{
+		m_ScheduledFrames = m_NextFrames;
+		m_HasScheduledDepth = true;
+		updateGravity(m_ScheduledFrames);
+		m_HasNextFrames = readPlaybackFrames(m_NextFrames);
+	}
+}
+
+void RealSenseCamera::seekPlayback(double time)
+{
+	if (!m_IsExternalPlayback)
+		return;
+
+	// A playback that reached the end has stopped its pipeline
+	auto playback = m_Device.as<rs2::playback>();
+	if (playback.current_status() == RS2_PLAYBACK_STATUS_STOPPED)
+	{
+		restartPlayback();
+		playback = m_Device.as<rs2::playback>();
+	}
+
+	// Frames already in the pipeline are from before the seek. The file is timed from its start, which is about the first frame.
+	playback.pause();
+	rs2::frameset stale;
+	while (mp_Pipe->poll_for_frames(&stale)) { }
+	playback.seek(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(std::max(time, 0.0))));
+	playback.resume();
+
+	m_ScheduledFrames = rs2::frameset();
+	m_HasScheduledDepth = false;
+	m_HasNextFrames = readPlaybackFrames(m_NextFrames);
+}
+
+double RealSenseCamera::getPlaybackDuration() const
+{
+	if (!isPlayback())
+		return 0.0;
+
+	return std::chrono::duration<double>(m_Device.as<rs2::playback>().get_duration()).count();
+}
+
 // https://dev.intelrealsense.com/docs/rs-record-playback
 std::string RealSenseCamera::startRecording(std::string sessionName)
 {
@@ -139,6 +360,9 @@ std::string RealSenseCamera::startRecording(std::string sessionName)
 		rs2::config cfg;
 		mp_Logger->log("Saving " + getCameraName() + "'s stream to " + filepath.string());
 
+		// Same streams as the live pipeline, the IMU is held by its own callback and not recorded
+		cfg.enable_stream(RS2_STREAM_DEPTH);
+		cfg.enable_stream(RS2_STREAM_COLOR);
 		cfg.enable_record_to_file(filepath.string());
 		mp_Pipe->start(cfg);
 		m_Device = mp_Pipe->get_active_profile().get_device();
@@ -148,7 +372,23 @@ std::string RealSenseCamera::startRecording(std::string sessionName)
 	m_CameraInfromation["Type"] = getType();
 	m_CameraInfromation["FileName"] = filepath.filename().string();
 
-	m_IsSelectedForRecording = true;
+	auto skeletonPath = m_RecordingDirectory / (sessionName + "_" + cameraName + ".skel");
+	if (m_PointCloud->startSkeletonRecording(skeletonPath))
+		m_CameraInfromation["SkeletonFileName"] = skeletonPath.filename().string();
+	else
+		mp_Logger->log("Could not create " + skeletonPath.string(), Logger::LogLevel::ERR);
+
+	if (m_RecordNativeDepth) {
+		auto depthPath = m_RecordingDirectory / (sessionName + "_" + cameraName + ".fdr");
+		if (m_PointCloud->startDepthRecording(depthPath))
+			m_CameraInfromation["DepthFileName"] = depthPath.filename().string();
+		else
+			mp_Logger->log("Could not create " + depthPath.string(), Logger::LogLevel::ERR);
+	}
+	else {
+		m_CameraInfromation.removeMember("DepthFileName");
+	}
+
 	m_IsEnabled = true;
 
 	return filepath.filename().string();
@@ -156,13 +396,19 @@ std::string RealSenseCamera::startRecording(std::string sessionName)
 
 void RealSenseCamera::saveFrame() {
 	rs2::frameset data = mp_Pipe->wait_for_frames();
-	data.get_depth_frame();
+	if (auto depth = data.get_depth_frame()) {
+		updateFrameInfo(depth);
+		m_PointCloud->recordDepth(depth.get_data());
+	}
 	data.get_color_frame();
 }
 
 
 void RealSenseCamera::stopRecording()
 {
+	m_PointCloud->stopSkeletonRecording();
+	m_PointCloud->stopDepthRecording();
+
 	mp_Pipe->stop();
 	mp_Pipe = std::make_shared<rs2::pipeline>();
 
@@ -171,6 +417,16 @@ void RealSenseCamera::stopRecording()
 	m_Device = mp_Pipe->get_active_profile().get_device();
 }
 
+bool RealSenseCamera::getRecordingStats(DepthRecording::Writer::Stats &stats) const
+{
+	return m_PointCloud->getDepthRecordingStats(stats);
+}
+
+unsigned int RealSenseCamera::getRecordedFrames() const
+{
+	return m_PointCloud->getRecordedFrames();
+}
+
 void RealSenseCamera::OnUpdate()
 {
 	m_PointCloud->OnUpdate();
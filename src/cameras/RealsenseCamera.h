@@ -3,6 +3,7 @@
 #include <librealsense2/rs.hpp>
 #include <filesystem>
 #include <memory>
+#include <mutex>
 
 #include "GLCore/Renderer.h"
 #include "obj/Logger.h"
@@ -16,6 +17,7 @@ public:
 	~RealSenseCamera() override;
 
 	const void *getDepth() override;
+	bool getFrameInfo(uint64_t &frameNumber, double &timestamp) const override;
 
 	static std::string getType() { return "Realsense"; }
 
@@ -75,7 +77,42 @@ public:
 						    0.0f,		     0.0f,             1.0f };
 	}
 
+	bool getGravity(glm::vec3 &gravity) const override;
+
+	bool getRecordingStats(DepthRecording::Writer::Stats &stats) const override;
+	unsigned int getRecordedFrames() const override;
+
+	bool isPlayback() const override { return (bool)m_Device.as<rs2::playback>(); }
+	void setExternalPlayback(bool isExternal) override;
+	void restartPlayback() override;
+	double getNextPlaybackTime() override;
+	void advancePlayback(double time) override;
+	void seekPlayback(double time) override;
+	double getPlaybackDuration() const override;
+
 private:
+	/// <summary>
+	/// Streams the accelerometer into updateAcceleration if the camera has an IMU
+	/// </summary>
+	void startMotionSensor();
+
+	/// <summary>
+	/// Reads the accelerometer of a played back frameset, bags recorded before the IMU had its own callback hold it
+	/// </summary>
+	void updateGravity(const rs2::frameset &frames);
+	void updateAcceleration(const rs2::motion_frame &frame);
+
+	/// <summary>
+	/// Keeps the number and timestamp of a live depth frame for getFrameInfo
+	/// </summary>
+	void updateFrameInfo(const rs2::frame &depth);
+
+	/// <summary>
+	/// Waits for the next frameset with depth of a playback
+	/// </summary>
+	/// <returns>False at the end of the recording</returns>
+	bool readPlaybackFrames(rs2::frameset &frames);
+
 	std::shared_ptr<rs2::pipeline> mp_Pipe;
 	rs2::context* mp_Context{};
 	rs2::device m_Device{};
@@ -83,11 +120,32 @@ private:
 
 	rs2_intrinsics m_Intrinsics;
 
+	uint64_t m_FrameNumber{ 0 };
+	double m_FrameTimestamp{ 0.0 };
+	bool m_HasFrameInfo{ false };
+
+	rs2::sensor m_MotionSensor{};
+	bool m_HasMotionSensor{ false };
+
+	// Low pass filtered accelerometer reading, at rest it points against gravity. Written by the IMU callback.
+	mutable std::mutex m_AccelerationMutex;
+	glm::vec3 m_Acceleration{ 0.0f };
+	bool m_HasAcceleration{ false };
+
 	// Declare depth colorizer for pretty visualization of depth data
 	rs2::colorizer m_ColorMap{};
 
 	Logger::Logger* mp_Logger;
 
+	// Playback driven by a PlaybackScheduler, frames are read one ahead to know the time of the next one
+	std::filesystem::path m_RecordingPath;
+	bool m_IsExternalPlayback{ false };
+	rs2::frameset m_ScheduledFrames;
+	rs2::frameset m_NextFrames;
+	bool m_HasNextFrames{ false };
+	bool m_HasScheduledDepth{ false };
+	double m_FirstTimestamp{ 0.0 };
+
 	unsigned int m_DepthWidth;
 	unsigned int m_DepthHeight;
 	std::unique_ptr<GLObject::PointCloud> m_PointCloud;
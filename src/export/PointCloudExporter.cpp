@@ -0,0 +1,178 @@
+#include "PointCloudExporter.h"
+
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+	// Packed size of a point in the file, see the header field lists
+	const size_t PointSize = 6 * sizeof(float) + sizeof(uint8_t) + sizeof(uint16_t);
+
+	// Points interleaved per write, 4 MB
+	const size_t BlockPoints = (4 << 20) / PointSize;
+
+	std::string getPlyHeader(const PointCloudExporter::Frame &frame)
+	{
+		return "ply\n"
+			"format binary_little_endian 1.0\n"
+			"comment FESD camera " + frame.CameraName + " frame " + std::to_string(frame.FrameIndex) + (frame.HasNormals ? "" : " without normals") + "\n"
+			"element vertex " + std::to_string(frame.getSize()) + "\n"
+			"property float x\n"
+			"property float y\n"
+			"property float z\n"
+			"property float nx\n"
+			"property float ny\n"
+			"property float nz\n"
+			"property uchar ndt_type\n"
+			"property ushort camera_id\n"
+			"end_header\n";
+	}
+
+	std::string getPcdHeader(const PointCloudExporter::Frame &frame)
+	{
+		return "# .PCD v0.7 - FESD camera " + frame.CameraName + " frame " + std::to_string(frame.FrameIndex) + (frame.HasNormals ? "" : " without normals") + "\n"
+			"VERSION 0.7\n"
+			"FIELDS x y z normal_x normal_y normal_z ndt_type camera_id\n"
+			"SIZE 4 4 4 4 4 4 1 2\n"
+			"TYPE F F F F F F U U\n"
+			"COUNT 1 1 1 1 1 1 1 1\n"
+			"WIDTH " + std::to_string(frame.getSize()) + "\n"
+			"HEIGHT 1\n"
+			"VIEWPOINT 0 0 0 1 0 0 0\n"
+			"POINTS " + std::to_string(frame.getSize()) + "\n"
+			"DATA binary\n";
+	}
+}
+
+void PointCloudExporter::Frame::resize(size_t count)
+{
+	X.resize(count);
+	Y.resize(count);
+	Z.resize(count);
+	NormalX.resize(count);
+	NormalY.resize(count);
+	NormalZ.resize(count);
+	CellType.resize(count);
+}
+
+PointCloudExporter::PointCloudExporter()
+{
+	m_Thread = std::thread(&PointCloudExporter::run, this);
+}
+
+PointCloudExporter::~PointCloudExporter()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_Condition.notify_all();
+	m_Thread.join();
+}
+
+PointCloudExporter::Frame PointCloudExporter::getFrame()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_FreeFrames.empty())
+		return {};
+
+	Frame frame = std::move(m_FreeFrames.back());
+	m_FreeFrames.pop_back();
+	return frame;
+}
+
+bool PointCloudExporter::submit(Frame &&frame, const std::filesystem::path &path, Format format, bool wait)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	if (wait)
+		m_Space.wait(lock, [this] { return m_Jobs.size() < MaxPendingFrames; });
+
+	if (m_Jobs.size() >= MaxPendingFrames)
+	{
+		m_LastError = "Dropped " + path.filename().string() + ", the exporter is behind";
+		m_FreeFrames.push_back(std::move(frame));
+		return false;
+	}
+
+	m_Jobs.push_back({ std::move(frame), path, format });
+	m_Condition.notify_one();
+	return true;
+}
+
+void PointCloudExporter::run()
+{
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this] { return m_Stop || !m_Jobs.empty(); });
+
+			// Queued frames are still written on shutdown
+			if (m_Jobs.empty())
+				return;
+
+			job = std::move(m_Jobs.front());
+			m_Jobs.pop_front();
+		}
+		m_Space.notify_all();
+
+		bool isWritten = write(job.Points, job.Path, job.FileFormat);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (isWritten)
+			m_WrittenFrames++;
+		else
+			m_LastError = "Could not write " + job.Path.string();
+		m_FreeFrames.push_back(std::move(job.Points));
+	}
+}
+
+bool PointCloudExporter::write(const Frame &frame, const std::filesystem::path &path, Format format)
+{
+	std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		return false;
+
+	std::string header = format == Format::Ply ? getPlyHeader(frame) : getPcdHeader(frame);
+	file.write(header.data(), header.size());
+
+	std::vector<uint8_t> block(std::min(frame.getSize(), BlockPoints) * PointSize);
+	const uint16_t cameraId = frame.CameraId;
+	for (size_t first = 0; first < frame.getSize(); first += BlockPoints)
+	{
+		const size_t count = std::min(BlockPoints, frame.getSize() - first);
+		uint8_t *out = block.data();
+		for (size_t i = first; i < first + count; i++)
+		{
+			const float values[6] = { frame.X[i], frame.Y[i], frame.Z[i], frame.NormalX[i], frame.NormalY[i], frame.NormalZ[i] };
+			std::memcpy(out, values, sizeof(values));
+			out[sizeof(values)] = frame.CellType[i];
+			std::memcpy(out + sizeof(values) + 1, &cameraId, sizeof(cameraId));
+			out += PointSize;
+		}
+
+		file.write(reinterpret_cast<const char *>(block.data()), count * PointSize);
+	}
+
+	return file.good();
+}
+
+int PointCloudExporter::getPendingFrames() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return (int)m_Jobs.size();
+}
+
+int PointCloudExporter::getWrittenFrames() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_WrittenFrames;
+}
+
+std::string PointCloudExporter::getLastError() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_LastError;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <string>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/// <summary>
+/// Writes point clouds as binary little endian PLY or PCD files on a worker thread.
+/// Frames are handed over as structure of arrays snapshots, the worker interleaves them block by block
+/// into a large buffer and writes it, so the render thread only pays for the snapshot.
+///
+/// Every point has the fields x y z nx ny nz (float, meters, point cloud frame), ndt_type (uint8, Cell::NDT_TYPE,
+/// 3 if the point has no cell) and camera_id (uint16). Normals are zero if they were not calculated.
+/// </summary>
+class PointCloudExporter
+{
+public:
+	enum class Format
+	{
+		Ply,
+		Pcd
+	};
+
+	struct Frame
+	{
+		std::vector<float> X, Y, Z;
+		std::vector<float> NormalX, NormalY, NormalZ;
+		std::vector<uint8_t> CellType;
+
+		uint16_t CameraId{ 0 };
+		std::string CameraName;
+		uint32_t FrameIndex{ 0 };
+		bool HasNormals{ false };
+
+		size_t getSize() const { return X.size(); }
+		void resize(size_t count);
+	};
+
+	PointCloudExporter();
+	~PointCloudExporter();
+
+	PointCloudExporter(const PointCloudExporter &) = delete;
+	PointCloudExporter &operator=(const PointCloudExporter &) = delete;
+
+	/// <summary>
+	/// Frame to fill and submit, reuses the buffers of written frames
+	/// </summary>
+	Frame getFrame();
+
+	/// <summary>
+	/// Queues the frame for writing
+	/// </summary>
+	/// <param name="wait">Block while too many frames are waiting instead of dropping the frame, for sequences that must be complete</param>
+	/// <returns>False if too many frames are waiting, the frame is dropped</returns>
+	bool submit(Frame &&frame, const std::filesystem::path &path, Format format, bool wait = false);
+
+	/// <summary>
+	/// Writes a frame on the calling thread
+	/// </summary>
+	/// <returns>False if the file could not be written</returns>
+	static bool write(const Frame &frame, const std::filesystem::path &path, Format format);
+
+	static const char *getExtension(Format format) { return format == Format::Ply ? ".ply" : ".pcd"; }
+
+	int getPendingFrames() const;
+	int getWrittenFrames() const;
+	std::string getLastError() const;
+
+	/// <summary>
+	/// Frames waiting for the worker before new ones are dropped or wait
+	/// </summary>
+	static const size_t MaxPendingFrames = 32;
+private:
+	struct Job
+	{
+		Frame Points;
+		std::filesystem::path Path;
+		Format FileFormat;
+	};
+
+	void run();
+
+	std::thread m_Thread;
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+
+	// Signalled whenever the worker takes a job
+	std::condition_variable m_Space;
+	bool m_Stop{ false };
+	std::deque<Job> m_Jobs;
+	std::vector<Frame> m_FreeFrames;
+	int m_WrittenFrames{ 0 };
+	std::string m_LastError;
+};
@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include <imgui.h>
+
+/// <summary>
+/// Base class for all filters that run on the raw depth image before it is turned into a point cloud
+/// </summary>
+class DepthFilter
+{
+public:
+	/// <param name="metersPerUnit">Depth scale of the camera, used to express thresholds in millimeters</param>
+	DepthFilter(float metersPerUnit) : m_MetersPerUnit(metersPerUnit) { }
+	virtual ~DepthFilter() = default;
+
+	/// <summary>
+	/// Filters the depth image in place
+	/// </summary>
+	/// <param name="depth">Row major depth image, 0 marks a pixel without depth</param>
+	virtual void apply(int16_t *depth, int width, int height) = 0;
+
+	/// <summary>
+	/// Drops everything that was accumulated over previous frames
+	/// </summary>
+	virtual void reset() { }
+
+	virtual std::string getName() const = 0;
+
+	/// <returns>Copy with the same settings and accumulated state, to run away from the stream</returns>
+	virtual std::unique_ptr<DepthFilter> clone() const = 0;
+
+	/// <summary>
+	/// Applies the filter and keeps track of how long it took
+	/// </summary>
+	void run(int16_t *depth, int width, int height)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		apply(depth, width, height);
+		m_LastRunTime = std::chrono::high_resolution_clock::now() - start;
+	}
+
+	/// <summary>
+	/// Runs the filter repeatedly on copies of a frame, this changes the accumulated state, so run it on a clone
+	/// </summary>
+	/// <returns>Average time per run in ms</returns>
+	double benchmark(const int16_t *depth, int width, int height, int runs)
+	{
+		std::vector<int16_t> frame(depth, depth + (size_t)width * height);
+		std::chrono::duration<double, std::milli> total{ 0.0 };
+
+		for (int i = 0; i < runs; i++)
+		{
+			std::copy(depth, depth + frame.size(), frame.begin());
+
+			auto start = std::chrono::high_resolution_clock::now();
+			apply(frame.data(), width, height);
+			total += std::chrono::high_resolution_clock::now() - start;
+		}
+
+		return (total / runs).count();
+	}
+
+	void setBenchmarkTime(double milliseconds) { m_BenchmarkTime = std::chrono::duration<double, std::milli>(milliseconds); }
+
+	void OnImGuiRender()
+	{
+		ImGui::PushID(this);
+		if (ImGui::Checkbox(getName().c_str(), &m_IsEnabled) && !m_IsEnabled)
+			reset();
+
+		ImGui::BeginDisabled(!m_IsEnabled);
+		ImGui::Text("Last run: %.3f ms", m_LastRunTime.count());
+		if (m_BenchmarkTime.count() > 0.0)
+			ImGui::Text("Benchmark: %.3f ms", m_BenchmarkTime.count());
+		showSettings();
+		ImGui::EndDisabled();
+		ImGui::PopID();
+	}
+
+	bool m_IsEnabled{ false };
+protected:
+	virtual void showSettings() = 0;
+
+	/// <returns>Millimeters expressed in camera depth units</returns>
+	inline int toDepthUnits(float millimeters) const
+	{
+		return (int)(millimeters / 1000.0f / m_MetersPerUnit + 0.5f);
+	}
+
+	float m_MetersPerUnit;
+	std::chrono::duration<double, std::milli> m_LastRunTime{ 0.0 };
+	std::chrono::duration<double, std::milli> m_BenchmarkTime{ 0.0 };
+};
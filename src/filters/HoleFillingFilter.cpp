@@ -0,0 +1,147 @@
+#include "HoleFillingFilter.h"
+
+#include <numeric>
+#include <algorithm>
+#include <execution>
+
+void HoleFillingFilter::apply(int16_t *depth, int width, int height)
+{
+	auto *pixels = reinterpret_cast<uint16_t *>(depth);
+
+	if ((int)m_Rows.size() < height)
+	{
+		m_Rows.resize(height);
+		std::iota(m_Rows.begin(), m_Rows.end(), 0);
+	}
+
+	if (m_Mode == Mode::PushPull)
+	{
+		pushPull(pixels, width, height);
+		return;
+	}
+
+	std::for_each(std::execution::par, m_Rows.begin(), m_Rows.begin() + height, [&](int y) {
+		fillRow(pixels + (size_t)y * width, width);
+	});
+}
+
+void HoleFillingFilter::fillRow(uint16_t *row, int width) const
+{
+	int x = 0;
+
+	while (x < width)
+	{
+		if (row[x] != 0)
+		{
+			x++;
+			continue;
+		}
+
+		// [start, end) is a run of missing pixels
+		int start = x;
+		while (x < width && row[x] == 0)
+			x++;
+		int end = x;
+
+		if (m_MaxHoleSize > 0 && end - start > m_MaxHoleSize)
+			continue;
+
+		uint16_t left = start > 0 ? row[start - 1] : 0;
+		uint16_t right = end < width ? row[end] : 0;
+
+		if (left == 0 && right == 0)
+			continue;
+
+		if (m_Mode == Mode::FarthestNeighbour || left == 0 || right == 0)
+		{
+			std::fill(row + start, row + end, std::max(left, right));
+		}
+		else
+		{
+			int middle = (start + end) / 2;
+			std::fill(row + start, row + middle, left);
+			std::fill(row + middle, row + end, right);
+		}
+	}
+}
+
+void HoleFillingFilter::pushPull(uint16_t *depth, int width, int height)
+{
+	// Level 0 is the input, every level above halves the resolution until one pixel is left
+	if (m_Pyramid.empty() || m_Pyramid[0].Width != width || m_Pyramid[0].Height != height)
+	{
+		m_Pyramid.clear();
+
+		int w = width;
+		int h = height;
+		while (true)
+		{
+			m_Pyramid.push_back({ w, h, std::vector<float>((size_t)w * h) });
+			if (w == 1 && h == 1)
+				break;
+			w = (w + 1) / 2;
+			h = (h + 1) / 2;
+		}
+	}
+
+	auto &base = m_Pyramid[0];
+	std::transform(depth, depth + base.Depth.size(), base.Depth.begin(), [](uint16_t d) { return (float)d; });
+
+	// Pull: average the valid children
+	for (size_t l = 1; l < m_Pyramid.size(); l++)
+	{
+		auto &fine = m_Pyramid[l - 1];
+		auto &coarse = m_Pyramid[l];
+
+		std::for_each(std::execution::par, m_Rows.begin(), m_Rows.begin() + coarse.Height, [&](int y) {
+			for (int x = 0; x < coarse.Width; x++)
+			{
+				float sum = 0.0f;
+				int count = 0;
+
+				for (int fy = 2 * y; fy < std::min(2 * y + 2, fine.Height); fy++)
+				{
+					for (int fx = 2 * x; fx < std::min(2 * x + 2, fine.Width); fx++)
+					{
+						float d = fine.Depth[(size_t)fy * fine.Width + fx];
+						if (d != 0.0f)
+						{
+							sum += d;
+							count++;
+						}
+					}
+				}
+
+				coarse.Depth[(size_t)y * coarse.Width + x] = count > 0 ? sum / (float)count : 0.0f;
+			}
+		});
+	}
+
+	// Push: holes take the value of their parent
+	for (size_t l = m_Pyramid.size() - 1; l > 0; l--)
+	{
+		auto &coarse = m_Pyramid[l];
+		auto &fine = m_Pyramid[l - 1];
+
+		std::for_each(std::execution::par, m_Rows.begin(), m_Rows.begin() + fine.Height, [&](int y) {
+			float *row = fine.Depth.data() + (size_t)y * fine.Width;
+			const float *parent = coarse.Depth.data() + (size_t)(y / 2) * coarse.Width;
+
+			for (int x = 0; x < fine.Width; x++)
+				if (row[x] == 0.0f)
+					row[x] = parent[x / 2];
+		});
+	}
+
+	std::transform(base.Depth.begin(), base.Depth.end(), depth, [](float d) { return (uint16_t)(d + 0.5f); });
+}
+
+void HoleFillingFilter::showSettings()
+{
+	if (ImGui::Combo("Mode", &m_ModeElem, m_ModeNames.data(), (int)m_ModeNames.size()))
+		m_Mode = static_cast<Mode>(m_ModeElem);
+
+	ImGui::BeginDisabled(m_Mode == Mode::PushPull);
+	ImGui::SliderInt("Max Hole Size (px)", &m_MaxHoleSize, 0, 200);
+	ImGui::EndDisabled();
+}
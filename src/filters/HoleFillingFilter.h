@@ -0,0 +1,62 @@
+#pragma once
+#include <vector>
+#include <array>
+
+#include "DepthFilter.h"
+
+/// <summary>
+/// Fills pixels without depth so they don't end up as points at the camera origin.
+/// All modes run in linear time, rows (and pyramid rows) are processed in parallel.
+/// </summary>
+class HoleFillingFilter : public DepthFilter
+{
+public:
+	using DepthFilter::DepthFilter;
+
+	enum class Mode
+	{
+		/// <summary>
+		/// Take the closest valid pixel in the same row
+		/// </summary>
+		NearestValid,
+		/// <summary>
+		/// Take the farther of the two valid pixels bounding the hole in its row,
+		/// holes are mostly occluded background
+		/// </summary>
+		FarthestNeighbour,
+		/// <summary>
+		/// Average valid pixels into a pyramid and push the coarse values back into the holes
+		/// </summary>
+		PushPull
+	};
+
+	void apply(int16_t *depth, int width, int height) override;
+
+	std::string getName() const override { return "Hole Filling Filter"; }
+	std::unique_ptr<DepthFilter> clone() const override { return std::make_unique<HoleFillingFilter>(*this); }
+protected:
+	void showSettings() override;
+private:
+	void fillRow(uint16_t *row, int width) const;
+	void pushPull(uint16_t *depth, int width, int height);
+
+	struct PyramidLevel
+	{
+		int Width;
+		int Height;
+		std::vector<float> Depth;
+	};
+
+	std::vector<PyramidLevel> m_Pyramid;
+	std::vector<int> m_Rows;
+
+	Mode m_Mode{ Mode::NearestValid };
+	int m_ModeElem{ 0 };
+
+	/// <summary>
+	/// Holes wider than this are left alone by the row based modes, 0 fills everything
+	/// </summary>
+	int m_MaxHoleSize{ 0 };
+
+	const std::array<const char *, 3> m_ModeNames{ "Nearest Valid", "Farthest Neighbour", "Push Pull" };
+};
@@ -0,0 +1,121 @@
+#include "SpatialFilter.h"
+
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include <execution>
+
+void SpatialFilter::apply(int16_t *depth, int width, int height)
+{
+	if (width != m_Width || height != m_Height)
+	{
+		m_Width = width;
+		m_Height = height;
+
+		m_Image.resize((size_t)width * height);
+
+		m_RowGroups.resize((height + RowGroupSize - 1) / RowGroupSize);
+		std::iota(m_RowGroups.begin(), m_RowGroups.end(), 0);
+
+		m_Blocks.resize((width + BlockWidth - 1) / BlockWidth);
+		std::iota(m_Blocks.begin(), m_Blocks.end(), 0);
+	}
+
+	auto *pixels = reinterpret_cast<const uint16_t *>(depth);
+	std::transform(pixels, pixels + m_Image.size(), m_Image.begin(), [](uint16_t d) { return (float)d; });
+
+	for (int i = 0; i < m_Iterations; i++)
+	{
+		updateWeights(i);
+
+		std::for_each(std::execution::par, m_RowGroups.begin(), m_RowGroups.end(), [this](int group) { filterRowGroup(group); });
+		std::for_each(std::execution::par, m_Blocks.begin(), m_Blocks.end(), [this](int block) { filterColumnBlock(block); });
+	}
+
+	auto *out = reinterpret_cast<uint16_t *>(depth);
+	std::transform(m_Image.begin(), m_Image.end(), pixels, out, [](float filtered, uint16_t raw) {
+		return raw == 0 ? (uint16_t)0 : (uint16_t)(filtered + 0.5f);
+	});
+}
+
+void SpatialFilter::updateWeights(int iteration)
+{
+	// Each iteration halves the spatial sigma so the sum of all iterations has a variance of sigma²
+	auto sigma = m_SigmaSpatial * std::sqrt(3.0f) * std::pow(2.0f, (float)(m_Iterations - iteration - 1))
+			   / std::sqrt(std::pow(4.0f, (float)m_Iterations) - 1.0f);
+	auto a = std::exp(-std::sqrt(2.0f) / sigma);
+
+	auto sigmaRange = (float)std::max(toDepthUnits(m_SigmaRangeMM), 1);
+	auto threshold = std::max(toDepthUnits(m_EdgeThresholdMM), 1);
+
+	m_Weights.assign(threshold + 1, 0.0f);
+	for (int diff = 0; diff < threshold; diff++)
+		m_Weights[diff] = std::pow(a, 1.0f + m_SigmaSpatial / sigmaRange * (float)diff);
+}
+
+void SpatialFilter::filterRowGroup(int group)
+{
+	// The recursion along a row is one long dependency chain,
+	// walking several rows side by side lets their chains overlap
+	float *p[RowGroupSize];
+	const int rows = std::min(RowGroupSize, m_Height - group * RowGroupSize);
+
+	for (int r = 0; r < rows; r++)
+		p[r] = m_Image.data() + (size_t)(group * RowGroupSize + r) * m_Width;
+
+	for (int x = 1; x < m_Width; x++)
+	{
+		for (int r = 0; r < rows; r++)
+		{
+			auto w = getWeight(p[r][x], p[r][x - 1]);
+			p[r][x] += w * (p[r][x - 1] - p[r][x]);
+		}
+	}
+
+	for (int x = m_Width - 2; x >= 0; x--)
+	{
+		for (int r = 0; r < rows; r++)
+		{
+			auto w = getWeight(p[r][x], p[r][x + 1]);
+			p[r][x] += w * (p[r][x + 1] - p[r][x]);
+		}
+	}
+}
+
+void SpatialFilter::filterColumnBlock(int block)
+{
+	const int x0 = block * BlockWidth;
+	const int x1 = std::min(x0 + BlockWidth, m_Width);
+
+	for (int y = 1; y < m_Height; y++)
+	{
+		float *cur = m_Image.data() + (size_t)y * m_Width;
+		const float *prev = cur - m_Width;
+
+		for (int x = x0; x < x1; x++)
+		{
+			auto w = getWeight(cur[x], prev[x]);
+			cur[x] += w * (prev[x] - cur[x]);
+		}
+	}
+
+	for (int y = m_Height - 2; y >= 0; y--)
+	{
+		float *cur = m_Image.data() + (size_t)y * m_Width;
+		const float *next = cur + m_Width;
+
+		for (int x = x0; x < x1; x++)
+		{
+			auto w = getWeight(cur[x], next[x]);
+			cur[x] += w * (next[x] - cur[x]);
+		}
+	}
+}
+
+void SpatialFilter::showSettings()
+{
+	ImGui::SliderFloat("Spatial Sigma (px)", &m_SigmaSpatial, 1.0f, 64.0f);
+	ImGui::SliderFloat("Range Sigma (mm)", &m_SigmaRangeMM, 1.0f, 100.0f);
+	ImGui::SliderFloat("Edge Threshold (mm)", &m_EdgeThresholdMM, 1.0f, 200.0f);
+	ImGui::SliderInt("Iterations", &m_Iterations, 1, 5);
+}
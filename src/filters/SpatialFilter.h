@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "DepthFilter.h"
+
+/// <summary>
+/// Edge preserving smoothing using the recursive domain transform filter (Gastal and Oliveira 2011)
+/// with the depth image as its own guide. Rows and columns are filtered separately,
+/// groups of rows in parallel and columns in parallel blocks that walk down the image to stay in cache.
+/// Differences above the edge threshold and pixels without depth stop the propagation.
+/// </summary>
+class SpatialFilter : public DepthFilter
+{
+public:
+	using DepthFilter::DepthFilter;
+
+	void apply(int16_t *depth, int width, int height) override;
+
+	std::string getName() const override { return "Spatial Filter"; }
+	std::unique_ptr<DepthFilter> clone() const override { return std::make_unique<SpatialFilter>(*this); }
+protected:
+	void showSettings() override;
+private:
+	void updateWeights(int iteration);
+	void filterRowGroup(int group);
+	void filterColumnBlock(int block);
+
+	inline float getWeight(float a, float b) const
+	{
+		// The last entry is 0 and catches every difference above the edge threshold
+		auto diff = std::min((size_t)std::abs(a - b), m_Weights.size() - 1);
+		return (a != 0.0f && b != 0.0f) ? m_Weights[diff] : 0.0f;
+	}
+
+	/// <summary>
+	/// Number of rows filtered together in the horizontal pass
+	/// </summary>
+	static const int RowGroupSize = 4;
+
+	/// <summary>
+	/// Number of columns filtered together in the vertical pass
+	/// </summary>
+	static const int BlockWidth = 64;
+
+	int m_Width{ 0 };
+	int m_Height{ 0 };
+
+	std::vector<float> m_Image;
+	std::vector<int> m_RowGroups;
+	std::vector<int> m_Blocks;
+
+	/// <summary>
+	/// Propagation weight by absolute depth difference (in depth units) for the current iteration
+	/// </summary>
+	std::vector<float> m_Weights;
+
+	float m_SigmaSpatial{ 8.0f };
+	float m_SigmaRangeMM{ 10.0f };
+	float m_EdgeThresholdMM{ 40.0f };
+	int m_Iterations{ 2 };
+};
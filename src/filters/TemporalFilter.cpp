@@ -0,0 +1,110 @@
+#include "TemporalFilter.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utilities/Simd.h>
+
+void TemporalFilter::apply(int16_t *depth, int width, int height)
+{
+	const size_t count = (size_t)width * height;
+
+	// Depth is handed around as int16 but the cameras deliver unsigned values
+	auto *pixels = reinterpret_cast<uint16_t *>(depth);
+
+	if (m_History.size() != count)
+	{
+		m_History.assign(pixels, pixels + count);
+		m_HoleAge.assign(count, 0);
+		return;
+	}
+
+	filterSpan(pixels, m_History.data(), m_HoleAge.data(), (int)count);
+}
+
+void TemporalFilter::reset()
+{
+	m_History.clear();
+	m_HoleAge.clear();
+}
+
+void TemporalFilter::filterSpan(uint16_t *depth, uint16_t *history, uint16_t *holeAge, int count) const
+{
+	// Alpha in Q15 so the blend is a single rounding multiply
+	const int16_t alpha = (int16_t)std::clamp((int)(m_Alpha * 32767.0f + 0.5f), 0, 32767);
+	const uint16_t threshold = (uint16_t)std::clamp(toDepthUnits(m_EdgeThresholdMM), 1, 0xFFFF);
+	const uint16_t persistence = (uint16_t)std::clamp(m_HolePersistence, 0, 0xFFFF);
+
+	int x = 0;
+
+#ifdef FESD_SSSE3
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i alphaV = _mm_set1_epi16(alpha);
+	const __m128i thresholdV = _mm_set1_epi16((int16_t)(threshold - 1));
+	const __m128i persistenceV = _mm_set1_epi16((int16_t)persistence);
+
+	for (; x + 8 <= count; x += 8)
+	{
+		__m128i cur = _mm_loadu_si128((const __m128i *)(depth + x));
+		__m128i prev = _mm_loadu_si128((const __m128i *)(history + x));
+		__m128i age = _mm_loadu_si128((const __m128i *)(holeAge + x));
+
+		__m128i curInvalid = _mm_cmpeq_epi16(cur, zero);
+		__m128i prevInvalid = _mm_cmpeq_epi16(prev, zero);
+
+		// Unsigned |cur - prev| >= threshold
+		__m128i absDiff = _mm_or_si128(_mm_subs_epu16(cur, prev), _mm_subs_epu16(prev, cur));
+		__m128i isEdge = _mm_andnot_si128(_mm_cmpeq_epi16(_mm_subs_epu16(absDiff, thresholdV), zero), _mm_set1_epi16(-1));
+
+		// Only used when |cur - prev| is below the threshold, so the wrapping difference is exact
+		__m128i smoothed = _mm_add_epi16(prev, _mm_mulhrs_epi16(_mm_sub_epi16(cur, prev), alphaV));
+
+		__m128i takeCurrent = _mm_or_si128(prevInvalid, isEdge);
+		__m128i valid = _mm_or_si128(_mm_and_si128(takeCurrent, cur), _mm_andnot_si128(takeCurrent, smoothed));
+
+		__m128i nextAge = _mm_adds_epu16(age, one);
+		__m128i persist = _mm_cmpeq_epi16(_mm_subs_epu16(nextAge, persistenceV), zero);
+		__m128i hole = _mm_and_si128(persist, prev);
+
+		__m128i out = _mm_or_si128(_mm_and_si128(curInvalid, hole), _mm_andnot_si128(curInvalid, valid));
+
+		_mm_storeu_si128((__m128i *)(depth + x), out);
+		_mm_storeu_si128((__m128i *)(history + x), out);
+		_mm_storeu_si128((__m128i *)(holeAge + x), _mm_and_si128(curInvalid, nextAge));
+	}
+#endif
+
+	// Scalar tail, matches the rounding of _mm_mulhrs_epi16
+	for (; x < count; x++)
+	{
+		uint16_t cur = depth[x];
+		uint16_t prev = history[x];
+		uint16_t out;
+
+		if (cur == 0)
+		{
+			holeAge[x] = (uint16_t)std::min(holeAge[x] + 1, 0xFFFF);
+			out = holeAge[x] <= persistence ? prev : 0;
+		}
+		else
+		{
+			holeAge[x] = 0;
+			int diff = (int)cur - (int)prev;
+
+			if (prev == 0 || std::abs(diff) >= threshold)
+				out = cur;
+			else
+				out = (uint16_t)(prev + ((diff * alpha + 0x4000) >> 15));
+		}
+
+		depth[x] = out;
+		history[x] = out;
+	}
+}
+
+void TemporalFilter::showSettings()
+{
+	ImGui::SliderFloat("Alpha", &m_Alpha, 0.01f, 1.0f);
+	ImGui::SliderFloat("Edge Threshold (mm)", &m_EdgeThresholdMM, 1.0f, 200.0f);
+	ImGui::SliderInt("Hole Persistence (frames)", &m_HolePersistence, 0, 30);
+}
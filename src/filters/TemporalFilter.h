@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+
+#include "DepthFilter.h"
+
+/// <summary>
+/// Per pixel exponential smoothing over time.
+/// Jumps larger than the edge threshold are taken as they are so moving edges don't smear,
+/// pixels that lose their depth keep the last value for a few frames (hole persistence).
+/// </summary>
+class TemporalFilter : public DepthFilter
+{
+public:
+	using DepthFilter::DepthFilter;
+
+	void apply(int16_t *depth, int width, int height) override;
+	void reset() override;
+
+	std::string getName() const override { return "Temporal Filter"; }
+	std::unique_ptr<DepthFilter> clone() const override { return std::make_unique<TemporalFilter>(*this); }
+protected:
+	void showSettings() override;
+private:
+	void filterSpan(uint16_t *depth, uint16_t *history, uint16_t *holeAge, int count) const;
+
+	std::vector<uint16_t> m_History;
+	std::vector<uint16_t> m_HoleAge;
+
+	/// <summary>
+	/// Weight of the current frame, 1 disables smoothing
+	/// </summary>
+	float m_Alpha{ 0.4f };
+	float m_EdgeThresholdMM{ 20.0f };
+	int m_HolePersistence{ 3 };
+};
@@ -20,12 +20,14 @@
 #include "GLCore/GLObject.h"
 #include "GLCore/GLErrorManager.h"
 #include "GLCore/Camera.h"
+#include "GLCore/Profiler.h"
 
 #include <OpenNI.h>
 #include "cameras/CameraHandler.h"
 
 #include "utilities/Status.h"
 #include "obj/Logger.h"
+#include "augmentation/FaultAugmenter.h"
 
 #include "utilities/helper/GLFWHelper.h"
 #include "utilities/helper/ImGuiHelper.h"
@@ -37,8 +39,12 @@ Camera *cam = nullptr;
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void scroll_callback(GLFWwindow *window, double xpos, double ypos);
 
-int main(void)
+int main(int argc, char **argv)
 {
+    // Batch jobs run headless, without window or cameras
+    if (argc > 1 && std::string(argv[1]) == "--augment")
+        return runAugmentationCommand(argc - 2, argv + 2);
+
     STATUS status;
     GLFWwindow *window = InitialiseGLFWWindow(status);
 
@@ -55,7 +61,7 @@ int main(void)
     {
         ImGuiHelper::initImGui(window);
 
-        Logger::Logger logger;
+        Logger::Logger logger{ "FESD.log" };
         logger.log("Initialised Log");
 
         cam = new Camera{window};
@@ -68,6 +74,8 @@ int main(void)
         //#######################
         CameraHandler cameraHandler{cam, &r, &logger};
 
+        Profiler::setThreadName("Main");
+
         float deltaTime = 0.0f;	// Time between current frame and last frame
         float lastFrame = 0.0f; // Time of last frame
         float fps = 0.0f;
@@ -85,6 +93,8 @@ int main(void)
 
             fps = (float)((fps * fpsSmoothing) + (deltaTime * (1.0 - fpsSmoothing)));
 
+            Profiler::beginFrame();
+            r.BeginFrame();
             r.Clear();
             
             ImGuiHelper::beginFrame();
@@ -121,15 +131,33 @@ int main(void)
             if (showTestMenu)
                 tmh.update();
 
-            cameraHandler.OnRender();
-            cameraHandler.OnImGuiRender();
+            {
+                PROFILE_SCOPE("CameraHandler");
+                cameraHandler.OnRender();
+                cameraHandler.OnImGuiRender();
+            }
 
             logger.showLog();
+            Profiler::OnImGuiRender();
+
+            ImGui::Begin("Renderer");
+            r.OnImGuiRender();
+            ImGui::End();
 
-            ImGuiHelper::endFrame();
+            {
+                PROFILE_SCOPE("ImGui");
+                PROFILE_GPU_SCOPE("ImGui");
+                ImGuiHelper::endFrame();
+            }
 
-            glfwSwapBuffers(window);
-            glfwPollEvents();
+            {
+                // Mostly waiting for vsync and the GPU
+                PROFILE_SCOPE("Swap");
+                glfwSwapBuffers(window);
+                glfwPollEvents();
+            }
+            r.EndFrame();
+            Profiler::endFrame();
         }
     }
 
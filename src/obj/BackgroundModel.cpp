@@ -0,0 +1,218 @@
+#include "BackgroundModel.h"
+
+#include <algorithm>
+#include <numeric>
+#include <execution>
+#include <cmath>
+#include <imgui.h>
+
+void BackgroundModel::reset()
+{
+	m_IsLearned = false;
+	m_IsSegmented = false;
+	m_LearnedFrames = 0;
+
+	std::vector<uint16_t>().swap(m_LearningBuffer);
+	m_Median.clear();
+	m_Deviation.clear();
+	m_Foreground.clear();
+}
+
+void BackgroundModel::apply(int16_t *depth, int width, int height)
+{
+	if (width != m_Width || height != m_Height)
+	{
+		reset();
+		m_Width = width;
+		m_Height = height;
+	}
+
+	if (!m_IsLearned)
+	{
+		learn(depth);
+		if (m_LearnedFrames >= m_LearningFrames)
+			buildModel();
+
+		m_IsSegmented = false;
+		return;
+	}
+
+	const size_t count = (size_t)width * height;
+	m_Mask.resize(count);
+
+	// Depth is handed around as int16 but the cameras deliver unsigned values
+	auto *pixels = reinterpret_cast<uint16_t *>(depth);
+	const int minDistance = toDepthUnits(m_MinDistanceMM);
+	const float deviationFactor = m_DeviationFactor;
+
+	std::vector<int> rows(height);
+	std::iota(rows.begin(), rows.end(), 0);
+
+	std::for_each(std::execution::par, rows.begin(), rows.end(), [&](int y)
+		{
+			size_t first = (size_t)y * width;
+			for (size_t i = first; i < first + width; i++)
+			{
+				int d = pixels[i];
+				int background = m_Median[i];
+				int threshold = std::max(minDistance, (int)(deviationFactor * m_Deviation[i]));
+
+				bool isForeground = d > 0 && (background == 0 || d + threshold < background);
+				m_Mask[i] = isForeground;
+				if (!isForeground)
+					pixels[i] = 0;
+			}
+		});
+
+	removeSmallComponents(depth, width, height);
+	m_IsSegmented = true;
+}
+
+void BackgroundModel::learn(const int16_t *depth)
+{
+	const size_t count = (size_t)m_Width * m_Height;
+	m_LearningBuffer.resize(count * m_LearningFrames);
+
+	std::copy(reinterpret_cast<const uint16_t *>(depth), reinterpret_cast<const uint16_t *>(depth) + count,
+			  m_LearningBuffer.begin() + count * m_LearnedFrames);
+	m_LearnedFrames++;
+}
+
+void BackgroundModel::buildModel()
+{
+	const size_t count = (size_t)m_Width * m_Height;
+	const int frames = m_LearnedFrames;
+
+	m_Median.assign(count, 0);
+	m_Deviation.assign(count, 0);
+
+	std::vector<int> rows(m_Height);
+	std::iota(rows.begin(), rows.end(), 0);
+
+	std::for_each(std::execution::par, rows.begin(), rows.end(), [&](int y)
+		{
+			std::vector<uint16_t> samples;
+			samples.reserve(frames);
+
+			size_t first = (size_t)y * m_Width;
+			for (size_t i = first; i < first + m_Width; i++)
+			{
+				samples.clear();
+				for (int f = 0; f < frames; f++)
+				{
+					auto d = m_LearningBuffer[count * f + i];
+					if (d > 0)
+						samples.push_back(d);
+				}
+
+				// Pixels that are mostly holes have no background, anything showing up there is foreground
+				if (2 * (int)samples.size() < frames)
+					continue;
+
+				auto middle = samples.begin() + samples.size() / 2;
+				std::nth_element(samples.begin(), middle, samples.end());
+				int median = *middle;
+
+				for (auto &sample : samples)
+					sample = (uint16_t)std::abs(sample - median);
+				std::nth_element(samples.begin(), middle, samples.end());
+
+				m_Median[i] = (uint16_t)median;
+				m_Deviation[i] = (uint8_t)std::min(255.0f, std::ceil(1.4826f * *middle));
+			}
+		});
+
+	std::vector<uint16_t>().swap(m_LearningBuffer);
+	m_IsLearned = true;
+}
+
+int BackgroundModel::find(int label)
+{
+	while (m_Parents[label] != label)
+	{
+		m_Parents[label] = m_Parents[m_Parents[label]];
+		label = m_Parents[label];
+	}
+	return label;
+}
+
+void BackgroundModel::removeSmallComponents(int16_t *depth, int width, int height)
+{
+	const size_t count = (size_t)width * height;
+	m_Labels.resize(count);
+	m_Parents.clear();
+	m_Foreground.clear();
+
+	// First pass, provisional labels from the left and upper neighbour (4 connectivity)
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			size_t i = (size_t)y * width + x;
+			if (!m_Mask[i])
+				continue;
+
+			int left = x > 0 && m_Mask[i - 1] ? m_Labels[i - 1] : -1;
+			int up = y > 0 && m_Mask[i - width] ? m_Labels[i - width] : -1;
+
+			if (left < 0 && up < 0)
+			{
+				m_Labels[i] = (int)m_Parents.size();
+				m_Parents.push_back(m_Labels[i]);
+			}
+			else if (left >= 0 && up >= 0)
+			{
+				int a = find(left);
+				int b = find(up);
+				m_Parents[std::max(a, b)] = std::min(a, b);
+				m_Labels[i] = std::min(a, b);
+			}
+			else
+				m_Labels[i] = std::max(left, up);
+		}
+	}
+
+	m_ComponentSizes.assign(m_Parents.size(), 0);
+	for (size_t i = 0; i < count; i++)
+	{
+		if (!m_Mask[i])
+			continue;
+
+		m_Labels[i] = find(m_Labels[i]);
+		m_ComponentSizes[m_Labels[i]]++;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (!m_Mask[i])
+			continue;
+
+		if (m_ComponentSizes[m_Labels[i]] < m_MinComponentSize)
+		{
+			m_Mask[i] = 0;
+			depth[i] = 0;
+		}
+		else
+			m_Foreground.push_back((int)i);
+	}
+}
+
+void BackgroundModel::showSettings()
+{
+	if (ImGui::Button("Learn Again"))
+		reset();
+
+	ImGui::BeginDisabled(!m_IsLearned);
+	if (ImGui::SliderInt("Learning Frames", &m_LearningFrames, 5, 120))
+		reset();
+	ImGui::EndDisabled();
+
+	ImGui::SliderFloat("Min Distance (mm)", &m_MinDistanceMM, 5.0f, 500.0f);
+	ImGui::SliderFloat("Deviation Factor", &m_DeviationFactor, 0.0f, 10.0f);
+	ImGui::SliderInt("Min Component Size (px)", &m_MinComponentSize, 0, 5000);
+
+	if (!m_IsLearned)
+		ImGui::ProgressBar(getLearningProgress(), ImVec2(-1.0f, 0.0f), "Learning");
+	else if (m_Width * m_Height > 0)
+		ImGui::Text("Foreground: %.1f %%", 100.0f * (float)m_Foreground.size() / (float)(m_Width * m_Height));
+}
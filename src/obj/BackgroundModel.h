@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "../filters/DepthFilter.h"
+
+/// <summary>
+/// Static background of a camera, learned over the first frames after it is (re)started.
+/// Per pixel it keeps the median depth and a robust deviation (1.4826 * MAD), the learning frames are dropped afterwards.
+/// Pixels that are clearly in front of the background are foreground, connected components below a
+/// minimum size are treated as noise.
+/// </summary>
+class BackgroundModel : public DepthFilter
+{
+public:
+	BackgroundModel(float metersPerUnit) : DepthFilter(metersPerUnit) { }
+
+	/// <summary>
+	/// Drops the model, the next frames are learned again
+	/// </summary>
+	void reset() override;
+
+	/// <summary>
+	/// Learns the frame or, once the model is complete, removes the background from it
+	/// </summary>
+	/// <param name="depth">Row major depth image, background pixels are set to 0</param>
+	void apply(int16_t *depth, int width, int height) override;
+
+	std::string getName() const override { return "Remove Background"; }
+	std::unique_ptr<DepthFilter> clone() const override { return std::make_unique<BackgroundModel>(*this); }
+
+	bool isLearned() const { return m_IsLearned; }
+
+	/// <returns>True if the last frame was segmented, false while learning</returns>
+	bool isSegmented() const { return m_IsSegmented; }
+	float getLearningProgress() const { return (float)m_LearnedFrames / (float)m_LearningFrames; }
+
+	/// <returns>Pixel indices of the foreground in the last segmented frame, row major order</returns>
+	const std::vector<int> &getForeground() const { return m_Foreground; }
+
+	int m_LearningFrames{ 30 };
+
+	/// <summary>
+	/// A pixel has to be at least this much closer than the background
+	/// </summary>
+	float m_MinDistanceMM{ 50.0f };
+
+	/// <summary>
+	/// ... and this many deviations of the background
+	/// </summary>
+	float m_DeviationFactor{ 3.0f };
+
+	int m_MinComponentSize{ 200 };
+protected:
+	void showSettings() override;
+private:
+	void learn(const int16_t *depth);
+	void buildModel();
+	void removeSmallComponents(int16_t *depth, int width, int height);
+
+	int find(int label);
+
+	int m_Width{ 0 };
+	int m_Height{ 0 };
+
+	bool m_IsLearned{ false };
+	bool m_IsSegmented{ false };
+	int m_LearnedFrames{ 0 };
+
+	// Frames of the learning phase, frame after frame
+	std::vector<uint16_t> m_LearningBuffer;
+
+	// 0 where the background is unknown
+	std::vector<uint16_t> m_Median;
+	// In depth units, saturated
+	std::vector<uint8_t> m_Deviation;
+
+	std::vector<uint8_t> m_Mask;
+	std::vector<int> m_Labels;
+	std::vector<int> m_Parents;
+	std::vector<int> m_ComponentSizes;
+	std::vector<int> m_Foreground;
+};
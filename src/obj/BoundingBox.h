@@ -1,54 +1,120 @@
 #pragma once
-#include <random>
-#include <iostream>
+#include <array>
+#include <algorithm>
 #include <glm/glm.hpp>
 
+/// <summary>
+/// Per frame bounding box that ignores outliers.
+/// Every axis is collected in a fixed range histogram and the box spans the lower to the upper percentile,
+/// so single flying pixels don't blow up the cell size.
+/// </summary>
 class BoundingBox
 {
 public:
 	// TODO low prio: draw bounding box
-	inline bool updateBox(glm::vec3 p)
+	/// <summary>
+	/// Forgets the previous frame
+	/// </summary>
+	inline void beginFrame()
 	{
-		bool isUpdated = false;
+		for (auto &histogram : m_Histograms)
+			histogram.fill(0);
+		m_PointCount = 0;
+	}
 
-		if (p.x > m_MaxBoundingPoint.x){ 
-			m_MaxBoundingPoint.x = p.x; 
-			isUpdated = true;
-		}
-		if (p.y > m_MaxBoundingPoint.y){ 
-			m_MaxBoundingPoint.y = p.y; 
-			isUpdated = true;
-		}
-		if (p.z > m_MaxBoundingPoint.z){ 
-			m_MaxBoundingPoint.z = p.z; 
-			isUpdated = true;
-		}
+	/// <summary>
+	/// Adds a point of the current frame, points without depth are ignored
+	/// </summary>
+	inline void addPoint(glm::vec3 p)
+	{
+		if (p.z <= 0.0f)
+			return;
 
-		if (p.x < m_MinBoundingPoint.x){ 
-			m_MinBoundingPoint.x = p.x; 
-			isUpdated = true;
-		}
-		if (p.y < m_MinBoundingPoint.y){ 
-			m_MinBoundingPoint.y = p.y; 
-			isUpdated = true;
-		}
-		if (p.z < m_MinBoundingPoint.z)
+		for (int axis = 0; axis < 3; axis++)
+			m_Histograms[axis][getBin(axis, p[axis])]++;
+
+		m_PointCount++;
+	}
+
+	/// <summary>
+	/// Sets the box to the percentile bounds of all points added since beginFrame
+	/// </summary>
+	/// <returns>True if the box changed</returns>
+	inline bool endFrame()
+	{
+		if (m_PointCount == 0)
+			return false;
+
+		glm::vec3 min, max;
+		for (int axis = 0; axis < 3; axis++)
 		{
-			m_MinBoundingPoint.z = p.z; 
-			isUpdated = true;
+			min[axis] = getPercentile(axis, m_LowerPercentile);
+			max[axis] = getPercentile(axis, m_UpperPercentile);
 		}
 
+		bool isUpdated = min != m_MinBoundingPoint || max != m_MaxBoundingPoint;
+
+		m_MinBoundingPoint = min;
+		m_MaxBoundingPoint = max;
+
 		return isUpdated;
 	}
 
-	glm::vec3 getMinPoint() {
+	glm::vec3 getMinPoint() const {
 		return m_MinBoundingPoint;
 	}
 
-	glm::vec3 getMaxPoint() {
+	glm::vec3 getMaxPoint() const {
 		return m_MaxBoundingPoint;
 	}
+
+	float m_LowerPercentile{ 1.0f };
+	float m_UpperPercentile{ 99.0f };
 private:
+	static const int BinCount = 2048;
+
+	// x and y are centered around the optical axis, z starts at the camera (in meters)
+	const glm::vec3 m_HistogramMin{ -8.0f, -8.0f, 0.0f };
+	const glm::vec3 m_HistogramMax{ 8.0f, 8.0f, 16.0f };
+
+	inline float getBinSize(int axis) const
+	{
+		return (m_HistogramMax[axis] - m_HistogramMin[axis]) / (float)BinCount;
+	}
+
+	inline int getBin(int axis, float value) const
+	{
+		int bin = (int)((value - m_HistogramMin[axis]) / getBinSize(axis));
+		return std::clamp(bin, 0, BinCount - 1);
+	}
+
+	/// <returns>Value below which percentile % of the points lie, interpolated inside the bin</returns>
+	inline float getPercentile(int axis, float percentile) const
+	{
+		const auto &histogram = m_Histograms[axis];
+		float target = percentile / 100.0f * (float)m_PointCount;
+		float cumulative = 0.0f;
+
+		for (int bin = 0; bin < BinCount; bin++)
+		{
+			if (histogram[bin] == 0)
+				continue;
+
+			if (cumulative + (float)histogram[bin] >= target)
+			{
+				float fraction = (target - cumulative) / (float)histogram[bin];
+				return m_HistogramMin[axis] + ((float)bin + fraction) * getBinSize(axis);
+			}
+
+			cumulative += (float)histogram[bin];
+		}
+
+		return m_HistogramMax[axis];
+	}
+
+	std::array<std::array<unsigned int, BinCount>, 3> m_Histograms{};
+	unsigned int m_PointCount{ 0 };
+
 	glm::vec3 m_MinBoundingPoint{};
 	glm::vec3 m_MaxBoundingPoint{};
-};
\ No newline at end of file
+};
@@ -1,6 +1,6 @@
 ﻿#include "Cell.h"
+#include "EigenSolver.h"
 
-#include <numeric>
 #include <cmath>
 
 Cell::Cell(glm::vec3 index, float *m_PlanarThreshold) : m_PlanarThreshold(m_PlanarThreshold), m_Index(index) { }
@@ -15,37 +15,46 @@ Cell::Cell(std::string key, float *m_PlanarThreshold) : m_PlanarThreshold(m_Plan
 	m_Index = { x, y, z };
 }
 
-/// <summary>
-/// 
-/// </summary>
-/// <returns>Covariance of the inserted values</returns>
-float cov(const std::vector<float> *a, const std::vector<float> *b)
+bool Cell::calculateCovariance()
 {
-	assert(a->size() == b->size());
-
-	auto mean_a = std::reduce(a->begin(), a->end()) / a->size();
-	auto mean_b = std::reduce(b->begin(), b->end()) / b->size();
-
-	float covariance = 0;
-
-	for (int i = 0; i < a->size(); i++)
+	// Accumulated relative to the first point to avoid cancellation far from the camera
+	glm::vec3 origin{ 0.0f };
+	glm::vec3 sum{ 0.0f };
+	glm::vec3 sumSquares{ 0.0f };
+	glm::vec3 sumCross{ 0.0f };
+	int count = 0;
+
+	for (auto point : m_Points)
 	{
-		covariance += ((*a)[i] - mean_a) * ((*b)[i] - mean_b);
+		if (point->Depth <= 0)
+			continue;
+
+		auto p = point->getPoint();
+		if (count == 0)
+			origin = p;
+
+		auto d = p - origin;
+		sum += d;
+		sumSquares += d * d;
+		sumCross += glm::vec3(d.x * d.y, d.x * d.z, d.y * d.z);
+		count++;
 	}
 
-	return covariance / a->size();
-}
+	if (count < 3)
+	{
+		m_Covariance = glm::mat3(0.0f);
+		return false;
+	}
 
+	auto mean = sum / (float)count;
+	auto variance = sumSquares / (float)count - mean * mean;
+	auto crossVariance = sumCross / (float)count - glm::vec3(mean.x * mean.y, mean.x * mean.z, mean.y * mean.z);
 
-float calcSymmetricalDeterminant(glm::mat3x3 A)
-{
-	return A[0][0] * A[1][1] * A[2][2]
-		 + A[0][1] * A[1][2] * A[0][2]
-		 + A[0][2] * A[0][1] * A[1][2]
-		  
-		 - A[0][2] * A[1][1] * A[0][2]
-		 - A[0][1] * A[0][1] * A[2][2]
-		 - A[0][0] * A[1][2] * A[1][2];
+	m_Mean = origin + mean;
+	m_Covariance = { variance.x,      crossVariance.x, crossVariance.y,
+					 crossVariance.x, variance.y,      crossVariance.z,
+					 crossVariance.y, crossVariance.z, variance.z };
+	return true;
 }
 
 /// <summary>
@@ -54,80 +63,39 @@ float calcSymmetricalDeterminant(glm::mat3x3 A)
 /// <returns>True if λ1/λ2 ≤ te</returns>
 bool Cell::calculateNDT()
 {
-	std::vector<float> x;
-	std::vector<float> y;
-	std::vector<float> z;
-
-	if (m_Points.size() == 0)
-		return false;
-
-	for (auto pixel : m_Points)
+	if (!calculateCovariance())
 	{
-		auto p = pixel->getPoint();
-		x.push_back(p.x);
-		y.push_back(p.y);
-		z.push_back(p.z);
+		m_Type = NDT_TYPE::None;
+		return false;
 	}
 
-	// Covariance Matrix
-	glm::mat3x3 covariance = { cov(&x, &x), cov(&x, &y), cov(&x, &z),
-							   cov(&x, &y), cov(&y, &y), cov(&y, &z),
-							   cov(&x, &z), cov(&y, &z), cov(&z, &z) };
+	glm::vec3 values;
+	glm::mat3 vectors;
+	EigenSolver::solveClosedForm(m_Covariance, values, vectors);
+	setEigen(values, vectors);
 
-	glm::mat3x3 identity = { 1, 0, 0,
-							 0, 1, 0,
-							 0, 0, 1 };
+	return true;
+}
 
-	auto trace = covariance[0][0] + covariance[1][1] + covariance[2][2];
-	
-	auto p1 = glm::pow(covariance[1][2], 2) + glm::pow(covariance[1][3], 2) + glm::pow(covariance[2][3], 2);
-	if (p1 == 0)
-	{
-		// Covariance is diagonal
-		m_EigenVector = { covariance[0][0], covariance[1][1], covariance[2][2]};
-	}
-	else
-	{
-		auto q = trace / 3;
-		auto p2 = glm::pow(covariance[0][0] - q, 2) + glm::pow(covariance[1][1], 2) + glm::pow(covariance[2][2], 2) + 2 * p1;
-		auto p = glm::sqrt(p2 / 6);
-		auto B = (float)(1.0f / p) * (covariance - q * identity);
-
-		auto r = calcSymmetricalDeterminant(B) / 2;
-
-		// In exact arithmetic for a symmetric matrix - 1 <= r <= 1
-		// but computation error can leave it slightly outside this range.
-		double phi;
-		if (r <= -1)
-			phi = std::_Pi / 3.0;
-		else if(r >= 1)
-			phi = 0.0;
-		else
-			phi = acos(r) / 3.0;
-
-		auto eig1 = q + 2.0 * p * cos(phi);
-		auto eig3 = q + 2.0 * p * cos(phi + (2.0 * std::_Pi / 3.0));
-		auto eig2 = 3.0 * q - eig1 - eig3; // since trace(A) = eig1 + eig2 + eig3;
-
-		m_EigenVector = { eig1, eig2, eig3 };
-	}
+void Cell::setEigen(glm::vec3 values, glm::mat3 vectors)
+{
+	m_EigenValues = values;
+	m_EigenVectors = vectors;
 
 	updateNDTType();
-	
-	return true;
 }
 
 void Cell::updateNDTType() {
 
-	if (m_EigenVector.z == 0 || m_EigenVector.y == 0) {
+	if (m_EigenValues.z <= 0 || m_EigenValues.y <= 0) {
 		m_Type = NDT_TYPE::None;
 		return;
 	}
 
-	if (m_EigenVector.y / m_EigenVector.z <= *m_PlanarThreshold)
+	if (m_EigenValues.y / m_EigenValues.z <= *m_PlanarThreshold)
 		m_Type = NDT_TYPE::Linear;
-	else if (m_EigenVector.x / m_EigenVector.y <= *m_PlanarThreshold)
+	else if (m_EigenValues.x / m_EigenValues.y <= *m_PlanarThreshold)
 		m_Type = NDT_TYPE::Planar;
 	else
 		m_Type = NDT_TYPE::Spherical;
-}
\ No newline at end of file
+}
@@ -19,8 +19,26 @@ public:
 		m_Points.push_back(p);
 	}
 
+	/// <summary>
+	/// Calculates the covariance of the points with depth in a single pass
+	/// </summary>
+	/// <returns>False if the cell has less than three valid points</returns>
+	bool calculateCovariance();
+
+	/// <summary>
+	/// Calculates the covariance and its eigendecomposition for this cell alone,
+	/// use an EigenSolver to process many cells at once
+	/// </summary>
+	/// <returns>True if the cell could be classified</returns>
 	bool calculateNDT();
 
+	/// <summary>
+	/// Sets the eigendecomposition of the covariance and classifies the cell
+	/// </summary>
+	/// <param name="values">Ascending eigenvalues</param>
+	/// <param name="vectors">Eigenvector i in column i</param>
+	void setEigen(glm::vec3 values, glm::mat3 vectors);
+
 	void updateNDTType();
 
 	glm::vec3 getIndex() const
@@ -38,6 +56,34 @@ public:
 		return glm::normalize(m_AverageNormal);
 	}
 
+	glm::mat3 getCovariance() const
+	{
+		return m_Covariance;
+	}
+
+	glm::vec3 getMean() const
+	{
+		return m_Mean;
+	}
+
+	glm::vec3 getEigenValues() const
+	{
+		return m_EigenValues;
+	}
+
+	glm::mat3 getEigenVectors() const
+	{
+		return m_EigenVectors;
+	}
+
+	/// <summary>
+	/// Normal of the fitted plane, the eigenvector of the smallest eigenvalue
+	/// </summary>
+	glm::vec3 getPlaneNormal() const
+	{
+		return m_EigenVectors[0];
+	}
+
 	bool operator==(Cell other) const 
 	{ 
 		auto other_index = other.getIndex();
@@ -57,7 +103,7 @@ public:
 		return m_Type;
 	}
 
-	static inline std::string getKey(BoundingBox boundingBox, glm::vec3 cellSize, glm::vec3 point)
+	static inline std::string getKey(const BoundingBox &boundingBox, glm::vec3 cellSize, glm::vec3 point)
 	{
 		auto coords = (point - boundingBox.getMinPoint()) / cellSize;
 
@@ -68,7 +114,7 @@ public:
 		return std::to_string(x) + "," + std::to_string(y) + "," + std::to_string(z);
 	}
 
-	static inline glm::vec3 getCellSize(BoundingBox boundingBox, int devisions)
+	static inline glm::vec3 getCellSize(const BoundingBox &boundingBox, int devisions)
 	{
 		return (boundingBox.getMaxPoint() - boundingBox.getMinPoint()) / (float)devisions;
 	}
@@ -79,7 +125,10 @@ private:
 	std::vector<Point*> m_Points;
 	glm::vec3 m_Index;
 	glm::vec3 m_AverageNormal{ 0.0f };
-	glm::vec3 m_Covariance{ 0.0f };
+	glm::vec3 m_Mean{ 0.0f };
+	glm::mat3 m_Covariance{ 0.0f };
 
-	glm::vec3 m_EigenVector{ 0.0f };
+	// Ascending
+	glm::vec3 m_EigenValues{ 0.0f };
+	glm::mat3 m_EigenVectors{ 1.0f };
 };
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "Clustering.h"
+
+#include <algorithm>
+#include <numeric>
+#include <execution>
+#include <limits>
+#include <imgui.h>
+
+void Clustering::cluster(const Point *points, int width, int height, const std::vector<int> &activePoints)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	const int count = width * height;
+	m_SquaredDistance = m_DistanceThreshold * m_DistanceThreshold;
+
+	m_Parents.resize(count);
+	if (activePoints.empty())
+	{
+		for (int i = 0; i < count; i++)
+			m_Parents[i] = points[i].Depth > 0 ? i : -1;
+	}
+	else
+	{
+		std::fill(m_Parents.begin(), m_Parents.end(), -1);
+		for (int i : activePoints)
+			m_Parents[i] = points[i].Depth > 0 ? i : -1;
+	}
+
+	// Unions inside a strip only touch pixels of that strip, so the strips can run in parallel
+	std::vector<int> strips((height + StripHeight - 1) / StripHeight);
+	std::iota(strips.begin(), strips.end(), 0);
+
+	std::for_each(std::execution::par, strips.begin(), strips.end(), [&](int strip)
+		{
+			labelStrip(points, width, strip * StripHeight, std::min(height, (strip + 1) * StripHeight));
+		});
+
+	// Join the strips along their borders
+	for (int strip = 1; strip < (int)strips.size(); strip++)
+	{
+		int first = strip * StripHeight * width;
+		for (int i = first; i < first + width; i++)
+		{
+			if (m_Parents[i] >= 0 && m_Parents[i - width] >= 0)
+				unite(points, i, i - width);
+		}
+	}
+
+	m_Labels.resize(count);
+	std::for_each(std::execution::par, strips.begin(), strips.end(), [&](int strip)
+		{
+			int last = std::min(height, (strip + 1) * StripHeight) * width;
+			for (int i = strip * StripHeight * width; i < last; i++)
+				m_Labels[i] = m_Parents[i] >= 0 ? findRoot(i) : -1;
+		});
+
+	// Sizes are counted at the roots, afterwards the roots hold the cluster index
+	std::vector<int> clusterByRoot(count, 0);
+	for (int i = 0; i < count; i++)
+	{
+		if (m_Labels[i] >= 0)
+			clusterByRoot[m_Labels[i]]++;
+	}
+
+	std::vector<int> sizes;
+	for (int i = 0; i < count; i++)
+	{
+		if (m_Labels[i] != i)
+			continue;
+
+		if (clusterByRoot[i] >= m_MinClusterSize)
+		{
+			sizes.push_back(clusterByRoot[i]);
+			clusterByRoot[i] = (int)sizes.size() - 1;
+		}
+		else
+			clusterByRoot[i] = -1;
+	}
+
+	// Largest cluster first
+	std::vector<int> order(sizes.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&sizes](int a, int b) { return sizes[a] > sizes[b]; });
+
+	std::vector<int> rank(sizes.size());
+	for (int i = 0; i < (int)order.size(); i++)
+		rank[order[i]] = i;
+
+	m_Clusters.resize(sizes.size());
+	for (int c = 0; c < (int)sizes.size(); c++)
+	{
+		auto &cluster = m_Clusters[c];
+		cluster.Indices.clear();
+		cluster.Indices.reserve(sizes[order[c]]);
+		cluster.Min = glm::vec3{ std::numeric_limits<float>::max() };
+		cluster.Max = glm::vec3{ std::numeric_limits<float>::lowest() };
+		cluster.Centroid = glm::vec3{ 0.0f };
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		if (m_Labels[i] < 0)
+			continue;
+
+		int c = clusterByRoot[m_Labels[i]];
+		if (c < 0)
+		{
+			m_Labels[i] = -1;
+			continue;
+		}
+
+		c = rank[c];
+		m_Labels[i] = c;
+
+		auto p = points[i].getPoint();
+		auto &cluster = m_Clusters[c];
+		cluster.Indices.push_back(i);
+		cluster.Min = glm::min(cluster.Min, p);
+		cluster.Max = glm::max(cluster.Max, p);
+		cluster.Centroid += p;
+	}
+
+	for (auto &cluster : m_Clusters)
+		cluster.Centroid /= (float)cluster.Indices.size();
+
+	m_LastRunTime = std::chrono::high_resolution_clock::now() - start;
+}
+
+void Clustering::labelStrip(const Point *points, int width, int firstRow, int lastRow)
+{
+	for (int y = firstRow; y < lastRow; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			int i = y * width + x;
+			if (m_Parents[i] < 0)
+				continue;
+
+			if (x > 0 && m_Parents[i - 1] >= 0)
+				unite(points, i, i - 1);
+			if (y > firstRow && m_Parents[i - width] >= 0)
+				unite(points, i, i - width);
+		}
+	}
+}
+
+void Clustering::unite(const Point *points, int a, int b)
+{
+	auto d = points[a].getPoint() - points[b].getPoint();
+	if (glm::dot(d, d) > m_SquaredDistance)
+		return;
+
+	int rootA = find(a);
+	int rootB = find(b);
+	if (rootA == rootB)
+		return;
+
+	// The smaller index becomes the root, this keeps the result independent of the strip order
+	m_Parents[std::max(rootA, rootB)] = std::min(rootA, rootB);
+}
+
+int Clustering::find(int i)
+{
+	while (m_Parents[i] != i)
+	{
+		m_Parents[i] = m_Parents[m_Parents[i]];
+		i = m_Parents[i];
+	}
+	return i;
+}
+
+int Clustering::findRoot(int i) const
+{
+	while (m_Parents[i] != i)
+		i = m_Parents[i];
+	return i;
+}
+
+void Clustering::OnImGuiRender()
+{
+	ImGui::Checkbox("Cluster Points", &m_IsEnabled);
+
+	ImGui::BeginDisabled(!m_IsEnabled);
+	ImGui::SliderFloat("Distance Threshold (m)", &m_DistanceThreshold, 0.005f, 0.5f);
+	ImGui::SliderInt("Min Cluster Size (points)", &m_MinClusterSize, 1, 10000);
+
+	ImGui::Text("%d Clusters, Last run: %.3f ms", (int)m_Clusters.size(), m_LastRunTime.count());
+	for (int c = 0; c < std::min((int)m_Clusters.size(), 8); c++)
+	{
+		auto &cluster = m_Clusters[c];
+		auto size = cluster.Max - cluster.Min;
+		ImGui::Text("%d: %d points at %.2f, %.2f, %.2f, size %.2f x %.2f x %.2f m", c, (int)cluster.Indices.size(),
+			cluster.Centroid.x, cluster.Centroid.y, cluster.Centroid.z, size.x, size.y, size.z);
+	}
+	ImGui::EndDisabled();
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <chrono>
+#include <glm/glm.hpp>
+
+#include "Point.h"
+
+/// <summary>
+/// Euclidean clustering of an organized point cloud.
+/// Neighbouring pixels on the depth grid are connected if their points are closer than a threshold,
+/// the connected components are found with union-find. Row strips are labelled in parallel and
+/// joined along the strip borders afterwards. Points without depth are never clustered.
+/// </summary>
+class Clustering
+{
+public:
+	struct Cluster
+	{
+		glm::vec3 Min{ 0.0f };
+		glm::vec3 Max{ 0.0f };
+		glm::vec3 Centroid{ 0.0f };
+
+		/// <summary>
+		/// Indices into the point array
+		/// </summary>
+		std::vector<int> Indices;
+	};
+
+	/// <summary>
+	/// Clusters all points with depth
+	/// </summary>
+	/// <param name="points">Row major grid of width * height points</param>
+	/// <param name="activePoints">Points to consider, all points with depth are visited if empty</param>
+	void cluster(const Point *points, int width, int height, const std::vector<int> &activePoints = {});
+
+	/// <returns>Clusters sorted by size, largest first</returns>
+	const std::vector<Cluster> &getClusters() const { return m_Clusters; }
+
+	/// <returns>Cluster of every point, -1 if it is in none</returns>
+	const std::vector<int> &getLabels() const { return m_Labels; }
+
+	void OnImGuiRender();
+
+	bool m_IsEnabled{ false };
+
+	/// <summary>
+	/// Maximum distance between neighbouring points of one cluster in meters
+	/// </summary>
+	float m_DistanceThreshold{ 0.05f };
+	int m_MinClusterSize{ 500 };
+
+	static const int StripHeight = 16;
+private:
+	void labelStrip(const Point *points, int width, int firstRow, int lastRow);
+	void unite(const Point *points, int a, int b);
+	int findRoot(int i) const;
+	int find(int i);
+
+	// Union-find forest over the pixels, -1 for pixels without depth
+	std::vector<int> m_Parents;
+	std::vector<int> m_Labels;
+	std::vector<Cluster> m_Clusters;
+
+	float m_SquaredDistance{ 0.0f };
+
+	std::chrono::duration<double, std::milli> m_LastRunTime{ 0.0 };
+};
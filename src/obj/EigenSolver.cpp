@@ -0,0 +1,482 @@
+#include "EigenSolver.h"
+
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+#include <utilities/Simd.h>
+
+namespace
+{
+	// The kernel is written once against these helpers and instantiated for float (single matrices, tail)
+	// and for 8 lanes of AVX2.
+	inline float select(bool mask, float a, float b) { return mask ? a : b; }
+	inline float vsqrt(float a) { return std::sqrt(a); }
+	inline float vabs(float a) { return std::abs(a); }
+	inline float vmin(float a, float b) { return std::min(a, b); }
+	inline float vmax(float a, float b) { return std::max(a, b); }
+
+#ifdef FESD_AVX2
+	struct F8Mask
+	{
+		__m256 v;
+	};
+
+	struct F8
+	{
+		__m256 v;
+
+		F8() = default;
+		F8(__m256 x) : v(x) { }
+		F8(float f) : v(_mm256_set1_ps(f)) { }
+	};
+
+	inline F8 operator+(F8 a, F8 b) { return _mm256_add_ps(a.v, b.v); }
+	inline F8 operator-(F8 a, F8 b) { return _mm256_sub_ps(a.v, b.v); }
+	inline F8 operator*(F8 a, F8 b) { return _mm256_mul_ps(a.v, b.v); }
+	inline F8 operator/(F8 a, F8 b) { return _mm256_div_ps(a.v, b.v); }
+	inline F8 operator-(F8 a) { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)); }
+	inline F8Mask operator<(F8 a, F8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+	inline F8Mask operator>(F8 a, F8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+
+	inline F8 select(F8Mask mask, F8 a, F8 b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+	inline F8 vsqrt(F8 a) { return _mm256_sqrt_ps(a.v); }
+	inline F8 vabs(F8 a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+	inline F8 vmin(F8 a, F8 b) { return _mm256_min_ps(a.v, b.v); }
+	inline F8 vmax(F8 a, F8 b) { return _mm256_max_ps(a.v, b.v); }
+#endif
+
+	template <typename T>
+	struct Vec3
+	{
+		T x, y, z;
+	};
+
+	template <typename T>
+	inline T dot(const Vec3<T> &a, const Vec3<T> &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+	template <typename T>
+	inline Vec3<T> cross(const Vec3<T> &a, const Vec3<T> &b)
+	{
+		return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+	}
+
+	template <typename T, typename M>
+	inline Vec3<T> select(M mask, const Vec3<T> &a, const Vec3<T> &b)
+	{
+		return { select(mask, a.x, b.x), select(mask, a.y, b.y), select(mask, a.z, b.z) };
+	}
+
+	template <typename T>
+	inline Vec3<T> scale(const Vec3<T> &a, T s) { return { a.x * s, a.y * s, a.z * s }; }
+
+	/// <summary>
+	/// acos for [-1, 1], Abramowitz and Stegun 4.4.46, |error| below 2e-8
+	/// </summary>
+	template <typename T>
+	inline T acosApprox(T x)
+	{
+		T a = vabs(x);
+		T poly = T(-0.0012624911f);
+		poly = poly * a + T(0.0066700901f);
+		poly = poly * a + T(-0.0170881256f);
+		poly = poly * a + T(0.0308918810f);
+		poly = poly * a + T(-0.0501743046f);
+		poly = poly * a + T(0.0889789874f);
+		poly = poly * a + T(-0.2145988016f);
+		poly = poly * a + T(1.5707963050f);
+		T result = vsqrt(T(1.0f) - a) * poly;
+		return select(x < T(0.0f), T(3.14159265f) - result, result);
+	}
+
+	/// <summary>
+	/// Taylor series, exact to float precision for [0, pi/3]
+	/// </summary>
+	template <typename T>
+	inline void sinCosApprox(T x, T &sin, T &cos)
+	{
+		T x2 = x * x;
+		cos = T(1.0f) + x2 * (T(-1.0f / 2.0f) + x2 * (T(1.0f / 24.0f) + x2 * (T(-1.0f / 720.0f) + x2 * (T(1.0f / 40320.0f) + x2 * T(-1.0f / 3628800.0f)))));
+		sin = x * (T(1.0f) + x2 * (T(-1.0f / 6.0f) + x2 * (T(1.0f / 120.0f) + x2 * (T(-1.0f / 5040.0f) + x2 * (T(1.0f / 362880.0f) + x2 * T(-1.0f / 39916800.0f))))));
+	}
+
+	/// <returns>Unit vector orthogonal to v</returns>
+	template <typename T>
+	inline Vec3<T> anyOrthogonal(const Vec3<T> &v)
+	{
+		auto mask = vabs(v.x) > vabs(v.z);
+		Vec3<T> o = select(mask, Vec3<T>{ -v.y, v.x, T(0.0f) }, Vec3<T>{ T(0.0f), -v.z, v.y });
+		T length = dot(o, o);
+		// v itself may be zero, fall back to the x axis then
+		o = select(length > T(1e-20f), o, Vec3<T>{ T(1.0f), T(0.0f), T(0.0f) });
+		return scale(o, T(1.0f) / vsqrt(vmax(dot(o, o), T(1e-20f))));
+	}
+
+	/// <summary>
+	/// Eigenvector of a simple eigenvalue: the largest cross product of two rows of A - λI
+	/// </summary>
+	template <typename T>
+	inline Vec3<T> eigenVector(const T a[6], T lambda, const Vec3<T> &fallback)
+	{
+		Vec3<T> r0{ a[0] - lambda, a[1], a[2] };
+		Vec3<T> r1{ a[1], a[3] - lambda, a[4] };
+		Vec3<T> r2{ a[2], a[4], a[5] - lambda };
+
+		auto c01 = cross(r0, r1);
+		auto c02 = cross(r0, r2);
+		auto c12 = cross(r1, r2);
+
+		T d01 = dot(c01, c01);
+		T d02 = dot(c02, c02);
+		T d12 = dot(c12, c12);
+
+		auto best = select(d02 > d01, c02, c01);
+		T bestLength = vmax(d01, d02);
+		best = select(d12 > bestLength, c12, best);
+		bestLength = vmax(bestLength, d12);
+
+		auto valid = bestLength > T(1e-20f);
+		best = scale(best, T(1.0f) / vsqrt(vmax(bestLength, T(1e-20f))));
+		return select(valid, best, fallback);
+	}
+
+	/// <returns>v^T A v</returns>
+	template <typename T>
+	inline T rayleighQuotient(const T a[6], const Vec3<T> &v)
+	{
+		return a[0] * v.x * v.x + a[3] * v.y * v.y + a[5] * v.z * v.z
+			 + T(2.0f) * (a[1] * v.x * v.y + a[2] * v.x * v.z + a[4] * v.y * v.z);
+	}
+
+	template <typename T>
+	inline void sortPair(T &la, Vec3<T> &va, T &lb, Vec3<T> &vb)
+	{
+		auto swap = la > lb;
+		T l = la;
+		auto v = va;
+		la = select(swap, lb, la);
+		va = select(swap, vb, va);
+		lb = select(swap, l, lb);
+		vb = select(swap, v, vb);
+	}
+
+	/// <param name="m">xx, xy, xz, yy, yz, zz</param>
+	/// <param name="values">Ascending eigenvalues</param>
+	/// <param name="vectors">Column major eigenvectors</param>
+	template <typename T>
+	inline void solveKernel(const T m[6], T values[3], T vectors[9])
+	{
+		// Normalise so the thresholds below don't depend on the units
+		T scaleFactor = vmax(vmax(vmax(vabs(m[0]), vabs(m[1])), vmax(vabs(m[2]), vabs(m[3]))), vmax(vabs(m[4]), vabs(m[5])));
+		T invScale = select(scaleFactor > T(0.0f), T(1.0f) / vmax(scaleFactor, T(1e-30f)), T(0.0f));
+
+		T a[6];
+		for (int i = 0; i < 6; i++)
+			a[i] = m[i] * invScale;
+
+		T q = (a[0] + a[3] + a[5]) * T(1.0f / 3.0f);
+		T b00 = a[0] - q;
+		T b11 = a[3] - q;
+		T b22 = a[5] - q;
+
+		T p1 = a[1] * a[1] + a[2] * a[2] + a[4] * a[4];
+		T p2 = b00 * b00 + b11 * b11 + b22 * b22 + T(2.0f) * p1;
+		T p = vsqrt(p2 * T(1.0f / 6.0f));
+		T safeP = select(p > T(1e-12f), p, T(1.0f));
+
+		// det((A - qI) / p) / 2
+		T det = b00 * (b11 * b22 - a[4] * a[4])
+			  - a[1] * (a[1] * b22 - a[4] * a[2])
+			  + a[2] * (a[1] * a[4] - b11 * a[2]);
+		T r = vmin(vmax(det / (T(2.0f) * safeP * safeP * safeP), T(-1.0f)), T(1.0f));
+
+		T phi = acosApprox(r) * T(1.0f / 3.0f);
+		T sinPhi, cosPhi;
+		sinCosApprox(phi, sinPhi, cosPhi);
+
+		// cos(phi + 2pi/3) = -cos(phi) / 2 - sqrt(3) / 2 * sin(phi)
+		T largest = q + T(2.0f) * p * cosPhi;
+		T smallest = q - p * cosPhi - T(1.7320508f) * p * sinPhi;
+		T middle = T(3.0f) * q - smallest - largest;
+
+		// Start with the eigenvalue that is further away from the middle, it is simple unless A = qI
+		auto largestFirst = (largest - middle) > (middle - smallest);
+		T first = select(largestFirst, largest, smallest);
+
+		Vec3<T> xAxis{ T(1.0f), T(0.0f), T(0.0f) };
+		auto v = eigenVector(a, first, xAxis);
+
+		// The other two eigenvectors span the plane orthogonal to v,
+		// solving the projected 2x2 problem keeps them accurate even when their eigenvalues are close
+		auto u = anyOrthogonal(v);
+		auto t = cross(v, u);
+
+		Vec3<T> au{ a[0] * u.x + a[1] * u.y + a[2] * u.z, a[1] * u.x + a[3] * u.y + a[4] * u.z, a[2] * u.x + a[4] * u.y + a[5] * u.z };
+		Vec3<T> at{ a[0] * t.x + a[1] * t.y + a[2] * t.z, a[1] * t.x + a[3] * t.y + a[4] * t.z, a[2] * t.x + a[4] * t.y + a[5] * t.z };
+
+		T a11 = dot(u, au);
+		T a12 = dot(u, at);
+		T a22 = dot(t, at);
+
+		T half = (a11 - a22) * T(0.5f);
+		T upper = (a11 + a22) * T(0.5f) + vsqrt(half * half + a12 * a12);
+
+		// Eigenvector of the upper eigenvalue in (u, t) coordinates, two candidates for stability
+		T c0 = a12, c1 = upper - a11;
+		T d0 = upper - a22, d1 = a12;
+		auto useD = (d0 * d0 + d1 * d1) > (c0 * c0 + c1 * c1);
+		T e0 = select(useD, d0, c0);
+		T e1 = select(useD, d1, c1);
+		T eLength = e0 * e0 + e1 * e1;
+		auto valid = eLength > T(1e-30f);
+		T invLength = T(1.0f) / vsqrt(vmax(eLength, T(1e-30f)));
+		e0 = select(valid, e0 * invLength, T(1.0f));
+		e1 = select(valid, e1 * invLength, T(0.0f));
+
+		Vec3<T> wUpper{ e0 * u.x + e1 * t.x, e0 * u.y + e1 * t.y, e0 * u.z + e1 * t.z };
+		auto wLower = cross(v, wUpper);
+
+		auto v2 = select(largestFirst, v, wUpper);
+		auto v1 = select(largestFirst, wUpper, wLower);
+		auto v0 = select(largestFirst, wLower, v);
+
+		// The trigonometric eigenvalues lose relative precision on small eigenvalues,
+		// the Rayleigh quotients of the (accurate) eigenvectors don't
+		T l0 = rayleighQuotient(a, v0);
+		T l1 = rayleighQuotient(a, v1);
+		T l2 = rayleighQuotient(a, v2);
+
+		// Rounding can still swap the order of (nearly) equal eigenvalues
+		sortPair(l0, v0, l1, v1);
+		sortPair(l1, v1, l2, v2);
+		sortPair(l0, v0, l1, v1);
+
+		values[0] = l0 * scaleFactor;
+		values[1] = l1 * scaleFactor;
+		values[2] = l2 * scaleFactor;
+
+		vectors[0] = v0.x; vectors[1] = v0.y; vectors[2] = v0.z;
+		vectors[3] = v1.x; vectors[4] = v1.y; vectors[5] = v1.z;
+		vectors[6] = v2.x; vectors[7] = v2.y; vectors[8] = v2.z;
+	}
+}
+
+void EigenSolver::resize(size_t count)
+{
+	m_Count = count;
+
+	// Padded to full AVX2 lanes, padding matrices are zero
+	size_t padded = (count + 7) / 8 * 8;
+
+	for (auto &component : m_Matrices)
+		component.assign(padded, 0.0f);
+	for (auto &component : m_Values)
+		component.resize(padded);
+	for (auto &component : m_Vectors)
+		component.resize(padded);
+}
+
+void EigenSolver::setMatrix(size_t i, const glm::mat3 &matrix)
+{
+	m_Matrices[0][i] = matrix[0][0];
+	m_Matrices[1][i] = matrix[0][1];
+	m_Matrices[2][i] = matrix[0][2];
+	m_Matrices[3][i] = matrix[1][1];
+	m_Matrices[4][i] = matrix[1][2];
+	m_Matrices[5][i] = matrix[2][2];
+}
+
+void EigenSolver::solve()
+{
+	size_t i = 0;
+
+#ifdef FESD_AVX2
+	for (; i + 8 <= m_Values[0].size(); i += 8)
+	{
+		F8 m[6], values[3], vectors[9];
+
+		for (int c = 0; c < 6; c++)
+			m[c] = _mm256_loadu_ps(&m_Matrices[c][i]);
+
+		solveKernel(m, values, vectors);
+
+		for (int c = 0; c < 3; c++)
+			_mm256_storeu_ps(&m_Values[c][i], values[c].v);
+		for (int c = 0; c < 9; c++)
+			_mm256_storeu_ps(&m_Vectors[c][i], vectors[c].v);
+	}
+#endif
+
+	for (; i < m_Count; i++)
+	{
+		float m[6], values[3], vectors[9];
+
+		for (int c = 0; c < 6; c++)
+			m[c] = m_Matrices[c][i];
+
+		solveKernel(m, values, vectors);
+
+		for (int c = 0; c < 3; c++)
+			m_Values[c][i] = values[c];
+		for (int c = 0; c < 9; c++)
+			m_Vectors[c][i] = vectors[c];
+	}
+}
+
+glm::vec3 EigenSolver::getEigenValues(size_t i) const
+{
+	return { m_Values[0][i], m_Values[1][i], m_Values[2][i] };
+}
+
+glm::mat3 EigenSolver::getEigenVectors(size_t i) const
+{
+	glm::mat3 vectors;
+	for (int c = 0; c < 9; c++)
+		vectors[c / 3][c % 3] = m_Vectors[c][i];
+	return vectors;
+}
+
+void EigenSolver::solveClosedForm(const glm::mat3 &matrix, glm::vec3 &values, glm::mat3 &vectors)
+{
+	float m[6] = { matrix[0][0], matrix[0][1], matrix[0][2], matrix[1][1], matrix[1][2], matrix[2][2] };
+	float v[3], vec[9];
+
+	solveKernel(m, v, vec);
+
+	values = { v[0], v[1], v[2] };
+	for (int c = 0; c < 9; c++)
+		vectors[c / 3][c % 3] = vec[c];
+}
+
+void EigenSolver::solveJacobi(const glm::mat3 &matrix, glm::vec3 &values, glm::mat3 &vectors)
+{
+	double a[3][3];
+	double v[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+
+	for (int r = 0; r < 3; r++)
+		for (int c = 0; c < 3; c++)
+			a[r][c] = matrix[c][r];
+
+	for (int sweep = 0; sweep < 50; sweep++)
+	{
+		double offDiagonal = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+		if (offDiagonal < 1e-30)
+			break;
+
+		for (int p = 0; p < 2; p++)
+		{
+			for (int q = p + 1; q < 3; q++)
+			{
+				if (a[p][q] == 0.0)
+					continue;
+
+				double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+				double t = (theta >= 0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+				double c = 1.0 / std::sqrt(t * t + 1.0);
+				double s = t * c;
+
+				// A = J^T A J
+				for (int k = 0; k < 3; k++)
+				{
+					double akp = a[k][p];
+					double akq = a[k][q];
+					a[k][p] = c * akp - s * akq;
+					a[k][q] = s * akp + c * akq;
+				}
+				for (int k = 0; k < 3; k++)
+				{
+					double apk = a[p][k];
+					double aqk = a[q][k];
+					a[p][k] = c * apk - s * aqk;
+					a[q][k] = s * apk + c * aqk;
+				}
+				for (int k = 0; k < 3; k++)
+				{
+					double vkp = v[k][p];
+					double vkq = v[k][q];
+					v[k][p] = c * vkp - s * vkq;
+					v[k][q] = s * vkp + c * vkq;
+				}
+			}
+		}
+	}
+
+	int order[3] = { 0, 1, 2 };
+	std::sort(order, order + 3, [&](int l, int r) { return a[l][l] < a[r][r]; });
+
+	for (int i = 0; i < 3; i++)
+	{
+		values[i] = (float)a[order[i]][order[i]];
+		for (int k = 0; k < 3; k++)
+			vectors[i][k] = (float)v[k][order[i]];
+	}
+}
+
+EigenSolver::BenchmarkResult EigenSolver::benchmark(int count)
+{
+	BenchmarkResult result;
+	result.Count = count;
+
+	// Covariances of random anisotropic point clouds: R diag(s) R^T
+	std::default_random_engine generator(42);
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> logScale(-6.0f, 0.0f);
+
+	std::vector<glm::mat3> matrices(count);
+	for (auto &matrix : matrices)
+	{
+		glm::vec3 axis = glm::normalize(glm::vec3(uniform(generator), uniform(generator), uniform(generator)) + glm::vec3(1e-3f));
+		float angle = uniform(generator) * 3.14159265f;
+		glm::mat3 rotation = glm::mat3(glm::cos(angle)) + glm::sin(angle) * glm::mat3(0, axis.z, -axis.y, -axis.z, 0, axis.x, axis.y, -axis.x, 0)
+						   + (1.0f - glm::cos(angle)) * glm::outerProduct(axis, axis);
+		glm::mat3 diagonal(0.0f);
+		for (int i = 0; i < 3; i++)
+			diagonal[i][i] = std::pow(10.0f, logScale(generator));
+		matrix = rotation * diagonal * glm::transpose(rotation);
+	}
+
+	EigenSolver solver;
+	solver.resize(count);
+	for (int i = 0; i < count; i++)
+		solver.setMatrix(i, matrices[i]);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	solver.solve();
+	result.BatchTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	glm::vec3 values;
+	glm::mat3 vectors;
+
+	start = std::chrono::high_resolution_clock::now();
+	for (auto &matrix : matrices)
+		solveClosedForm(matrix, values, vectors);
+	result.ClosedFormTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	std::vector<glm::vec3> referenceValues(count);
+	std::vector<glm::mat3> referenceVectors(count);
+
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < count; i++)
+		solveJacobi(matrices[i], referenceValues[i], referenceVectors[i]);
+	result.JacobiTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	for (int i = 0; i < count; i++)
+	{
+		auto batchValues = solver.getEigenValues(i);
+		auto batchVectors = solver.getEigenVectors(i);
+		auto &reference = referenceValues[i];
+
+		for (int k = 0; k < 3; k++)
+		{
+			result.MaxValueError = std::max(result.MaxValueError, std::abs(batchValues[k] - reference[k]) / reference[2]);
+
+			// Vectors of nearly equal eigenvalues are not unique
+			float gap = std::min(k > 0 ? reference[k] - reference[k - 1] : INFINITY, k < 2 ? reference[k + 1] - reference[k] : INFINITY);
+			if (gap > 0.01f * reference[2])
+				result.MaxVectorError = std::max(result.MaxVectorError, 1.0f - std::abs(glm::dot(batchVectors[k], referenceVectors[i][k])));
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <glm/glm.hpp>
+
+/// <summary>
+/// Eigendecomposition of symmetric 3x3 matrices (cell covariances).
+/// Matrices are collected in structure of arrays layout and solved 8 at a time with AVX2,
+/// using the closed form trigonometric method with eigenvectors from cross products of the rows of A - λI.
+/// Eigenvalues are sorted ascending, eigenvector i is column i.
+/// </summary>
+class EigenSolver
+{
+public:
+	void resize(size_t count);
+	size_t size() const { return m_Count; }
+
+	void setMatrix(size_t i, const glm::mat3 &matrix);
+
+	/// <summary>
+	/// Decomposes all matrices
+	/// </summary>
+	void solve();
+
+	glm::vec3 getEigenValues(size_t i) const;
+	glm::mat3 getEigenVectors(size_t i) const;
+
+	/// <summary>
+	/// Closed form solution of a single matrix, same math as the batch
+	/// </summary>
+	static void solveClosedForm(const glm::mat3 &matrix, glm::vec3 &values, glm::mat3 &vectors);
+
+	/// <summary>
+	/// Cyclic Jacobi rotations in double precision, slow but accurate reference
+	/// </summary>
+	static void solveJacobi(const glm::mat3 &matrix, glm::vec3 &values, glm::mat3 &vectors);
+
+	struct BenchmarkResult
+	{
+		int Count{ 0 };
+		double BatchTime{ 0.0 };
+		double ClosedFormTime{ 0.0 };
+		double JacobiTime{ 0.0 };
+
+		/// <summary>
+		/// Largest eigenvalue difference to Jacobi relative to the largest eigenvalue
+		/// </summary>
+		float MaxValueError{ 0.0f };
+
+		/// <summary>
+		/// Largest 1 - |cos| between batch and Jacobi eigenvectors of well separated eigenvalues
+		/// </summary>
+		float MaxVectorError{ 0.0f };
+	};
+
+	/// <summary>
+	/// Times the batch, the single closed form and the Jacobi solver on random covariances (times in ms)
+	/// </summary>
+	static BenchmarkResult benchmark(int count);
+private:
+	size_t m_Count{ 0 };
+
+	// xx, xy, xz, yy, yz, zz
+	std::array<std::vector<float>, 6> m_Matrices;
+	std::array<std::vector<float>, 3> m_Values;
+	// Column major, component j of vector i at 3 * i + j
+	std::array<std::vector<float>, 9> m_Vectors;
+};
@@ -0,0 +1,323 @@
+#include "FloorDetector.h"
+#include "EigenSolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <imgui.h>
+
+void FloorDetector::setGravity(glm::vec3 gravity, bool isValid)
+{
+	m_HasGravity = isValid && glm::dot(gravity, gravity) > 0.0f;
+	if (m_HasGravity)
+		m_Gravity = glm::normalize(gravity);
+}
+
+glm::vec3 FloorDetector::getUp(const std::vector<Cell *> &planarCells, float &maxAngle) const
+{
+	maxAngle = m_MaxNormalAngle;
+	if (m_HasGravity)
+		return -m_Gravity;
+
+	// Without gravity the camera is assumed to be roughly upright
+	const glm::vec3 prior{ 0.0f, 1.0f, 0.0f };
+	const float minTiltCos = std::cos(glm::radians(m_MaxTilt));
+	const float minNormalCos = std::cos(glm::radians(m_MaxNormalAngle));
+
+	std::vector<std::pair<float, glm::vec3>> candidates;
+	for (auto cell : planarCells)
+	{
+		auto normal = cell->getPlaneNormal();
+		if (glm::dot(normal, prior) < 0.0f)
+			normal = -normal;
+
+		if (glm::dot(normal, prior) >= minTiltCos)
+			candidates.push_back({ (float)cell->getPoints().size(), normal });
+	}
+
+	if (candidates.empty())
+	{
+		maxAngle = m_MaxTilt;
+		return prior;
+	}
+
+	// The direction supported by the most points wins, the vote is quadratic so only the largest cells take part
+	const size_t maxVoters = 256;
+	if (candidates.size() > maxVoters)
+	{
+		std::partial_sort(candidates.begin(), candidates.begin() + maxVoters, candidates.end(),
+			[](const auto &a, const auto &b) { return a.first > b.first; });
+		candidates.resize(maxVoters);
+	}
+
+	float bestSupport = -1.0f;
+	glm::vec3 bestDirection = prior;
+	for (auto const &[_, normal] : candidates)
+	{
+		float support = 0.0f;
+		glm::vec3 direction{ 0.0f };
+		for (auto const &[weight, other] : candidates)
+		{
+			if (glm::dot(normal, other) >= minNormalCos)
+			{
+				support += weight;
+				direction += weight * other;
+			}
+		}
+
+		if (support > bestSupport)
+		{
+			bestSupport = support;
+			bestDirection = glm::normalize(direction);
+		}
+	}
+
+	return bestDirection;
+}
+
+void FloorDetector::samplePoints(const Point *points, int count)
+{
+	if (m_SampledFrameSize != count || (int)m_SampleIndices.size() != m_SampleCount)
+	{
+		std::uniform_int_distribution<int> distribution(0, count - 1);
+		m_SampleIndices.resize(m_SampleCount);
+		for (auto &index : m_SampleIndices)
+			index = distribution(m_Generator);
+		m_SampledFrameSize = count;
+	}
+
+	m_Samples.clear();
+	for (auto index : m_SampleIndices)
+	{
+		if (points[index].Depth > 0)
+			m_Samples.push_back(points[index].getPoint());
+	}
+}
+
+bool FloorDetector::detect(const Point *points, int count, const std::vector<Cell *> &planarCells)
+{
+	m_HasFloor = false;
+	m_Detections++;
+
+	float maxAngle;
+	auto up = getUp(planarCells, maxAngle);
+	const float minNormalCos = std::cos(glm::radians(maxAngle));
+
+	std::vector<Cell *> floorCells;
+	size_t cellPoints = 0;
+	for (auto cell : planarCells)
+	{
+		if (std::abs(glm::dot(cell->getPlaneNormal(), up)) >= minNormalCos)
+		{
+			floorCells.push_back(cell);
+			cellPoints += cell->getPoints().size();
+		}
+	}
+
+	// Keep the candidate set around four times the tracking sample
+	size_t stride = cellPoints / (4 * (size_t)std::max(m_SampleCount, 1)) + 1;
+	std::vector<glm::vec3> candidates;
+	size_t n = 0;
+	for (auto cell : floorCells)
+	{
+		for (auto point : cell->getPoints())
+		{
+			if (n++ % stride == 0 && point->Depth > 0)
+				candidates.push_back(point->getPoint());
+		}
+	}
+
+	if (candidates.size() < 3)
+	{
+		samplePoints(points, count);
+		candidates = m_Samples;
+	}
+
+	return fitRansac(candidates, up, maxAngle);
+}
+
+bool FloorDetector::fitRansac(const std::vector<glm::vec3> &candidates, glm::vec3 up, float maxAngle)
+{
+	if (candidates.size() < 3)
+		return false;
+
+	const float minNormalCos = std::cos(glm::radians(maxAngle));
+
+	// Hypotheses are scored on an evenly spaced subset
+	const size_t maxEvaluation = 1000;
+	size_t stride = candidates.size() / maxEvaluation + 1;
+
+	std::uniform_int_distribution<size_t> distribution(0, candidates.size() - 1);
+	std::vector<std::pair<Plane, int>> hypotheses;
+
+	for (int iteration = 0; iteration < m_Iterations; iteration++)
+	{
+		auto &p1 = candidates[distribution(m_Generator)];
+		auto &p2 = candidates[distribution(m_Generator)];
+		auto &p3 = candidates[distribution(m_Generator)];
+
+		auto normal = glm::cross(p2 - p1, p3 - p1);
+		float length = glm::length(normal);
+		if (length < 1e-9f)
+			continue;
+
+		normal /= length;
+		if (glm::dot(normal, up) < 0.0f)
+			normal = -normal;
+
+		// The constraint rejects walls and slopes before they are scored
+		if (glm::dot(normal, up) < minNormalCos)
+			continue;
+
+		Plane plane{ p1, normal };
+		int inliers = 0;
+		for (size_t i = 0; i < candidates.size(); i += stride)
+			inliers += plane.getDistance(candidates[i]) <= m_InlierDistance;
+
+		hypotheses.push_back({ plane, inliers });
+	}
+
+	if (hypotheses.empty())
+		return false;
+
+	int bestInliers = std::max_element(hypotheses.begin(), hypotheses.end(),
+		[](const auto &a, const auto &b) { return a.second < b.second; })->second;
+
+	if (bestInliers < 3)
+		return false;
+
+	// Tables and beds are horizontal too, the floor is the lowest plane with comparable support
+	Plane floor = hypotheses.front().first;
+	float lowest = -std::numeric_limits<float>::infinity();
+	for (auto const &[plane, inliers] : hypotheses)
+	{
+		float height = plane.getSignedDistance(glm::vec3{ 0.0f });
+		if (2 * inliers >= bestInliers && height > lowest)
+		{
+			lowest = height;
+			floor = plane;
+		}
+	}
+
+	int inliers = refine(candidates, floor, up, maxAngle);
+	m_LastInliers = inliers;
+	m_LastSamples = (int)candidates.size();
+
+	if (inliers < 3)
+		return false;
+
+	setFloor(floor);
+	return true;
+}
+
+int FloorDetector::refine(const std::vector<glm::vec3> &candidates, Plane &plane, glm::vec3 up, float maxAngle) const
+{
+	// Accumulated relative to the plane point to avoid cancellation
+	auto origin = plane.getPoint();
+	glm::vec3 sum{ 0.0f };
+	glm::vec3 sumSquares{ 0.0f };
+	glm::vec3 sumCross{ 0.0f };
+	int inliers = 0;
+
+	for (auto const &p : candidates)
+	{
+		if (plane.getDistance(p) > m_InlierDistance)
+			continue;
+
+		auto d = p - origin;
+		sum += d;
+		sumSquares += d * d;
+		sumCross += glm::vec3(d.x * d.y, d.x * d.z, d.y * d.z);
+		inliers++;
+	}
+
+	if (inliers < 3)
+		return inliers;
+
+	auto mean = sum / (float)inliers;
+	auto variance = sumSquares / (float)inliers - mean * mean;
+	auto crossVariance = sumCross / (float)inliers - glm::vec3(mean.x * mean.y, mean.x * mean.z, mean.y * mean.z);
+
+	glm::mat3 covariance{ variance.x,      crossVariance.x, crossVariance.y,
+						  crossVariance.x, variance.y,      crossVariance.z,
+						  crossVariance.y, crossVariance.z, variance.z };
+
+	glm::vec3 values;
+	glm::mat3 vectors;
+	EigenSolver::solveClosedForm(covariance, values, vectors);
+
+	auto normal = vectors[0];
+	if (glm::dot(normal, up) < 0.0f)
+		normal = -normal;
+
+	if (glm::dot(normal, up) < std::cos(glm::radians(maxAngle)))
+		return 0;
+
+	plane = Plane(origin + mean, normal);
+	return inliers;
+}
+
+bool FloorDetector::track(const Point *points, int count)
+{
+	if (!m_HasFloor)
+		return m_AutoDetect && detect(points, count);
+
+	samplePoints(points, count);
+	if (m_Samples.size() < 3)
+		return true;
+
+	// Without gravity the normal may only drift by the allowed angle from the last frame
+	auto up = m_HasGravity ? -m_Gravity : m_Floor.getNormal();
+
+	Plane plane = m_Floor;
+	int inliers = refine(m_Samples, plane, up, m_MaxNormalAngle);
+	m_LastInliers = inliers;
+	m_LastSamples = (int)m_Samples.size();
+
+	if (inliers < 3 || inliers < m_MinInlierFraction * m_Samples.size())
+	{
+		m_HasFloor = false;
+		return m_AutoDetect && detect(points, count);
+	}
+
+	setFloor(plane);
+	return true;
+}
+
+void FloorDetector::setFloor(const Plane &plane)
+{
+	m_Floor = plane;
+	m_HasFloor = true;
+
+	auto normal = plane.getNormal();
+	m_CameraHeight = plane.getSignedDistance(glm::vec3{ 0.0f });
+	m_Pitch = glm::degrees(std::atan2(-normal.z, normal.y));
+	m_Roll = glm::degrees(std::atan2(normal.x, normal.y));
+}
+
+void FloorDetector::OnImGuiRender()
+{
+	ImGui::Checkbox("Track Floor", &m_IsEnabled);
+	ImGui::Checkbox("Auto Detect", &m_AutoDetect);
+
+	ImGui::SliderFloat("Max Normal Angle (deg)", &m_MaxNormalAngle, 1.0f, 45.0f);
+	ImGui::SliderFloat("Max Tilt without IMU (deg)", &m_MaxTilt, 5.0f, 90.0f);
+	ImGui::SliderFloat("Inlier Distance (m)", &m_InlierDistance, 0.005f, 0.2f);
+	ImGui::SliderInt("RANSAC Iterations", &m_Iterations, 10, 2000);
+	ImGui::SliderInt("Samples", &m_SampleCount, 100, 20000);
+	ImGui::SliderFloat("Min Inlier Fraction", &m_MinInlierFraction, 0.01f, 0.5f);
+
+	ImGui::Text("Up Direction: %s", m_HasGravity ? "IMU" : "Planar Cells");
+
+	if (m_HasFloor)
+	{
+		auto normal = m_Floor.getNormal();
+		ImGui::Text("Camera Height: %.3f m", m_CameraHeight);
+		ImGui::Text("Pitch: %.1f deg, Roll: %.1f deg", m_Pitch, m_Roll);
+		ImGui::Text("Normal: %.3f, %.3f, %.3f", normal.x, normal.y, normal.z);
+	}
+	else
+		ImGui::Text("No floor");
+
+	ImGui::Text("Inliers: %d / %d, Detections: %d", m_LastInliers, m_LastSamples, m_Detections);
+}
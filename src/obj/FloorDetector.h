@@ -0,0 +1,113 @@
+#pragma once
+#include <vector>
+#include <random>
+#include <glm/glm.hpp>
+
+#include "Point.h"
+#include "Cell.h"
+#include "Plane.h"
+
+/// <summary>
+/// Finds the floor plane and from it the height and tilt of the camera.
+/// Detection fits a RANSAC plane whose normal is constrained to the up direction, either from gravity (IMU)
+/// or the dominant normal of the planar cells, and prefers the lowest well supported plane.
+/// Once found the floor is tracked by checking and refitting it on a fixed sample of pixels every frame.
+/// All coordinates are point cloud coordinates (y up).
+/// </summary>
+class FloorDetector
+{
+public:
+	/// <summary>
+	/// Full detection, uses the points of planar cells aligned with the up direction if there are any,
+	/// otherwise a sample of the whole frame
+	/// </summary>
+	/// <returns>True if a floor was found</returns>
+	bool detect(const Point *points, int count, const std::vector<Cell *> &planarCells = {});
+
+	/// <summary>
+	/// Cheap per frame verification and refinement of the current floor, detects again if the floor is lost
+	/// </summary>
+	/// <returns>True if there is a floor</returns>
+	bool track(const Point *points, int count);
+
+	/// <param name="gravity">Direction of gravity</param>
+	/// <param name="isValid">False if no IMU is available</param>
+	void setGravity(glm::vec3 gravity, bool isValid);
+
+	void reset() { m_HasFloor = false; }
+
+	bool hasFloor() const { return m_HasFloor; }
+	const Plane &getFloor() const { return m_Floor; }
+
+	/// <returns>Height of the camera above the floor in meters</returns>
+	float getCameraHeight() const { return m_CameraHeight; }
+
+	/// <returns>Rotation of the camera around its x axis in degrees, positive when looking down</returns>
+	float getPitch() const { return m_Pitch; }
+
+	/// <returns>Rotation of the camera around its optical axis in degrees</returns>
+	float getRoll() const { return m_Roll; }
+
+	void OnImGuiRender();
+
+	bool m_IsEnabled{ false };
+
+	/// <summary>
+	/// Detect again as soon as tracking loses the floor
+	/// </summary>
+	bool m_AutoDetect{ true };
+
+	/// <summary>
+	/// Maximum angle between the floor normal and the up direction in degrees
+	/// </summary>
+	float m_MaxNormalAngle{ 10.0f };
+
+	/// <summary>
+	/// Maximum angle of the dominant plane direction to the camera y axis if there is no gravity, in degrees
+	/// </summary>
+	float m_MaxTilt{ 45.0f };
+
+	float m_InlierDistance{ 0.03f };
+	int m_Iterations{ 200 };
+	int m_SampleCount{ 4000 };
+
+	/// <summary>
+	/// Fraction of the valid samples that have to lie on the floor while tracking
+	/// </summary>
+	float m_MinInlierFraction{ 0.05f };
+private:
+	/// <param name="maxAngle">Allowed deviation of the floor normal from the returned direction in degrees</param>
+	glm::vec3 getUp(const std::vector<Cell *> &planarCells, float &maxAngle) const;
+
+	void samplePoints(const Point *points, int count);
+	bool fitRansac(const std::vector<glm::vec3> &candidates, glm::vec3 up, float maxAngle);
+
+	/// <summary>
+	/// Least squares plane through the inliers of plane
+	/// </summary>
+	/// <returns>Number of inliers used</returns>
+	int refine(const std::vector<glm::vec3> &candidates, Plane &plane, glm::vec3 up, float maxAngle) const;
+
+	void setFloor(const Plane &plane);
+
+	Plane m_Floor{ glm::vec3{ 0.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f } };
+	bool m_HasFloor{ false };
+
+	float m_CameraHeight{ 0.0f };
+	float m_Pitch{ 0.0f };
+	float m_Roll{ 0.0f };
+
+	glm::vec3 m_Gravity{ 0.0f, -1.0f, 0.0f };
+	bool m_HasGravity{ false };
+
+	int m_LastInliers{ 0 };
+	int m_LastSamples{ 0 };
+	int m_Detections{ 0 };
+
+	// Fixed pixel sample for tracking, regenerated when the frame size changes
+	std::vector<int> m_SampleIndices;
+	int m_SampledFrameSize{ 0 };
+	std::vector<glm::vec3> m_Samples;
+
+	std::default_random_engine m_Generator;
+};
@@ -0,0 +1,197 @@
+#include "Logger.h"
+
+#include <iostream>
+#include <ctime>
+#include <imgui.h>
+
+namespace
+{
+	std::atomic<uint32_t> s_NextThreadId{ 1 };
+	thread_local uint32_t t_ThreadId = 0;
+
+	const char *LevelNames[] = { "INFO", "WARN", "ERROR" };
+}
+
+namespace Logger {
+	Logger::Logger(const std::filesystem::path &logFile)
+	{
+		if (!logFile.empty())
+			m_File.open(logFile, std::ios::out | std::ios::app);
+
+		m_Thread = std::thread(&Logger::run, this);
+
+		if (!logFile.empty() && !m_File.is_open())
+			log("Could not open log file '" + logFile.string() + "'", LogLevel::WARNING);
+	}
+
+	Logger::~Logger()
+	{
+		m_Stop.store(true, std::memory_order_release);
+		m_Signal.fetch_add(1, std::memory_order_release);
+		m_Signal.notify_one();
+		m_Thread.join();
+	}
+
+	void Logger::log(std::string msg, LogLevel level)
+	{
+		if (t_ThreadId == 0)
+			t_ThreadId = s_NextThreadId.fetch_add(1, std::memory_order_relaxed);
+
+		Record record;
+		record.Level = level;
+		record.Timestamp = std::chrono::system_clock::now();
+		record.ThreadId = t_ThreadId;
+		record.Message = std::move(msg);
+
+		if (!m_Ring.tryPush(record))
+		{
+			m_DroppedRecords.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		m_LoggedRecords.fetch_add(1, std::memory_order_relaxed);
+		m_Signal.fetch_add(1, std::memory_order_release);
+		m_Signal.notify_one();
+	}
+
+	void Logger::flush()
+	{
+		const uint64_t logged = m_LoggedRecords.load(std::memory_order_relaxed);
+		uint64_t written = m_WrittenRecords.load(std::memory_order_acquire);
+		while (written < logged)
+		{
+			m_WrittenRecords.wait(written, std::memory_order_acquire);
+			written = m_WrittenRecords.load(std::memory_order_acquire);
+		}
+	}
+
+	void Logger::run()
+	{
+		Record record;
+		std::vector<Line> lines;
+		while (true)
+		{
+			uint32_t signal = m_Signal.load(std::memory_order_acquire);
+
+			uint64_t count = 0;
+			while (m_Ring.tryPop(record))
+			{
+				write(record);
+				lines.push_back({ record.Level, m_Buffer });
+				count++;
+			}
+
+			if (count == 0)
+			{
+				if (m_Stop.load(std::memory_order_acquire))
+					break;
+
+				m_Signal.wait(signal, std::memory_order_acquire);
+				continue;
+			}
+
+			std::cout.flush();
+			if (m_File.is_open())
+				m_File.flush();
+
+			{
+				std::lock_guard<std::mutex> lock(m_HistoryMutex);
+				for (auto &line : lines)
+					m_History.push_back(std::move(line));
+				while (m_History.size() > MaxHistory)
+					m_History.pop_front();
+			}
+			lines.clear();
+
+			m_WrittenRecords.fetch_add(count, std::memory_order_release);
+			m_WrittenRecords.notify_all();
+		}
+	}
+
+	void Logger::write(const Record &record)
+	{
+		std::time_t time = std::chrono::system_clock::to_time_t(record.Timestamp);
+		std::tm local;
+#ifdef _WIN32
+		localtime_s(&local, &time);
+#else
+		localtime_r(&time, &local);
+#endif
+		auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(record.Timestamp.time_since_epoch()).count() % 1000;
+
+		char prefix[64];
+		size_t length = std::strftime(prefix, sizeof(prefix), "%F %T", &local);
+		snprintf(prefix + length, sizeof(prefix) - length, ".%03d [%s] [T%u] ", (int)milliseconds, LevelNames[(int)record.Level], record.ThreadId);
+
+		m_Buffer = prefix;
+		m_Buffer += record.Message;
+
+		std::cout << m_Buffer << '\n';
+		if (m_File.is_open())
+			m_File << m_Buffer << '\n';
+	}
+
+	void Logger::showLog()
+	{
+		ImGui::Begin("Log");
+
+		ImGui::Checkbox("Info", &m_ShowLevel[(int)LogLevel::INFO]);
+		ImGui::SameLine(); ImGui::Checkbox("Warnings", &m_ShowLevel[(int)LogLevel::WARNING]);
+		ImGui::SameLine(); ImGui::Checkbox("Errors", &m_ShowLevel[(int)LogLevel::ERR]);
+		ImGui::SameLine(); ImGui::Checkbox("Auto-scroll", &m_AutoScroll);
+		ImGui::SameLine();
+		bool clear = ImGui::Button("Clear");
+
+		uint64_t dropped = getDroppedRecords();
+		if (dropped > 0)
+		{
+			ImGui::SameLine();
+			ImGui::TextColored({ 1.0f, 0.3f, 0.3f, 1.0f }, "%llu dropped", (unsigned long long)dropped);
+		}
+		ImGui::Separator();
+
+		ImGui::BeginChild("Lines", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
+		{
+			std::lock_guard<std::mutex> lock(m_HistoryMutex);
+			if (clear)
+				m_History.clear();
+
+			// Only the visible rows are laid out, the filter is the only pass over the whole history
+			bool showAll = m_ShowLevel[0] && m_ShowLevel[1] && m_ShowLevel[2];
+			m_Shown.clear();
+			if (!showAll)
+			{
+				for (uint32_t i = 0; i < m_History.size(); i++)
+				{
+					if (m_ShowLevel[(int)m_History[i].Level])
+						m_Shown.push_back(i);
+				}
+			}
+
+			ImGuiListClipper clipper;
+			clipper.Begin(showAll ? (int)m_History.size() : (int)m_Shown.size());
+			while (clipper.Step())
+			{
+				for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+				{
+					const Line &line = m_History[showAll ? row : m_Shown[row]];
+					if (line.Level == LogLevel::ERR)
+						ImGui::PushStyleColor(ImGuiCol_Text, { 1.0f, 0.3f, 0.3f, 1.0f });
+					else if (line.Level == LogLevel::WARNING)
+						ImGui::PushStyleColor(ImGuiCol_Text, { 1.0f, 0.8f, 0.3f, 1.0f });
+
+					ImGui::TextUnformatted(line.Text.data(), line.Text.data() + line.Text.size());
+
+					if (line.Level != LogLevel::INFO)
+						ImGui::PopStyleColor();
+				}
+			}
+		}
+
+		if (m_AutoScroll && ImGui::GetScrollY() >= ImGui::GetScrollMaxY())
+			ImGui::SetScrollHereY(1.0f);
+
+		ImGui::EndChild();
+		ImGui::End();
+	}
+}
@@ -1,8 +1,14 @@
 #pragma once
 #include <string>
 #include <chrono>
-#include <imgui.h>
-#include <iostream>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <filesystem>
+
+#include <utilities/MpscRing.h>
 
 namespace Logger {
 	enum class LogLevel
@@ -12,45 +18,76 @@ namespace Logger {
 		ERR
 	};
 
+	/// <summary>
+	/// log can be called from any thread and never waits: the record (level, time, thread, message) is moved into a
+	/// lock free ring and a sink thread formats it, writes it to the console and the log file and keeps the last
+	/// MaxHistory lines for the log window. Records that do not fit into a full ring are counted and dropped.
+	/// </summary>
 	class Logger {
 	public:
-		#pragma warning(disable : 4996)
-		void log(std::string msg, LogLevel level = LogLevel::INFO) {
-			std::string entry = "";
-			auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-			entry += ctime(&now);
-			entry.at(entry.size() - 1) = ' ';
-			entry += "- ";
-
-			if (level == LogLevel::INFO) {
-				entry += "[INFO] ";
-			}
-			else if (level == LogLevel::WARNING) {
-				entry += "[WARN] ";
-			}
-			else if (level == LogLevel::ERR) {
-				entry += "[ERROR] ";
-			}
-
-			entry += msg;
-			entry += "\n";
-
-			std::cout << entry;
-
-			m_Log = entry + m_Log;
-
-			if (m_Log.size() > m_MaxLogLength) {
-				m_Log.resize(9000);
-			}
-		}
-
-		void showLog() {
-			ImGui::Begin("Log");
-			ImGui::Text(m_Log.c_str());
-			ImGui::End();
-		}
+		struct Record
+		{
+			LogLevel Level{ LogLevel::INFO };
+			std::chrono::system_clock::time_point Timestamp;
+
+			/// <summary>
+			/// Small number given to every thread on its first message, the main thread usually is 1
+			/// </summary>
+			uint32_t ThreadId{ 0 };
+
+			std::string Message;
+		};
+
+		static const size_t RingCapacity = 4096;
+		static const size_t MaxHistory = 10000;
+
+		/// <param name="logFile">Every line is also appended to this file, empty for none</param>
+		Logger(const std::filesystem::path &logFile = {});
+		~Logger();
+
+		Logger(const Logger &) = delete;
+		Logger &operator=(const Logger &) = delete;
+
+		void log(std::string msg, LogLevel level = LogLevel::INFO);
+
+		/// <summary>
+		/// Waits until the sink has written every record logged before the call
+		/// </summary>
+		void flush();
+
+		uint64_t getDroppedRecords() const { return m_DroppedRecords.load(std::memory_order_relaxed); }
+
+		void showLog();
 	private:
-		std::string m_Log{ "" };
-		const int m_MaxLogLength{ 10000 };
+		struct Line
+		{
+			LogLevel Level;
+			std::string Text;
+		};
+
+		void run();
+		void write(const Record &record);
+
+		MpscRing<Record> m_Ring{ RingCapacity };
+		std::atomic<uint64_t> m_DroppedRecords{ 0 };
+		std::atomic<uint64_t> m_LoggedRecords{ 0 };
+		std::atomic<uint64_t> m_WrittenRecords{ 0 };
+
+		std::atomic<uint32_t> m_Signal{ 0 };
+		std::atomic<bool> m_Stop{ false };
+		std::thread m_Thread;
+
+		// Only used by the sink
+		std::ofstream m_File;
+		std::string m_Buffer;
+
+		// Shared by the sink and the log window
+		std::mutex m_HistoryMutex;
+		std::deque<Line> m_History;
+
+		// Only used by the log window
+		bool m_ShowLevel[3]{ true, true, true };
+		bool m_AutoScroll{ true };
+		std::vector<uint32_t> m_Shown;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,189 @@
+#include "Octree.h"
+
+#include <algorithm>
+#include <execution>
+
+void Octree::build(const Point *points, int count, const BoundingBox &boundingBox)
+{
+	mp_Points = points;
+	m_Nodes.clear();
+	m_Leaves.clear();
+	m_SortedPoints.clear();
+
+	// Cubic root so every level halves all axes the same
+	auto min = boundingBox.getMinPoint();
+	auto extent = boundingBox.getMaxPoint() - min;
+	float size = std::max({ extent.x, extent.y, extent.z, 1e-3f });
+	const float maxCell = (float)((1 << MaxLevel) - 1);
+	float scale = maxCell / size;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (points[i].Depth <= 0.0f)
+			continue;
+
+		// Outliers outside the box would pile up in the border cells
+		auto cell = (points[i].getPoint() - min) * scale;
+		if (glm::any(glm::lessThan(cell, glm::vec3(0.0f))) || glm::any(glm::greaterThan(cell, glm::vec3(maxCell))))
+			continue;
+
+		uint64_t code = (spreadBits((uint64_t)cell.x) << 2) | (spreadBits((uint64_t)cell.y) << 1) | spreadBits((uint64_t)cell.z);
+		m_SortedPoints.emplace_back(code, i);
+	}
+
+	if (m_SortedPoints.empty())
+		return;
+
+	std::sort(std::execution::par, m_SortedPoints.begin(), m_SortedPoints.end());
+
+	m_Nodes.push_back({ 0, 0, 0, (unsigned int)m_SortedPoints.size() });
+	subdivide(0);
+	mergeSparseLeaves();
+}
+
+void Octree::subdivide(int nodeIndex)
+{
+	// Copy, the pool may grow below
+	Node node = m_Nodes[nodeIndex];
+
+	if (node.Level >= std::min(m_MaxDepth, MaxLevel) || !shouldSplit(node))
+	{
+		m_Leaves.push_back(nodeIndex);
+		return;
+	}
+
+	const int shift = 3 * (MaxLevel - node.Level - 1);
+	auto begin = m_SortedPoints.begin() + node.First;
+	auto end = begin + node.Count;
+
+	std::vector<Node> children;
+	bool hasDenseChild = false;
+
+	// Points are sorted, so each octant is a contiguous run
+	for (uint64_t octant = 0; octant < 8 && begin != end; octant++)
+	{
+		auto childEnd = std::partition_point(begin, end, [&](const auto &p) { return ((p.first >> shift) & 7) <= octant; });
+
+		if (childEnd != begin)
+		{
+			unsigned int first = (unsigned int)(begin - m_SortedPoints.begin());
+			unsigned int count = (unsigned int)(childEnd - begin);
+			children.push_back({ node.Code | (octant << shift), node.Level + 1, first, count });
+			hasDenseChild |= count >= (unsigned int)m_MinPoints;
+		}
+
+		begin = childEnd;
+	}
+
+	// Merge: not worth splitting into nothing but sparse cells
+	if (!hasDenseChild)
+	{
+		m_Leaves.push_back(nodeIndex);
+		return;
+	}
+
+	int firstChild = (int)m_Nodes.size();
+	m_Nodes[nodeIndex].FirstChild = firstChild;
+	m_Nodes[nodeIndex].ChildCount = (int)children.size();
+	m_Nodes.insert(m_Nodes.end(), children.begin(), children.end());
+
+	for (int c = 0; c < (int)children.size(); c++)
+		subdivide(firstChild + c);
+}
+
+void Octree::mergeSparseLeaves()
+{
+	// Leaves in Morton order own consecutive ranges of the sorted points, a sparse leaf joins its neighbour by extending its range
+	std::vector<int> leaves;
+	unsigned int leading = 0;
+
+	for (int leaf : m_Leaves)
+	{
+		auto &node = m_Nodes[leaf];
+		if (node.Count >= (unsigned int)m_MinPoints)
+		{
+			// Sparse leaves before the first dense one join it
+			node.First -= leading;
+			node.Count += leading;
+			leading = 0;
+			leaves.push_back(leaf);
+			continue;
+		}
+
+		if (leaves.empty())
+			leading += node.Count;
+		else
+			m_Nodes[leaves.back()].Count += node.Count;
+		node.Count = 0;
+	}
+
+	// Nothing dense at all, one leaf holds everything
+	if (leaves.empty())
+	{
+		m_Nodes[m_Leaves.front()].Count = leading;
+		leaves.push_back(m_Leaves.front());
+	}
+
+	m_Leaves = std::move(leaves);
+}
+
+bool Octree::shouldSplit(const Node &node) const
+{
+	if (node.Count > (unsigned int)m_MaxPoints)
+		return true;
+
+	if (node.Count < 2u * m_MinPoints)
+		return false;
+
+	glm::vec3 normalSum{ 0.0f };
+	int normalCount = 0;
+
+	for (unsigned int i = node.First; i < node.First + node.Count; i++)
+	{
+		auto normal = mp_Points[getPointIndex(i)].getNormal();
+		if (normal != glm::vec3(0.0f))
+		{
+			normalSum += normal;
+			normalCount++;
+		}
+	}
+
+	if (normalCount == 0)
+		return false;
+
+	return 1.0f - glm::length(normalSum) / (float)normalCount > m_NormalSpreadThreshold;
+}
+
+glm::vec3 Octree::getIndex(const Node &node) const
+{
+	uint64_t code = node.Code >> (3 * (MaxLevel - node.Level));
+	return { (float)compactBits(code >> 2), (float)compactBits(code >> 1), (float)compactBits(code) };
+}
+
+/// <summary>
+/// Inserts two zero bits between each of the lower 21 bits
+/// </summary>
+uint64_t Octree::spreadBits(uint64_t v)
+{
+	v &= 0x1fffff;
+	v = (v | v << 32) & 0x1f00000000ffff;
+	v = (v | v << 16) & 0x1f0000ff0000ff;
+	v = (v | v << 8) & 0x100f00f00f00f00f;
+	v = (v | v << 4) & 0x10c30c30c30c30c3;
+	v = (v | v << 2) & 0x1249249249249249;
+	return v;
+}
+
+/// <summary>
+/// Inverse of spreadBits
+/// </summary>
+uint64_t Octree::compactBits(uint64_t v)
+{
+	v &= 0x1249249249249249;
+	v = (v ^ (v >> 2)) & 0x10c30c30c30c30c3;
+	v = (v ^ (v >> 4)) & 0x100f00f00f00f00f;
+	v = (v ^ (v >> 8)) & 0x1f0000ff0000ff;
+	v = (v ^ (v >> 16)) & 0x1f00000000ffff;
+	v = (v ^ (v >> 32)) & 0x1fffff;
+	return v;
+}
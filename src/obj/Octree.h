@@ -0,0 +1,86 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "Point.h"
+#include "BoundingBox.h"
+
+/// <summary>
+/// Adaptive subdivision of the point cloud for NDT cells.
+/// Points are sorted by their Morton code, so every node owns a contiguous range of the sorted points.
+/// A node splits when it holds too many points or its normals disagree, a split that would only produce
+/// sparse children is undone. Sparse leaves next to dense ones are merged into their neighbour in Morton order,
+/// so every leaf has at least MinPoints points. Nodes live in one pool that is reused between builds.
+/// </summary>
+class Octree
+{
+public:
+	struct Node
+	{
+		/// <summary>
+		/// Morton code of the node, only the upper 3 * Level bits are set
+		/// </summary>
+		uint64_t Code;
+		int Level;
+
+		/// <summary>
+		/// Range in the sorted point indices
+		/// </summary>
+		unsigned int First;
+		unsigned int Count;
+
+		int FirstChild{ -1 };
+		int ChildCount{ 0 };
+	};
+
+	/// <summary>
+	/// Builds the tree over all points with depth inside the box, the others are in no leaf
+	/// </summary>
+	void build(const Point *points, int count, const BoundingBox &boundingBox);
+
+	const std::vector<Node> &getNodes() const { return m_Nodes; }
+
+	/// <returns>Indices of the leaf nodes in Morton order, a leaf may hold the points of merged neighbours</returns>
+	const std::vector<int> &getLeaves() const { return m_Leaves; }
+
+	/// <returns>Point index of the i-th point in Morton order</returns>
+	inline unsigned int getPointIndex(unsigned int i) const { return m_SortedPoints[i].second; }
+
+	/// <returns>Integer coordinates of the node at its level</returns>
+	glm::vec3 getIndex(const Node &node) const;
+
+	static inline std::string getKey(const Node &node)
+	{
+		return std::to_string(node.Level) + ":" + std::to_string(node.Code);
+	}
+
+	int m_MaxDepth{ 10 };
+	int m_MaxPoints{ 512 };
+	int m_MinPoints{ 16 };
+
+	/// <summary>
+	/// 1 - length of the mean normal, 0 for a perfect plane
+	/// </summary>
+	float m_NormalSpreadThreshold{ 0.05f };
+
+	static const int MaxLevel = 21;
+private:
+	void subdivide(int nodeIndex);
+	bool shouldSplit(const Node &node) const;
+	void mergeSparseLeaves();
+
+	static uint64_t spreadBits(uint64_t v);
+	static uint64_t compactBits(uint64_t v);
+
+	const Point *mp_Points{ nullptr };
+
+	std::vector<Node> m_Nodes;
+	std::vector<int> m_Leaves;
+
+	/// <summary>
+	/// (Morton code, point index) sorted by code
+	/// </summary>
+	std::vector<std::pair<uint64_t, unsigned int>> m_SortedPoints;
+};
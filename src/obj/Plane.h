@@ -11,15 +11,31 @@ public:
 		normal = glm::normalize(glm::cross((p2 - p1), (p3 - p1)));
 	}
 
+	/// <returns>Distance along the normal, positive on the side the normal points to</returns>
+	float getSignedDistance(glm::vec3 p) const
+	{
+		return glm::dot(p - point, normal);
+	}
+
 	float getDistance(glm::vec3 p) const
 	{
-		return abs(glm::dot(p, normal) + glm::dot(point, normal));
+		return glm::abs(getSignedDistance(p));
 	}
 
 	bool inDistance(glm::vec3 p, float threshold = 0.0f) const
 	{
 		return getDistance(p) <= threshold;
 	}
+
+	glm::vec3 getPoint() const
+	{
+		return point;
+	}
+
+	glm::vec3 getNormal() const
+	{
+		return normal;
+	}
 private:
 	glm::vec3 point;
 	glm::vec3 normal;
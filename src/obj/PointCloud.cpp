@@ -1,16 +1,30 @@
 #include "PointCloud.h"
 
 #include <GLCore/GLErrorManager.h>
+#include <GLCore/Profiler.h>
+#include <GLCore/GLMemory.h>
 #include <imgui.h>
+#include <utilities/helper/ImGuiHelper.h>
 
 #include <ranges>
+#include <algorithm>
+#include <numeric>
+#include <execution>
+#include <cmath>
+#include <format>
+
+#include <filters/SpatialFilter.h>
+#include <filters/TemporalFilter.h>
+#include <filters/HoleFillingFilter.h>
+#include <skeleton/GeodesicSkeletonDetector.h>
 
 #define PixIter for(int i = 0; i < m_NumElements; i++)
+#define ActiveIter for(int i : m_ActivePoints)
 #define UpdateVertices(i) memcpy(m_Vertices + i * Point::VertexCount, &m_Points[i].Vertices[0], Point::VertexCount * sizeof(Point::Vertex));
 
 namespace GLObject
 {
-    PointCloud::PointCloud(DepthCamera *depthCamera, const Camera *cam, Renderer *renderer, float metersPerUnit) : mp_DepthCamera(depthCamera), m_MetersPerUnit(metersPerUnit)
+    PointCloud::PointCloud(DepthCamera *depthCamera, const Camera *cam, Renderer *renderer, float metersPerUnit) : mp_DepthCamera(depthCamera), m_MetersPerUnit(metersPerUnit), m_BackgroundModel(metersPerUnit)
     {
         this->camera = cam;
         GLCall(glEnable(GL_BLEND));
@@ -52,6 +66,9 @@ namespace GLObject
         }
 
         m_GLUtil.mp_Renderer = renderer;
+        m_GLUtil.m_PassName = "Point Cloud " + mp_DepthCamera->getCameraName();
+
+        GLMemory::OwnerScope memoryOwner(this, m_GLUtil.m_PassName);
         m_GLUtil.m_VAO = std::make_unique<VertexArray>();
 
         m_GLUtil.m_VB = std::make_unique<VertexBuffer>(m_NumElements * Point::VertexCount * sizeof(Point::Vertex));
@@ -64,13 +81,26 @@ namespace GLObject
 
         m_GLUtil.m_IndexBuffer = std::make_unique<IndexBuffer>(indices, numIndex);
 
-        m_GLUtil.m_Shader = std::make_unique<Shader>("resources/shaders/pointcloud.shader");
+        // Shared by the point clouds of all cameras
+        m_GLUtil.m_Shader = renderer->GetShaderManager().Load("resources/shaders/pointcloud.shader");
+        m_GLUtil.m_ScaleUniform = m_GLUtil.m_Shader->GetUniform("u_Scale");
+        m_GLUtil.m_MVPUniform = m_GLUtil.m_Shader->GetUniform("u_MVP");
         m_GLUtil.m_Shader->Bind();
 
         m_Vertices = new Point::Vertex[m_NumElements * Point::VertexCount] {};
 
         m_PointDistribution = std::make_unique<std::uniform_int_distribution<int>>(0, m_NumElements - 1);
         m_ColorDistribution = std::make_unique<std::uniform_int_distribution<int>>(0, 255);
+
+        m_Depth.resize(m_NumElements);
+        m_DepthFilters.push_back(std::make_unique<SpatialFilter>(m_MetersPerUnit));
+        m_DepthFilters.push_back(std::make_unique<TemporalFilter>(m_MetersPerUnit));
+        m_DepthFilters.push_back(std::make_unique<HoleFillingFilter>(m_MetersPerUnit));
+
+        m_ActivePoints.resize(m_NumElements);
+        std::iota(m_ActivePoints.begin(), m_ActivePoints.end(), 0);
+
+        m_SkeletonWorker = std::make_unique<SkeletonWorker>(std::make_unique<GeodesicSkeletonDetector>());
     }
 
     void PointCloud::OnUpdate()
@@ -79,19 +109,65 @@ namespace GLObject
 
         if (m_State.m_State == m_State.STREAM)
         {
-            depth = static_cast<const int16_t *>(mp_DepthCamera->getDepth());
+            {
+                PROFILE_SCOPE("Get Depth");
+                depth = static_cast<const int16_t *>(mp_DepthCamera->getDepth());
+            }
             if (depth != nullptr) {
-                PixIter { 
-                    streamDepth(i, depth);
-                    UpdateVertices(i)
+                updateFrameInfo();
+                recordFrame(depth);
+
+                {
+                    PROFILE_SCOPE("Filter Depth");
+                    depth = filterDepth(depth);
+                    depth = removeBackground(depth);
+                }
+
+                m_BoundingBox.beginFrame();
+                {
+                    PROFILE_SCOPE("Stream Depth");
+                    PixIter { 
+                        streamDepth(i, depth);
+                        UpdateVertices(i)
+                    }
+                }
+
+                if (m_BoundingBox.endFrame())
+                    m_CellSize = Cell::getCellSize(m_BoundingBox, m_NumCellDevisions);
+
+                // Skeleton detection runs on the largest cluster
+                if (m_Clustering.m_IsEnabled || m_DetectSkeleton)
+                {
+                    PROFILE_SCOPE("Clustering");
+                    clusterPoints();
+                }
+
+                if (m_DetectSkeleton)
+                {
+                    PROFILE_SCOPE("Submit Skeleton");
+                    detectSkeleton();
+                }
+
+                if (m_SkeletonWriter.isOpen())
+                    recordSkeleton();
+
+                if (m_ExportRemaining > 0)
+                {
+                    PROFILE_SCOPE("Export");
+                    exportFrame(true);
+                    m_ExportRemaining--;
                 }
+
+                // The background model assumes a static camera, the floor found while it was learning stays valid
+                if (m_FloorDetector.m_IsEnabled && !(m_BackgroundModel.m_IsEnabled && m_BackgroundModel.isLearned()))
+                    trackFloor();
             }
             
         }
         else if (m_State.m_State == m_State.NORMALS)
         {
             startNormalCalculation();
-            PixIter {
+            ActiveIter {
                 calculateNormals(i);
                 UpdateVertices(i)
             }
@@ -99,7 +175,7 @@ namespace GLObject
         else if (m_State.m_State == m_State.CELLS)
         {
             startCellAssignment();
-            PixIter 
+            ActiveIter 
             { 
                 assignCells(i);
                 UpdateVertices(i)
@@ -108,13 +184,15 @@ namespace GLObject
         else if (m_State.m_State == m_State.CALC_CELLS)
         {
             startCellCalculation();
-            PixIter
+            ActiveIter
             { 
                 calculateCells(i);
                 UpdateVertices(i)
             }
         }
         
+        PROFILE_SCOPE("Upload Vertices");
+        PROFILE_GPU_SCOPE("Upload Vertices");
         m_GLUtil.m_IndexBuffer->Bind();
 
         GLCall(glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Point::Vertex) * m_NumElements * Point::VertexCount, m_Vertices));
@@ -122,6 +200,7 @@ namespace GLObject
 
     void PointCloud::OnRender()
     {
+        PROFILE_SCOPE("Render Point Cloud");
         glm::mat4 model{ 1.0f };
         model = glm::rotate(model, m_GLUtil.m_RotationFactor, m_GLUtil.m_Rotation);
         model = glm::translate(model, m_GLUtil.m_Translation);
@@ -129,10 +208,10 @@ namespace GLObject
         glm::mat4 mvp = camera->getViewProjection() * model;
 
         m_GLUtil.m_Shader->Bind();
-        m_GLUtil.m_Shader->SetUniform1f("u_Scale", m_GLUtil.m_Scale);
-        m_GLUtil.m_Shader->SetUniformMat4f("u_MVP", mvp);
+        m_GLUtil.m_Shader->SetUniform1f(m_GLUtil.m_ScaleUniform, m_GLUtil.m_Scale);
+        m_GLUtil.m_Shader->SetUniformMat4f(m_GLUtil.m_MVPUniform, mvp);
 
-        m_GLUtil.mp_Renderer->Draw(*m_GLUtil.m_VAO, *m_GLUtil.m_IndexBuffer, *m_GLUtil.m_Shader);
+        m_GLUtil.mp_Renderer->Draw(*m_GLUtil.m_VAO, *m_GLUtil.m_IndexBuffer, *m_GLUtil.m_Shader, m_GLUtil.m_PassName);
     }
 
     void PointCloud::OnImGuiRender()
@@ -157,15 +236,26 @@ namespace GLObject
         if (m_State == m_State.CELLS || m_State == m_State.CALC_CELLS)
         {
             ImGui::Checkbox("Show Average Normals", &m_ShowAverageNormals);
-            if (ImGui::SliderInt("Cell devisions", &m_NumCellDevisions, 0, 400))
+
+            bool cellsChanged = ImGui::Checkbox("Adaptive Cells (Octree)", &m_UseOctree);
+
+            if (m_UseOctree)
+            {
+                cellsChanged |= ImGui::SliderInt("Max Depth", &m_Octree.m_MaxDepth, 1, Octree::MaxLevel);
+                cellsChanged |= ImGui::SliderInt("Max Points per Cell", &m_Octree.m_MaxPoints, 8, 4096);
+                cellsChanged |= ImGui::SliderInt("Min Points per Cell", &m_Octree.m_MinPoints, 3, 256);
+                cellsChanged |= ImGui::SliderFloat("Normal Spread Threshold", &m_Octree.m_NormalSpreadThreshold, 0.001f, 0.5f);
+            }
+            else if (ImGui::SliderInt("Cell devisions", &m_NumCellDevisions, 1, 400))
             {
                 m_CellSize = Cell::getCellSize(m_BoundingBox, m_NumCellDevisions);
-                m_CellsAssigned = false;
-                m_ColorBypCell.clear();
-                m_pCellByKey.clear();
-                m_PlanarpCells.clear();
-                m_NonPlanarpCells.clear();
+                cellsChanged = true;
             }
+
+            if (cellsChanged)
+                clearCells();
+
+            ImGui::Text("%d Cells", (int)m_pCellByKey.size());
         }
 
         if (m_State == m_State.CALC_CELLS) {
@@ -183,22 +273,465 @@ namespace GLObject
                         m_NonPlanarpCells.push_back(cell);
                 }
             }
+
+            if (m_EigenBenchmarkTask.valid() && m_EigenBenchmarkTask.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+                m_EigenBenchmark = m_EigenBenchmarkTask.get();
+
+            ImGui::BeginDisabled(m_EigenBenchmarkTask.valid());
+            if (ImGui::Button(m_EigenBenchmarkTask.valid() ? "Benchmarking..." : "Benchmark Eigen Solver"))
+                m_EigenBenchmarkTask = std::async(std::launch::async, EigenSolver::benchmark, 100000);
+            ImGui::EndDisabled();
+            ImGui::SameLine(); ImGuiHelper::HelpMarker("Decomposes 100000 random covariances with the batched solver, the single closed form and the Jacobi reference in the background.");
+
+            if (m_EigenBenchmark.Count > 0)
+            {
+                ImGui::Text("Batch: %.2f ms, Closed Form: %.2f ms, Jacobi: %.2f ms", m_EigenBenchmark.BatchTime, m_EigenBenchmark.ClosedFormTime, m_EigenBenchmark.JacobiTime);
+                ImGui::Text("Max Error: Values %.2e, Vectors %.2e", m_EigenBenchmark.MaxValueError, m_EigenBenchmark.MaxVectorError);
+            }
+        }
+
+        if (ImGui::CollapsingHeader("Bounding Box"))
+        {
+            auto min = m_BoundingBox.getMinPoint();
+            auto max = m_BoundingBox.getMaxPoint();
+            ImGui::Text("Min: %.2f, %.2f, %.2f", min.x, min.y, min.z);
+            ImGui::Text("Max: %.2f, %.2f, %.2f", max.x, max.y, max.z);
+            ImGui::SliderFloat("Lower Percentile", &m_BoundingBox.m_LowerPercentile, 0.0f, 50.0f);
+            ImGui::SliderFloat("Upper Percentile", &m_BoundingBox.m_UpperPercentile, 50.0f, 100.0f);
+        }
+
+        if (ImGui::CollapsingHeader("Background"))
+            m_BackgroundModel.OnImGuiRender();
+
+        if (ImGui::CollapsingHeader("Clusters"))
+        {
+            m_Clustering.OnImGuiRender();
+            ImGui::Checkbox("Color Clusters", &m_ShowClusters);
+        }
+
+        if (ImGui::CollapsingHeader("Skeleton"))
+        {
+            if (ImGui::Checkbox("Detect Skeleton", &m_DetectSkeleton))
+            {
+                // The detection thread only lives while it has something to do
+                if (m_DetectSkeleton)
+                    m_SkeletonWorker->start();
+                else
+                    m_SkeletonWorker->stop();
+            }
+            ImGui::SameLine(); ImGuiHelper::HelpMarker("Runs on the largest cluster, remove the background for best results.");
+            ImGui::Checkbox("Show Joints", &m_ShowSkeleton);
+            m_SkeletonWorker->OnImGuiRender();
+        }
+
+        if (ImGui::CollapsingHeader("Export"))
+            showExport();
+
+        if (m_DepthWriter.isOpen() && ImGui::CollapsingHeader("Depth Recording"))
+        {
+            auto stats = m_DepthWriter.getStats();
+            ImGui::Text("Frames: %u, Dropped: %u, Queued: %u / %u (max %u)", stats.Frames, stats.DroppedFrames,
+                stats.QueuedFrames, stats.QueueCapacity, stats.MaxQueuedFrames);
+            ImGui::Text("Size: %.1f MB (%.2fx smaller than raw), Encode: %.2f ms, Write: %.1f MB/s", stats.EncodedBytes / 1e6,
+                stats.EncodedBytes > 0 ? (double)stats.RawBytes / stats.EncodedBytes : 0.0, stats.EncodeTime, stats.WriteThroughput / 1e6);
+        }
+
+        if (m_SkeletonWriter.isOpen() && ImGui::CollapsingHeader("Skeleton Recording"))
+            ImGui::Text("Frames out of order: %u", m_SkeletonWriter.getDroppedCount());
+
+        if (ImGui::CollapsingHeader("Floor"))
+        {
+            m_FloorDetector.OnImGuiRender();
+
+            if (ImGui::Button("Detect Floor"))
+            {
+                updateGravity();
+                m_FloorDetector.detect(m_Points, m_NumElements, m_PlanarpCells);
+            }
+            ImGui::SameLine(); ImGuiHelper::HelpMarker("Uses the planar cells if they are calculated, otherwise a sample of the frame.");
+        }
+
+        if (ImGui::CollapsingHeader("Depth Filters"))
+        {
+            for (auto &filter : m_DepthFilters)
+                filter->OnImGuiRender();
+
+            if (m_FilterBenchmark.valid() && m_FilterBenchmark.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            {
+                auto times = m_FilterBenchmark.get();
+                for (size_t f = 0; f < times.size() && f < m_DepthFilters.size(); f++)
+                    m_DepthFilters[f]->setBenchmarkTime(times[f]);
+            }
+
+            ImGui::BeginDisabled(m_FilterBenchmark.valid());
+            if (ImGui::Button(m_FilterBenchmark.valid() ? "Benchmarking..." : "Benchmark Filters"))
+                benchmarkFilters();
+            ImGui::EndDisabled();
+            ImGui::SameLine(); ImGuiHelper::HelpMarker("Runs a copy of every filter 100 times on the current frame in the background.");
         }
 
         m_GLUtil.manipulateTranslation();
     }
 
-    void PointCloud::streamDepth(int i, const int16_t *depth)
+    const int16_t *PointCloud::removeBackground(const int16_t *depth)
+    {
+        bool isSegmented = false;
+
+        if (m_BackgroundModel.m_IsEnabled)
+        {
+            if (depth != m_Depth.data())
+                memcpy(m_Depth.data(), depth, m_NumElements * sizeof(int16_t));
+
+            m_BackgroundModel.run(m_Depth.data(), m_StreamWidth, m_StreamHeight);
+            isSegmented = m_BackgroundModel.isSegmented();
+            depth = m_Depth.data();
+        }
+
+        if (isSegmented)
+        {
+            // Points are stored rotated by 180 degrees (see streamDepth)
+            auto &foreground = m_BackgroundModel.getForeground();
+            m_ActivePoints.resize(foreground.size());
+            std::transform(foreground.rbegin(), foreground.rend(), m_ActivePoints.begin(),
+                [this](int pixel) { return m_NumElements - 1 - pixel; });
+        }
+        else if (m_ActivePoints.size() != m_NumElements)
+        {
+            m_ActivePoints.resize(m_NumElements);
+            std::iota(m_ActivePoints.begin(), m_ActivePoints.end(), 0);
+        }
+
+        return depth;
+    }
+
+    void PointCloud::clusterPoints()
+    {
+        m_Clustering.cluster(m_Points, m_StreamWidth, m_StreamHeight, m_ActivePoints);
+
+        if (!m_ShowClusters)
+            return;
+
+        auto &clusters = m_Clustering.getClusters();
+        for (int c = 0; c < clusters.size(); c++)
+        {
+            // Golden ratio hues keep neighbouring cluster indices apart
+            float r, g, b;
+            ImGui::ColorConvertHSVtoRGB(std::fmod(c * 0.618034f, 1.0f), 0.8f, 0.9f, r, g, b);
+
+            for (int i : clusters[c].Indices)
+            {
+                for (int v : std::views::iota(0, Point::VertexCount))
+                    m_Points[i].Vertices[v].Color = { r, g, b, 1.0f };
+                UpdateVertices(i)
+            }
+        }
+    }
+
+    void PointCloud::detectSkeleton()
+    {
+        auto &clusters = m_Clustering.getClusters();
+        if (clusters.empty())
+            return;
+
+        auto &person = clusters.front();
+
+        SkeletonInput input;
+        input.Width = m_StreamWidth;
+        input.Height = m_StreamHeight;
+        input.GridIndices = person.Indices;
+        input.Points.resize(person.Indices.size());
+        std::transform(person.Indices.begin(), person.Indices.end(), input.Points.begin(),
+            [this](int i) { return m_Points[i].getPoint(); });
+
+        if (m_FloorDetector.hasFloor())
+            input.Up = m_FloorDetector.getFloor().getNormal();
+
+        // Keyed by the device so recorded skeletons find their frame
+        input.Timestamp = m_DeviceTimestamp;
+        input.FrameIndex = (unsigned int)m_DeviceFrame;
+        m_SkeletonWorker->submit(std::move(input));
+
+        // The newest skeleton may be a few frames old
+        Skeleton skeleton;
+        if (!m_ShowSkeleton || !m_SkeletonWorker->getSkeleton(skeleton))
+            return;
+
+        const float jointRadius = 0.05f;
+        const float faultThreshold = m_SkeletonWorker->getFaultThreshold();
+        for (int i : person.Indices)
+        {
+            auto p = m_Points[i].getPoint();
+            for (int j = 0; j < Skeleton::JointCount; j++)
+            {
+                auto d = skeleton.Joints[j] - p;
+                if (skeleton.Confidence[j] <= 0.0f || glm::dot(d, d) > jointRadius * jointRadius)
+                    continue;
+
+                // Red for confident joints, fading to grey, blue if the fault estimator flags the joint
+                float c = skeleton.Confidence[j];
+                std::array<float, 4> color{ 0.5f + 0.5f * c, 0.5f - 0.5f * c, 0.5f - 0.5f * c, 1.0f };
+                if (skeleton.Fault[j] > faultThreshold)
+                    color = { 0.2f, 0.4f, 1.0f, 1.0f };
+
+                for (int v : std::views::iota(0, Point::VertexCount))
+                    m_Points[i].Vertices[v].Color = color;
+                UpdateVertices(i)
+                break;
+            }
+        }
+    }
+
+    bool PointCloud::startSkeletonRecording(const std::filesystem::path &path)
+    {
+        m_HasFirstRecordedFrame = false;
+        m_RecordedFrames = 0;
+        m_RecordedDetections = m_SkeletonWorker->getDetectionCount();
+        return m_SkeletonWriter.open(path);
+    }
+
+    void PointCloud::stopSkeletonRecording()
+    {
+        m_SkeletonWriter.close();
+    }
+
+    bool PointCloud::startDepthRecording(const std::filesystem::path &path)
+    {
+        DepthRecording::StreamInfo info{ (uint32_t)m_StreamWidth, (uint32_t)m_StreamHeight, m_MetersPerUnit,
+            mp_DepthCamera->getIntrinsics(INTRINSICS::FX), mp_DepthCamera->getIntrinsics(INTRINSICS::FY),
+            mp_DepthCamera->getIntrinsics(INTRINSICS::CX), mp_DepthCamera->getIntrinsics(INTRINSICS::CY) };
+
+        m_HasFirstRecordedFrame = false;
+        m_RecordedFrames = 0;
+        return m_DepthWriter.open(path, info, 0.0);
+    }
+
+    void PointCloud::stopDepthRecording()
+    {
+        m_DepthWriter.close();
+    }
+
+    void PointCloud::recordDepth(const void *depth)
+    {
+        updateFrameInfo();
+        recordFrame(depth);
+    }
+
+    void PointCloud::updateFrameInfo()
+    {
+        // Cameras without frame numbers count the frames they deliver
+        if (!mp_DepthCamera->getFrameInfo(m_DeviceFrame, m_DeviceTimestamp))
+        {
+            m_DeviceFrame++;
+            m_DeviceTimestamp = getTimestamp();
+        }
+    }
+
+    bool PointCloud::toRecordedFrame(uint64_t deviceFrame, double deviceTimestamp, uint32_t &frameIndex, double &timestamp) const
+    {
+        // Frames from before the recording, a skeleton may still be detected in one
+        if (!m_HasFirstRecordedFrame || deviceFrame < m_FirstRecordedFrame)
+            return false;
+
+        frameIndex = (uint32_t)(deviceFrame - m_FirstRecordedFrame);
+        timestamp = deviceTimestamp - m_FirstRecordedTimestamp;
+        return true;
+    }
+
+    void PointCloud::recordFrame(const void *depth)
     {
-        int depth_i = m_StreamWidth * (m_StreamHeight + 1) - i;
+        if (!m_DepthWriter.isOpen() && !m_SkeletonWriter.isOpen())
+            return;
 
-        if (m_BoundingBox.updateBox(m_Points[i].getPoint()))
+        // The recordings count frames and time from their first frame, like the readers of the vendor recordings
+        if (!m_HasFirstRecordedFrame)
         {
-            m_CellSize = Cell::getCellSize(m_BoundingBox, m_NumCellDevisions);
+            m_FirstRecordedFrame = m_DeviceFrame;
+            m_FirstRecordedTimestamp = m_DeviceTimestamp;
+            m_HasFirstRecordedFrame = true;
         }
 
+        uint32_t frameIndex;
+        double timestamp;
+        if (!toRecordedFrame(m_DeviceFrame, m_DeviceTimestamp, frameIndex, timestamp))
+            return;
+
+        m_RecordedFrames++;
+
+        if (m_DepthWriter.isOpen())
+            m_DepthWriter.push(static_cast<const uint16_t *>(depth), frameIndex, timestamp);
+
+        // Without streaming the floor is the one found before the recording started
+        if (m_SkeletonWriter.isOpen())
+            m_SkeletonWriter.append(frameIndex, timestamp, m_FloorDetector.hasFloor() ? &m_FloorDetector.getFloor() : nullptr);
+    }
+
+    void PointCloud::recordSkeleton()
+    {
+        // Skeletons arrive a few frames late, they are filled into the record of the frame they were detected in
+        Skeleton skeleton;
+        auto detections = m_SkeletonWorker->getDetectionCount();
+        if (detections == m_RecordedDetections || !m_SkeletonWorker->getSkeleton(skeleton))
+            return;
+
+        m_RecordedDetections = detections;
+
+        uint32_t frameIndex;
+        double timestamp;
+        if (toRecordedFrame(skeleton.FrameIndex, skeleton.Timestamp, frameIndex, timestamp))
+            m_SkeletonWriter.setSkeleton(frameIndex, skeleton);
+    }
+
+    void PointCloud::exportFrame(bool isSequence)
+    {
+        if (!m_Exporter)
+            m_Exporter = std::make_unique<PointCloudExporter>();
+
+        auto frame = m_Exporter->getFrame();
+        frame.resize(m_NumElements);
+        frame.CameraId = (uint16_t)mp_DepthCamera->getCameraId();
+        frame.CameraName = mp_DepthCamera->getCameraName();
+        frame.FrameIndex = (uint32_t)m_DeviceFrame;
+        frame.HasNormals = m_NormalsCalculated;
+
+        // Cells are only valid until the stream resumes
+        const bool hasCells = m_CellsAssigned && m_pCellByPoint.size() == m_NumElements;
+
+        size_t count = 0;
+        for (int i = 0; i < m_NumElements; i++)
+        {
+            if (m_Points[i].Depth <= 0.0f)
+                continue;
+
+            auto point = m_Points[i].getPoint();
+            auto normal = m_Points[i].getNormal();
+            frame.X[count] = point.x;
+            frame.Y[count] = point.y;
+            frame.Z[count] = point.z;
+            frame.NormalX[count] = normal.x;
+            frame.NormalY[count] = normal.y;
+            frame.NormalZ[count] = normal.z;
+
+            auto cell = hasCells ? m_pCellByPoint[i] : nullptr;
+            frame.CellType[count] = (uint8_t)(cell ? cell->getType() : Cell::NDT_TYPE::None);
+            count++;
+        }
+        frame.resize(count);
+
+        // The frame number is kept in the file header, a paused stream exports the same frame more than once
+        char counter[16];
+        snprintf(counter, sizeof(counter), "_%05u", m_ExportCounter++);
+        auto fileName = m_ExportName + counter + PointCloudExporter::getExtension(m_ExportFormat);
+        // A sequence holds up the render thread and with it the playback until the writer catches up, no frame is missing
+        m_Exporter->submit(std::move(frame), std::filesystem::path(m_ExportDirectory) / fileName, m_ExportFormat, isSequence);
+    }
+
+    void PointCloud::showExport()
+    {
+        int format = (int)m_ExportFormat;
+        ImGui::RadioButton("PLY", &format, (int)PointCloudExporter::Format::Ply);
+        ImGui::SameLine();
+        ImGui::RadioButton("PCD", &format, (int)PointCloudExporter::Format::Pcd);
+        m_ExportFormat = (PointCloudExporter::Format)format;
+
+        ImGui::InputText("Directory", m_ExportDirectory, sizeof(m_ExportDirectory));
+        ImGui::InputInt("Next Frames", &m_ExportFrameCount);
+        m_ExportFrameCount = std::max(m_ExportFrameCount, 1);
+
+        bool exportCurrent = ImGui::Button("Export Frame");
+        ImGui::SameLine();
+        bool exportSequence = ImGui::Button("Export Next Frames");
+        ImGui::SameLine(); ImGuiHelper::HelpMarker("Exports the next streamed frames from now on, there is no start or end frame. "
+            "To export part of a recording, pause the playback and seek to its first frame, start the export and play in lockstep. "
+            "No frame is dropped, the rendering waits while the writer is behind.");
+
+        if (exportCurrent || exportSequence)
+        {
+            std::error_code error;
+            std::filesystem::create_directories(m_ExportDirectory, error);
+
+            auto start = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+            m_ExportName = mp_DepthCamera->getCameraName() + std::format("_{:%Y%m%dT%H%M%S}", start);
+            std::ranges::replace(m_ExportName, ' ', '_');
+
+            if (exportCurrent)
+                exportFrame();
+            else
+                m_ExportRemaining = m_ExportFrameCount;
+        }
+
+        if (m_ExportRemaining > 0)
+        {
+            ImGui::Text("Remaining: %d", m_ExportRemaining);
+            ImGui::SameLine();
+            if (ImGui::Button("Stop Export"))
+                m_ExportRemaining = 0;
+        }
+
+        if (m_Exporter)
+        {
+            ImGui::Text("Written: %d, Pending: %d", m_Exporter->getWrittenFrames(), m_Exporter->getPendingFrames());
+            auto error = m_Exporter->getLastError();
+            if (!error.empty())
+                ImGui::TextColored({ 1.0f, 0.3f, 0.3f, 1.0f }, "%s", error.c_str());
+        }
+    }
+
+    void PointCloud::updateGravity()
+    {
+        // The point cloud is the camera frame rotated by 180 degrees around z (see streamDepth)
+        glm::vec3 gravity;
+        bool hasGravity = mp_DepthCamera->getGravity(gravity);
+        m_FloorDetector.setGravity({ -gravity.x, -gravity.y, gravity.z }, hasGravity);
+    }
+
+    void PointCloud::trackFloor()
+    {
+        updateGravity();
+        m_FloorDetector.track(m_Points, m_NumElements);
+    }
+
+    const int16_t *PointCloud::filterDepth(const int16_t *depth)
+    {
+        if (std::ranges::none_of(m_DepthFilters, [](auto &filter) { return filter->m_IsEnabled; }))
+            return depth;
+
+        memcpy(m_Depth.data(), depth, m_NumElements * sizeof(int16_t));
+
+        for (auto &filter : m_DepthFilters)
+            if (filter->m_IsEnabled)
+                filter->run(m_Depth.data(), m_StreamWidth, m_StreamHeight);
+
+        return m_Depth.data();
+    }
+
+    void PointCloud::benchmarkFilters()
+    {
+        // Rebuild the last frame from the points so the benchmark doesn't advance the camera
+        std::vector<int16_t> frame(m_NumElements);
+        PixIter frame[m_NumElements - 1 - i] = (int16_t)(m_Points[i].Depth / m_MetersPerUnit + 0.5f);
+
+        std::vector<std::unique_ptr<DepthFilter>> filters;
+        for (auto &filter : m_DepthFilters)
+            filters.push_back(filter->clone());
+
+        m_FilterBenchmark = std::async(std::launch::async, [frame = std::move(frame), filters = std::move(filters), width = m_StreamWidth, height = m_StreamHeight]()
+            {
+                std::vector<double> times;
+                for (auto &filter : filters)
+                    times.push_back(filter->benchmark(frame.data(), width, height, 100));
+                return times;
+            });
+    }
+
+    void PointCloud::streamDepth(int i, const int16_t *depth)
+    {
+        // The image is rotated by 180 degrees
+        int depth_i = m_NumElements - 1 - i;
+
         // Read depth data
         m_Points[i].updateVertexArray((float)depth[depth_i] * m_MetersPerUnit, m_CMAP);
+
+        m_BoundingBox.addPoint(m_Points[i].getPoint());
     }
 
     void PointCloud::startNormalCalculation()
@@ -239,50 +772,90 @@ namespace GLObject
     void PointCloud::startCellAssignment()
     {
         if (!m_NormalsCalculated)
-            for (int i = 0; i < m_NumElements; i++)
+            ActiveIter
                 calculateNormals(i);
 
         m_State.setState(PointCloudStreamState::CELLS);
 
         if (!m_CellsAssigned)
         {
-            PixIter
-            {
-                auto p = m_Points[i].getPoint();
+            m_pCellByPoint.assign(m_NumElements, nullptr);
 
-                std::string key = Cell::getKey(m_BoundingBox, m_CellSize, p);
-
-                if (!m_pCellByKey.contains(key))
-                {
-                    glm::vec3 color{ m_ColorDistribution->operator()(m_Generator), 
-                                     m_ColorDistribution->operator()(m_Generator), 
-                                     m_ColorDistribution->operator()(m_Generator) };
-                    m_pCellByKey.insert(std::make_pair(key, new Cell(key, &m_PlanarThreshold)));
-                    m_ColorBypCell.insert(std::make_pair(m_pCellByKey[key], color));
-                }
-                m_pCellByKey[key]->addPoint(&m_Points[i]);
-            }
+            if (m_UseOctree)
+                assignOctreeCells();
+            else
+                assignGridCells();
 
             m_CellsAssigned = true;
         }
     }
 
-    void PointCloud::assignCells(int i)
+    void PointCloud::assignGridCells()
     {
-        auto p = m_Points[i].getPoint();
+        ActiveIter
+        {
+            if (m_Points[i].Depth <= 0)
+                continue;
+
+            std::string key = Cell::getKey(m_BoundingBox, m_CellSize, m_Points[i].getPoint());
+
+            if (!m_pCellByKey.contains(key))
+                addCell(key, new Cell(key, &m_PlanarThreshold));
+
+            auto cell = m_pCellByKey[key];
+            cell->addPoint(&m_Points[i]);
+            m_pCellByPoint[i] = cell;
+        }
+    }
+
+    void PointCloud::assignOctreeCells()
+    {
+        m_Octree.build(m_Points, m_NumElements, m_BoundingBox);
+
+        auto &nodes = m_Octree.getNodes();
+
+        for (int leaf : m_Octree.getLeaves())
+        {
+            auto &node = nodes[leaf];
+            auto cell = new Cell(m_Octree.getIndex(node), &m_PlanarThreshold);
+            addCell(Octree::getKey(node), cell);
+
+            for (unsigned int k = node.First; k < node.First + node.Count; k++)
+            {
+                auto i = m_Octree.getPointIndex(k);
+                cell->addPoint(&m_Points[i]);
+                m_pCellByPoint[i] = cell;
+            }
+        }
+    }
 
-        std::string key = Cell::getKey(m_BoundingBox, m_CellSize, p);
+    void PointCloud::addCell(const std::string &key, Cell *cell)
+    {
+        glm::vec3 color{ m_ColorDistribution->operator()(m_Generator), 
+                         m_ColorDistribution->operator()(m_Generator), 
+                         m_ColorDistribution->operator()(m_Generator) };
+        m_pCellByKey.insert(std::make_pair(key, cell));
+        m_ColorBypCell.insert(std::make_pair(cell, color));
+    }
+
+    void PointCloud::assignCells(int i)
+    {
+        auto cell = m_pCellByPoint[i];
 
-        glm::vec3 col;
+        glm::vec3 col{ 0.0f };
 
-        if (m_ShowAverageNormals)
+        if (cell == nullptr)
         {
-            auto normal = m_pCellByKey[key]->getNormalisedNormal();
+            // Point without depth or outside the octree box
+        }
+        else if (m_ShowAverageNormals)
+        {
+            auto normal = cell->getNormalisedNormal();
             col = (normal + glm::vec3(1.0f)) / glm::vec3(2.0f);
         }
         else
         {
-            col = m_ColorBypCell[m_pCellByKey[key]];
+            col = m_ColorBypCell[cell];
         }
 
         for (int v : std::views::iota(0, Point::VertexCount))
@@ -304,14 +877,33 @@ namespace GLObject
 
         if (m_PlanarpCells.empty())
         {
+            std::vector<Cell *> cells;
+            cells.reserve(m_pCellByKey.size());
             for (auto const &[_, cell] : m_pCellByKey)
+                cells.push_back(cell);
+
+            std::vector<int> cellIndices(cells.size());
+            std::iota(cellIndices.begin(), cellIndices.end(), 0);
+
+            std::vector<uint8_t> valid(cells.size());
+            std::for_each(std::execution::par, cellIndices.begin(), cellIndices.end(),
+                [&cells, &valid](int i) { valid[i] = cells[i]->calculateCovariance(); });
+
+            // All covariances are decomposed in one batch
+            m_EigenSolver.resize(cells.size());
+            for (int i = 0; i < cells.size(); i++)
+                m_EigenSolver.setMatrix(i, cells[i]->getCovariance());
+            m_EigenSolver.solve();
+
+            for (int i = 0; i < cells.size(); i++)
             {
-                cell->calculateNDT();
+                if (valid[i])
+                    cells[i]->setEigen(m_EigenSolver.getEigenValues(i), m_EigenSolver.getEigenVectors(i));
 
-                if (cell->getType() == Cell::NDT_TYPE::Planar)
-                    m_PlanarpCells.push_back(cell);
+                if (valid[i] && cells[i]->getType() == Cell::NDT_TYPE::Planar)
+                    m_PlanarpCells.push_back(cells[i]);
                 else
-                    m_NonPlanarpCells.push_back(cell);
+                    m_NonPlanarpCells.push_back(cells[i]);
             }
             m_PointDistribution = std::make_unique<std::uniform_int_distribution<int>>(0, m_PlanarpCells.size());
         }
@@ -319,22 +911,23 @@ namespace GLObject
 
     void PointCloud::calculateCells(int i)
     {
-        auto p = m_Points[i].getPoint();
-
-        std::string key = Cell::getKey(m_BoundingBox, m_CellSize, p);
-
-        glm::vec3 col;
+        glm::vec3 col{ 0.0f };
 
-        auto cell = m_pCellByKey[key];
-        auto type = cell->getType();
+        auto cell = m_pCellByPoint[i];
 
-        if (m_ShowAverageNormals)
+        if (cell == nullptr)
+        {
+            // Point without depth
+        }
+        else if (m_ShowAverageNormals)
         {
             auto normal = cell->getNormalisedNormal();
             col = (normal + glm::vec3(1.0f)) / glm::vec3(2.0f);
         }
         else
         {
+            auto type = cell->getType();
+
             if (type == Cell::NDT_TYPE::Planar)
                 col = glm::vec3{ 0.0f, 0.0f, 1.0f };
             else if (type == Cell::NDT_TYPE::Linear)
@@ -9,6 +9,8 @@
 
 #include <array>
 #include <memory>
+#include <atomic>
+#include <future>
 #include <cameras/DepthCamera.h>
 
 #include <unordered_map>
@@ -21,9 +23,20 @@
 #include "Plane.h"
 #include "Cell.h"
 #include "BoundingBox.h"
+#include "Octree.h"
+#include "EigenSolver.h"
+#include "FloorDetector.h"
+#include "BackgroundModel.h"
+#include "Clustering.h"
 
 #include "PointCloudHelper.h"
 
+#include <filters/DepthFilter.h>
+#include <skeleton/SkeletonWorker.h>
+#include <recording/SkeletonSidecar.h>
+#include <recording/DepthRecording.h>
+#include <export/PointCloudExporter.h>
+
 namespace GLObject
 {
 	class PointCloud : public GLObject
@@ -35,6 +48,35 @@ namespace GLObject
 		void OnRender() override;
 		void OnImGuiRender() override;
 
+		/// <summary>
+		/// Writes the skeletons and the floor of every following frame to a sidecar file
+		/// </summary>
+		/// <returns>False if the file could not be created</returns>
+		bool startSkeletonRecording(const std::filesystem::path &path);
+		void stopSkeletonRecording();
+
+		/// <summary>
+		/// Writes the raw depth of every following frame to a native depth recording
+		/// </summary>
+		/// <returns>False if the file could not be created</returns>
+		bool startDepthRecording(const std::filesystem::path &path);
+		void stopDepthRecording();
+
+		/// <summary>
+		/// Adds a frame that is saved without being streamed to the depth and skeleton recordings
+		/// </summary>
+		void recordDepth(const void *depth);
+
+		/// <returns>False if no depth recording is running</returns>
+		bool getDepthRecordingStats(DepthRecording::Writer::Stats &stats) const
+		{
+			stats = m_DepthWriter.getStats();
+			return m_DepthWriter.isOpen();
+		}
+
+		/// <returns>Frames written to the running (or last) recording, safe to call from any thread</returns>
+		unsigned int getRecordedFrames() const { return m_RecordedFrames; }
+
 	private:
 		void pauseStream()
 		{
@@ -45,27 +87,72 @@ namespace GLObject
 		{
 			m_State.setState(PointCloudStreamState::STREAM);
 
+			clearCells();
+
+			m_ShowAverageNormals = false;
+			m_NormalsCalculated = false;
+
+			for (auto &filter : m_DepthFilters)
+				filter->reset();
+		}
+
+		void clearCells()
+		{
 			for (auto key : m_pCellByKey)
 				delete key.second;
 
 			m_pCellByKey.clear();
+			m_pCellByPoint.clear();
 			m_ColorBypCell.clear();
 			m_PlanarpCells.clear();
 			m_NonPlanarpCells.clear();
 
 			m_CellsAssigned = false;
-			m_ShowAverageNormals = false;
-			m_NormalsCalculated = false;
 		}
 
+		const int16_t *filterDepth(const int16_t *depth);
+		void benchmarkFilters();
+		const int16_t *removeBackground(const int16_t *depth);
 		void streamDepth(int i, const int16_t *depth);
 		void startNormalCalculation();
 		void calculateNormals(int i);
 		void startCellAssignment();
+		void assignGridCells();
+		void assignOctreeCells();
+		void addCell(const std::string &key, Cell *cell);
 		void assignCells(int i);
 		void startCellCalculation();
 		void calculateCells(int i);
 		void doPlaneSegmentation();
+		void updateGravity();
+		void trackFloor();
+		void clusterPoints();
+		void detectSkeleton();
+		void recordSkeleton();
+
+		/// <summary>
+		/// Reads the device numbering of the frame that was just taken from the camera
+		/// </summary>
+		void updateFrameInfo();
+
+		/// <summary>
+		/// Writes the current frame to the running depth and skeleton recordings
+		/// </summary>
+		void recordFrame(const void *depth);
+
+		/// <summary>
+		/// Converts device numbering to the numbering of the running recording
+		/// </summary>
+		/// <returns>False if the frame is not part of the recording</returns>
+		bool toRecordedFrame(uint64_t deviceFrame, double deviceTimestamp, uint32_t &frameIndex, double &timestamp) const;
+		/// <param name="isSequence">Frames of a sequence wait for the exporter instead of being dropped</param>
+		void exportFrame(bool isSequence = false);
+		void showExport();
+
+		static double getTimestamp()
+		{
+			return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
 
 		PointCloudStreamState m_State{ };
 
@@ -74,6 +161,13 @@ namespace GLObject
 		Point *m_Points; 
 		Point::Vertex *m_Vertices;
 
+		// Filtered copy of the current depth frame
+		std::vector<int16_t> m_Depth;
+		std::vector<std::unique_ptr<DepthFilter>> m_DepthFilters;
+
+		// Milliseconds per filter, the benchmark runs on copies of the filters so the stream keeps its state
+		std::future<std::vector<double>> m_FilterBenchmark;
+
 		GLUtil m_GLUtil{};
 
 		std::default_random_engine m_Generator;
@@ -94,19 +188,69 @@ namespace GLObject
 		std::unordered_map<Cell*, glm::vec3> m_ColorBypCell;
 		std::unordered_map<std::string, Cell*> m_pCellByKey;
 
+		// Cell of every point, nullptr for points without depth
+		std::vector<Cell *> m_pCellByPoint;
+
 		std::vector<Cell *> m_PlanarpCells;
 		std::vector<Cell *> m_NonPlanarpCells;
 
 		BoundingBox m_BoundingBox{ };
+		Octree m_Octree{ };
+		bool m_UseOctree{ false };
 		glm::vec3 m_CellSize{ };
 
 		float m_PlanarThreshold{ 0.004f };
 
+		EigenSolver m_EigenSolver{ };
+		EigenSolver::BenchmarkResult m_EigenBenchmark{ };
+		std::future<EigenSolver::BenchmarkResult> m_EigenBenchmarkTask;
+
+		FloorDetector m_FloorDetector{ };
+
+		Clustering m_Clustering{ };
+		bool m_ShowClusters{ true };
+
+		std::unique_ptr<SkeletonWorker> m_SkeletonWorker;
+		bool m_DetectSkeleton{ false };
+		bool m_ShowSkeleton{ true };
+
+		SkeletonSidecar::Writer m_SkeletonWriter;
+		DepthRecording::Writer m_DepthWriter;
+
+		// Created with the first export
+		std::unique_ptr<PointCloudExporter> m_Exporter;
+		char m_ExportDirectory[256]{ "exports" };
+		PointCloudExporter::Format m_ExportFormat{ PointCloudExporter::Format::Ply };
+		int m_ExportFrameCount{ 30 };
+
+		// Streamed frames still to export
+		int m_ExportRemaining{ 0 };
+
+		// Files are named <camera>_<start of the export>_<counter>, the counter runs on over all exports
+		std::string m_ExportName;
+		unsigned int m_ExportCounter{ 0 };
+		unsigned int m_RecordedDetections{ 0 };
+
+		// Device frame number and timestamp (seconds) of the current frame
+		uint64_t m_DeviceFrame{ 0 };
+		double m_DeviceTimestamp{ 0.0 };
+
+		// First frame of the running recording, recorded frames are numbered and timed from it
+		bool m_HasFirstRecordedFrame{ false };
+		std::atomic<unsigned int> m_RecordedFrames{ 0 };
+		uint64_t m_FirstRecordedFrame{ 0 };
+		double m_FirstRecordedTimestamp{ 0.0 };
+
 		bool m_CellsAssigned{ false };
 		bool m_ShowAverageNormals{ false };
 		bool m_NormalsCalculated{ false };
 
 		// Meters per unit
 		float m_MetersPerUnit = 0.0f;
+
+		BackgroundModel m_BackgroundModel;
+
+		// Points the normal and cell stages run on, the foreground if the background is removed
+		std::vector<int> m_ActivePoints;
 	};
 };
@@ -76,9 +76,17 @@ struct PointCloudStreamState
 struct GLUtil
 {
 	Renderer *mp_Renderer;
+
+	/// <summary>
+	/// Name of the draws in the renderer statistics and of the buffers in the GPU memory accounting
+	/// </summary>
+	std::string m_PassName;
+
 	std::unique_ptr<VertexArray> m_VAO;
 	std::unique_ptr<IndexBuffer> m_IndexBuffer;
-	std::unique_ptr<Shader> m_Shader;
+	std::shared_ptr<Shader> m_Shader;
+	Shader::Uniform m_ScaleUniform;
+	Shader::Uniform m_MVPUniform;
 	std::unique_ptr<VertexBuffer> m_VB;
 	std::unique_ptr<VertexBufferLayout> m_VBL;
 
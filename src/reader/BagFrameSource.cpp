@@ -0,0 +1,129 @@
+#include "SessionReader.h"
+
+#include <librealsense2/rs.hpp>
+
+namespace
+{
+	/// <summary>
+	/// .bag recording outside of real time, the file is only read as fast as the frames are taken
+	/// </summary>
+	class BagSource : public SessionReader::Source
+	{
+	public:
+		~BagSource()
+		{
+			if (m_IsStarted)
+				m_Pipe.stop();
+		}
+
+		bool open(const std::filesystem::path &path, std::string &error)
+		{
+			try
+			{
+				m_Info.FileName = path;
+				if (!start())
+				{
+					error = "No depth frame in '" + path.string() + "'";
+					return false;
+				}
+
+				auto depth = m_Frames.get_depth_frame();
+				auto intrinsics = depth.get_profile().as<rs2::video_stream_profile>().get_intrinsics();
+				m_Info.Width = intrinsics.width;
+				m_Info.Height = intrinsics.height;
+				m_Info.DepthUnits = depth.get_units();
+				m_Info.Fx = intrinsics.fx;
+				m_Info.Fy = intrinsics.fy;
+				m_Info.Cx = intrinsics.ppx;
+				m_Info.Cy = intrinsics.ppy;
+				return true;
+			}
+			catch (const rs2::error &e)
+			{
+				error = "Could not open '" + path.string() + "': " + e.what();
+				return false;
+			}
+		}
+
+		bool next(SessionReader::Frame &frame) override
+		{
+			try
+			{
+				// The first frame was read by start
+				if (!m_HasFrames && !read(m_Frames))
+					return false;
+				m_HasFrames = false;
+
+				auto depth = m_Frames.get_depth_frame();
+				if (m_Next == 0)
+					m_FirstTimestamp = depth.get_timestamp();
+
+				frame.Depth = static_cast<const uint16_t *>(depth.get_data());
+				frame.Stride = depth.get_stride_in_bytes();
+				frame.Number = m_Next;
+				frame.FrameIndex = m_Next;
+				frame.Timestamp = (depth.get_timestamp() - m_FirstTimestamp) * 1e-3;
+				m_Next++;
+				return true;
+			}
+			catch (const rs2::error &)
+			{
+				return false;
+			}
+		}
+
+		bool rewind() override
+		{
+			try
+			{
+				if (m_IsStarted)
+					m_Pipe.stop();
+				m_IsStarted = false;
+				return start();
+			}
+			catch (const rs2::error &)
+			{
+				return false;
+			}
+		}
+	private:
+		bool start()
+		{
+			rs2::config config;
+			config.enable_device_from_file(m_Info.FileName.string(), false);
+			auto profile = m_Pipe.start(config);
+			m_IsStarted = true;
+			profile.get_device().as<rs2::playback>().set_real_time(false);
+
+			m_Next = 0;
+			m_HasFrames = read(m_Frames);
+			return m_HasFrames;
+		}
+
+		bool read(rs2::frameset &frames)
+		{
+			// Without repeat the pipeline stops delivering at the end of the file
+			while (m_Pipe.try_wait_for_frames(&frames, 2000))
+			{
+				if (frames.get_depth_frame())
+					return true;
+			}
+			return false;
+		}
+
+		rs2::pipeline m_Pipe;
+		rs2::frameset m_Frames;
+		bool m_IsStarted{ false };
+		bool m_HasFrames{ false };
+		uint32_t m_Next{ 0 };
+		double m_FirstTimestamp{ 0.0 };
+	};
+}
+
+std::unique_ptr<SessionReader::Source> openBagSource(const std::filesystem::path &path, std::string &error)
+{
+	auto source = std::make_unique<BagSource>();
+	if (!source->open(path, error))
+		return nullptr;
+	return source;
+}
@@ -0,0 +1,179 @@
+#include "FESDReader.h"
+#include "SessionReader.h"
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+struct fesd_session
+{
+	SessionReader Reader;
+
+	/// <summary>
+	/// Last frame of every camera, the pointers handed out point into it
+	/// </summary>
+	std::vector<SessionReader::Frame> Frames;
+
+	std::vector<std::string> FileNames;
+	std::string Error;
+	std::mutex ErrorMutex;
+};
+
+static_assert(FESD_JOINT_COUNT == Skeleton::JointCount, "FESD_JOINT_COUNT does not match the skeleton");
+
+namespace
+{
+	std::mutex s_OpenErrorMutex;
+	std::string s_OpenError;
+
+	bool isCamera(const fesd_session *session, int camera)
+	{
+		return session && camera >= 0 && camera < session->Reader.getCameraCount();
+	}
+
+	void setError(fesd_session *session, const std::string &error)
+	{
+		std::lock_guard<std::mutex> lock(session->ErrorMutex);
+		session->Error = error;
+	}
+}
+
+int fesd_version(void)
+{
+	return FESD_READER_VERSION;
+}
+
+fesd_session *fesd_open(const char *session_file)
+{
+	auto session = new fesd_session();
+	bool isOpen = false;
+	try
+	{
+		isOpen = session_file && session->Reader.open(std::filesystem::path(reinterpret_cast<const char8_t *>(session_file)));
+	}
+	catch (const std::exception &e)
+	{
+		session->Reader.close();
+		std::lock_guard<std::mutex> lock(s_OpenErrorMutex);
+		s_OpenError = e.what();
+		delete session;
+		return nullptr;
+	}
+
+	if (!isOpen)
+	{
+		std::lock_guard<std::mutex> lock(s_OpenErrorMutex);
+		s_OpenError = session_file ? session->Reader.getError() : "No session file";
+		delete session;
+		return nullptr;
+	}
+
+	const int cameras = session->Reader.getCameraCount();
+	session->Frames.resize(cameras);
+	for (int c = 0; c < cameras; c++)
+	{
+		auto fileName = session->Reader.getCameraInfo(c).FileName.u8string();
+		session->FileNames.emplace_back(fileName.begin(), fileName.end());
+	}
+	return session;
+}
+
+void fesd_close(fesd_session *session)
+{
+	delete session;
+}
+
+const char *fesd_last_error(const fesd_session *session)
+{
+	// The strings only change on the next failing call, like errno
+	if (!session)
+	{
+		std::lock_guard<std::mutex> lock(s_OpenErrorMutex);
+		return s_OpenError.c_str();
+	}
+	return session->Error.c_str();
+}
+
+int fesd_camera_count(const fesd_session *session)
+{
+	return session ? session->Reader.getCameraCount() : -1;
+}
+
+int fesd_get_camera_info(const fesd_session *session, int camera, fesd_camera_info *info)
+{
+	if (!isCamera(session, camera) || !info)
+		return -1;
+
+	const auto &source = session->Reader.getCameraInfo(camera);
+	info->name = source.Name.c_str();
+	info->type = source.Type.c_str();
+	info->file_name = session->FileNames[camera].c_str();
+	info->width = source.Width;
+	info->height = source.Height;
+	info->depth_units = source.DepthUnits;
+	info->fx = source.Fx;
+	info->fy = source.Fy;
+	info->cx = source.Cx;
+	info->cy = source.Cy;
+	info->frame_count = source.FrameCount;
+	return 0;
+}
+
+const char *fesd_joint_name(int joint)
+{
+	if (joint < 0 || joint >= Skeleton::JointCount)
+		return nullptr;
+	return Skeleton::JointNames[joint];
+}
+
+int fesd_next_frame(fesd_session *session, int camera, fesd_frame *frame)
+{
+	if (!isCamera(session, camera) || !frame)
+		return -1;
+
+	auto &current = session->Frames[camera];
+	try
+	{
+		if (!session->Reader.next(camera, current))
+			return 0;
+	}
+	catch (const std::exception &e)
+	{
+		setError(session, e.what());
+		return -1;
+	}
+
+	const auto &info = session->Reader.getCameraInfo(camera);
+	frame->depth = current.Depth;
+	frame->width = info.Width;
+	frame->height = info.Height;
+	frame->row_stride = current.Stride;
+	frame->dtype = "<u2";
+	frame->timestamp = current.Timestamp;
+	frame->number = current.Number;
+	frame->frame_index = current.FrameIndex;
+	frame->has_skeleton = current.HasSkeleton;
+	frame->has_floor = current.HasFloor;
+	frame->joints = &current.Skeleton.Joints[0][0];
+	frame->confidence = current.Skeleton.Confidence;
+	frame->floor = current.Skeleton.Floor;
+	return 1;
+}
+
+int fesd_rewind(fesd_session *session, int camera)
+{
+	if (!isCamera(session, camera))
+		return -1;
+
+	try
+	{
+		if (session->Reader.rewind(camera))
+			return 0;
+		setError(session, "Could not rewind '" + session->FileNames[camera] + "'");
+	}
+	catch (const std::exception &e)
+	{
+		setError(session, e.what());
+	}
+	return -1;
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <stdint.h>
+
+/// <summary>
+/// C interface of the session reader, built as FESDReader.dll for python/fesd_reader.py.
+/// All pointers handed out stay owned by the library: the depth and skeleton of a frame stay valid until the next
+/// fesd_next_frame / fesd_rewind of the same camera or fesd_close, so they can be wrapped without a copy.
+/// Every function returns a negative value on an error, fesd_last_error describes it.
+/// A session may be used from several threads as long as every camera is only read by one of them.
+/// </summary>
+
+#ifdef _WIN32
+#define FESD_API __declspec(dllexport)
+#else
+#define FESD_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FESD_READER_VERSION 1
+#define FESD_JOINT_COUNT 8
+
+typedef struct fesd_session fesd_session;
+
+typedef struct fesd_camera_info
+{
+	const char *name;
+	const char *type;
+
+	/// <summary>
+	/// Recording the frames are read from
+	/// </summary>
+	const char *file_name;
+
+	uint32_t width;
+	uint32_t height;
+
+	/// <summary>
+	/// Meters per depth unit
+	/// </summary>
+	float depth_units;
+	float fx, fy, cx, cy;
+
+	/// <summary>
+	/// -1 if unknown before the end (.bag)
+	/// </summary>
+	int64_t frame_count;
+} fesd_camera_info;
+
+typedef struct fesd_frame
+{
+	/// <summary>
+	/// height rows of width little endian uint16 ("<u2") values, row_stride bytes apart
+	/// </summary>
+	const uint16_t *depth;
+	uint32_t width;
+	uint32_t height;
+	uint64_t row_stride;
+	const char *dtype;
+
+	/// <summary>
+	/// Seconds since the first frame
+	/// </summary>
+	double timestamp;
+
+	uint32_t number;
+	uint32_t frame_index;
+
+	int32_t has_skeleton;
+	int32_t has_floor;
+
+	/// <summary>
+	/// Joints in camera space (meters) in the order of Skeleton::JointNames, only valid with has_skeleton
+	/// </summary>
+	const float *joints;
+	const float *confidence;
+
+	/// <summary>
+	/// Floor plane (normal, distance), only valid with has_floor
+	/// </summary>
+	const float *floor;
+} fesd_frame;
+
+FESD_API int fesd_version(void);
+
+/// <param name="session_file">UTF-8 path of the session .json</param>
+/// <returns>nullptr on an error, see fesd_last_error(nullptr)</returns>
+FESD_API fesd_session *fesd_open(const char *session_file);
+FESD_API void fesd_close(fesd_session *session);
+
+/// <summary>
+/// Message of the last error of the session, or of the last failed fesd_open for nullptr
+/// </summary>
+FESD_API const char *fesd_last_error(const fesd_session *session);
+
+FESD_API int fesd_camera_count(const fesd_session *session);
+FESD_API int fesd_get_camera_info(const fesd_session *session, int camera, fesd_camera_info *info);
+
+/// <summary>
+/// Name of joint j
+/// </summary>
+FESD_API const char *fesd_joint_name(int joint);
+
+/// <returns>1 for a frame, 0 at the end of the recording, -1 on an error</returns>
+FESD_API int fesd_next_frame(fesd_session *session, int camera, fesd_frame *frame);
+
+/// <summary>
+/// Starts the camera over at the first frame
+/// </summary>
+FESD_API int fesd_rewind(fesd_session *session, int camera);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,135 @@
+#include "SessionReader.h"
+
+#include <mutex>
+#include <cmath>
+#include <numbers>
+#include <OpenNI.h>
+
+namespace
+{
+	std::mutex s_OpenNIMutex;
+	int s_OpenNIUsers = 0;
+
+	/// <summary>
+	/// OpenNI is process wide, the last source shuts it down
+	/// </summary>
+	bool acquireOpenNI()
+	{
+		std::lock_guard<std::mutex> lock(s_OpenNIMutex);
+		if (s_OpenNIUsers == 0 && openni::OpenNI::initialize() != openni::STATUS_OK)
+			return false;
+		s_OpenNIUsers++;
+		return true;
+	}
+
+	void releaseOpenNI()
+	{
+		std::lock_guard<std::mutex> lock(s_OpenNIMutex);
+		if (--s_OpenNIUsers == 0)
+			openni::OpenNI::shutdown();
+	}
+
+	/// <summary>
+	/// .oni recording in manual speed, every frame is read once and in order
+	/// </summary>
+	class OniSource : public SessionReader::Source
+	{
+	public:
+		~OniSource()
+		{
+			m_Frame.release();
+			m_Stream.destroy();
+			m_Device.close();
+			if (m_IsInitialized)
+				releaseOpenNI();
+		}
+
+		bool open(const std::filesystem::path &path, std::string &error)
+		{
+			m_IsInitialized = acquireOpenNI();
+			if (!m_IsInitialized)
+			{
+				error = std::string("Could not initialize OpenNI: ") + openni::OpenNI::getExtendedError();
+				return false;
+			}
+
+			if (m_Device.open(path.string().c_str()) != openni::STATUS_OK || m_Stream.create(m_Device, openni::SENSOR_DEPTH) != openni::STATUS_OK)
+			{
+				error = "Could not open '" + path.string() + "': " + openni::OpenNI::getExtendedError();
+				return false;
+			}
+
+			mp_Control = m_Device.getPlaybackControl();
+			mp_Control->setSpeed(-1.0f);
+			mp_Control->setRepeatEnabled(false);
+
+			if (m_Stream.start() != openni::STATUS_OK)
+			{
+				error = "Could not start the depth stream of '" + path.string() + "'";
+				return false;
+			}
+
+			auto mode = m_Stream.getVideoMode();
+			m_Info.FileName = path;
+			m_Info.Width = mode.getResolutionX();
+			m_Info.Height = mode.getResolutionY();
+			m_Info.DepthUnits = mode.getPixelFormat() == openni::PIXEL_FORMAT_DEPTH_100_UM ? 0.0001f : 0.001f;
+			m_Info.FrameCount = mp_Control->getNumberOfFrames(m_Stream);
+
+			// The recording keeps the field of view of the device, the Astra values if it does not
+			float hfov = m_Stream.getHorizontalFieldOfView();
+			float vfov = m_Stream.getVerticalFieldOfView();
+			if (hfov <= 0.0f || vfov <= 0.0f)
+			{
+				hfov = 60.0f * std::numbers::pi_v<float> / 180.0f;
+				vfov = 49.5f * std::numbers::pi_v<float> / 180.0f;
+			}
+			m_Info.Fx = m_Info.Width / (2.0f * std::tan(hfov / 2.0f));
+			m_Info.Fy = m_Info.Height / (2.0f * std::tan(vfov / 2.0f));
+			m_Info.Cx = m_Info.Width / 2.0f;
+			m_Info.Cy = m_Info.Height / 2.0f;
+			return true;
+		}
+
+		bool next(SessionReader::Frame &frame) override
+		{
+			if (m_Next >= m_Info.FrameCount || m_Stream.readFrame(&m_Frame) != openni::STATUS_OK)
+				return false;
+
+			if (m_Next == 0)
+				m_FirstTimestamp = m_Frame.getTimestamp();
+
+			frame.Depth = static_cast<const uint16_t *>(m_Frame.getData());
+			frame.Stride = m_Frame.getStrideInBytes();
+			frame.Number = (uint32_t)m_Next;
+			frame.FrameIndex = (uint32_t)m_Next;
+			frame.Timestamp = (m_Frame.getTimestamp() - m_FirstTimestamp) * 1e-6;
+			m_Next++;
+			return true;
+		}
+
+		bool rewind() override
+		{
+			if (mp_Control->seek(m_Stream, 0) != openni::STATUS_OK)
+				return false;
+			m_Next = 0;
+			return true;
+		}
+	private:
+		openni::Device m_Device;
+		openni::VideoStream m_Stream;
+		openni::PlaybackControl *mp_Control{ nullptr };
+		openni::VideoFrameRef m_Frame;
+		bool m_IsInitialized{ false };
+		int64_t m_Next{ 0 };
+		uint64_t m_FirstTimestamp{ 0 };
+	};
+}
+
+std::unique_ptr<SessionReader::Source> openOniSource(const std::filesystem::path &path, std::string &error)
+{
+	auto source = std::make_unique<OniSource>();
+	if (!source->open(path, error))
+		return nullptr;
+	return source;
+}
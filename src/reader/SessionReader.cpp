@@ -0,0 +1,180 @@
+#include "SessionReader.h"
+
+#include <fstream>
+#include <cmath>
+#include <json/json.h>
+
+#include <recording/MappedDepthRecording.h>
+
+namespace
+{
+	/// <summary>
+	/// Native depth recording, raw frames point into the mapping, RVL frames are decoded into one buffer
+	/// </summary>
+	class FdrSource : public SessionReader::Source
+	{
+	public:
+		bool open(const std::filesystem::path &path, std::string &error)
+		{
+			if (!m_Reader.open(path, true))
+			{
+				error = "Could not read depth recording '" + path.string() + "'";
+				return false;
+			}
+
+			const auto &header = m_Reader.getHeader();
+			m_Info.FileName = path;
+			m_Info.Width = header.Width;
+			m_Info.Height = header.Height;
+			m_Info.DepthUnits = header.DepthUnits;
+			m_Info.Fx = header.Fx;
+			m_Info.Fy = header.Fy;
+			m_Info.Cx = header.Cx;
+			m_Info.Cy = header.Cy;
+			m_Info.FrameCount = m_Reader.getFrameCount();
+			return true;
+		}
+
+		bool next(SessionReader::Frame &frame) override
+		{
+			if (m_Next >= m_Reader.getFrameCount())
+				return false;
+
+			auto view = m_Reader.getFrame(m_Next++, m_Buffer);
+			if (!view)
+				return false;
+
+			frame.Depth = view.Depth;
+			frame.Stride = m_Info.Width * sizeof(uint16_t);
+			frame.Number = view.Number;
+			frame.FrameIndex = view.FrameIndex;
+			frame.Timestamp = view.Timestamp;
+			return true;
+		}
+
+		bool rewind() override
+		{
+			m_Next = 0;
+			return true;
+		}
+	private:
+		DepthRecording::MappedReader m_Reader;
+		std::vector<uint16_t> m_Buffer;
+		uint32_t m_Next{ 0 };
+	};
+}
+
+SessionReader::~SessionReader()
+{
+	close();
+}
+
+bool SessionReader::open(const std::filesystem::path &sessionFile)
+{
+	close();
+
+	std::ifstream configJson(sessionFile);
+	if (!configJson.is_open())
+	{
+		m_Error = "Could not open '" + sessionFile.string() + "'";
+		return false;
+	}
+
+	Json::Value root;
+	Json::CharReaderBuilder builder;
+	JSONCPP_STRING errs;
+	if (!parseFromStream(builder, configJson, &root, &errs))
+	{
+		m_Error = sessionFile.string() + ": " + errs;
+		return false;
+	}
+
+	// The recordings lie next to the session file
+	const auto directory = sessionFile.parent_path();
+	m_Name = root["Name"].asString();
+
+	for (const auto &camera : root["Cameras"])
+	{
+		const std::string type = camera["Type"].asString();
+		std::unique_ptr<Source> stream;
+		bool isNative = false;
+
+		if (camera.isMember("DepthFileName"))
+		{
+			auto fdr = std::make_unique<FdrSource>();
+			if (fdr->open(directory / camera["DepthFileName"].asString(), m_Error))
+			{
+				stream = std::move(fdr);
+				isNative = true;
+			}
+		}
+
+		// Sessions recorded without native depth, or with a damaged .fdr, fall back to the vendor recording
+		if (!stream)
+		{
+			const auto path = directory / camera["FileName"].asString();
+			if (type == "Orbbec")
+				stream = openOniSource(path, m_Error);
+			else if (type == "Realsense")
+				stream = openBagSource(path, m_Error);
+			else
+				m_Error = "Camera Type '" + type + "' unknown";
+		}
+
+		if (!stream)
+		{
+			close();
+			return false;
+		}
+
+		stream->setCamera(camera["Name"].asString(), type);
+
+		Camera &entry = m_Cameras.emplace_back();
+		entry.Stream = std::move(stream);
+		entry.IsNative = isNative;
+		if (camera.isMember("SkeletonFileName"))
+			entry.HasSkeletons = entry.Skeletons.open(directory / camera["SkeletonFileName"].asString());
+	}
+
+	if (m_Cameras.empty())
+	{
+		m_Error = "No cameras in '" + sessionFile.string() + "'";
+		return false;
+	}
+
+	m_Error.clear();
+	return true;
+}
+
+void SessionReader::close()
+{
+	m_Cameras.clear();
+	m_Name.clear();
+}
+
+bool SessionReader::next(int camera, Frame &frame)
+{
+	auto &entry = m_Cameras[camera];
+	if (!entry.Stream->next(frame))
+		return false;
+
+	// Native recordings share the frame index with the sidecar, the vendor recordings the device clock
+	SkeletonSidecar::SkeletonRecord &record = frame.Skeleton;
+	bool isFound = false;
+	if (entry.HasSkeletons)
+	{
+		if (entry.IsNative)
+			isFound = entry.Skeletons.readFrame(frame.FrameIndex, record);
+		else
+			isFound = entry.Skeletons.readClosest(frame.Timestamp, record) && std::abs(record.Timestamp - frame.Timestamp) <= m_SkeletonTolerance;
+	}
+
+	frame.HasSkeleton = isFound && (record.Flags & SkeletonSidecar::HasSkeleton);
+	frame.HasFloor = isFound && (record.Flags & SkeletonSidecar::HasFloor);
+	return true;
+}
+
+bool SessionReader::rewind(int camera)
+{
+	return m_Cameras[camera].Stream->rewind();
+}
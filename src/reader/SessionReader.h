@@ -0,0 +1,144 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <filesystem>
+
+#include <recording/SkeletonSidecar.h>
+
+/// <summary>
+/// Reads the recordings of a session (the session .json the recorder writes) frame by frame, without the camera classes,
+/// OpenGL or ImGui. Every camera is read from its native depth recording (.fdr) if there is one, otherwise from the
+/// vendor recording (.oni through OpenNI, .bag through librealsense). Frames come with the skeleton recorded for them:
+/// .fdr frames match the sidecar by frame index, vendor frames by the time since the start of the recording.
+/// </summary>
+class SessionReader
+{
+public:
+	struct CameraInfo
+	{
+		std::string Name;
+		std::string Type;
+
+		/// <summary>
+		/// File the frames are read from
+		/// </summary>
+		std::filesystem::path FileName;
+
+		uint32_t Width{ 0 };
+		uint32_t Height{ 0 };
+
+		/// <summary>
+		/// Meters per depth unit
+		/// </summary>
+		float DepthUnits{ 0.0f };
+		float Fx{ 0.0f }, Fy{ 0.0f }, Cx{ 0.0f }, Cy{ 0.0f };
+
+		/// <summary>
+		/// -1 if the format does not know it up front (.bag)
+		/// </summary>
+		int64_t FrameCount{ -1 };
+	};
+
+	struct Frame
+	{
+		/// <summary>
+		/// Height rows of Width depth values, valid until the next frame of the camera is read
+		/// </summary>
+		const uint16_t *Depth{ nullptr };
+
+		/// <summary>
+		/// Bytes from one row to the next
+		/// </summary>
+		size_t Stride{ 0 };
+
+		/// <summary>
+		/// Position in the recording
+		/// </summary>
+		uint32_t Number{ 0 };
+
+		/// <summary>
+		/// Device frame number counted from the first recorded frame, equal to Number for vendor recordings
+		/// </summary>
+		uint32_t FrameIndex{ 0 };
+
+		/// <summary>
+		/// Seconds since the first frame
+		/// </summary>
+		double Timestamp{ 0.0 };
+
+		bool HasSkeleton{ false };
+		bool HasFloor{ false };
+
+		/// <summary>
+		/// Joints, confidences and floor, only valid with HasSkeleton / HasFloor
+		/// </summary>
+		SkeletonSidecar::SkeletonRecord Skeleton{ };
+	};
+
+	/// <summary>
+	/// Frames of one recording in order
+	/// </summary>
+	class Source
+	{
+	public:
+		virtual ~Source() = default;
+
+		/// <returns>False at the end of the recording or on a read error</returns>
+		virtual bool next(Frame &frame) = 0;
+
+		/// <summary>
+		/// Starts over at the first frame
+		/// </summary>
+		virtual bool rewind() = 0;
+
+		const CameraInfo &getInfo() const { return m_Info; }
+
+		/// <summary>
+		/// Name and type come from the session file, not the recording
+		/// </summary>
+		void setCamera(const std::string &name, const std::string &type) { m_Info.Name = name; m_Info.Type = type; }
+	protected:
+		CameraInfo m_Info;
+	};
+
+	~SessionReader();
+
+	/// <returns>False if the session file can not be read or none of its recordings opens, see getError</returns>
+	bool open(const std::filesystem::path &sessionFile);
+	void close();
+
+	const std::string &getError() const { return m_Error; }
+	const std::string &getName() const { return m_Name; }
+
+	int getCameraCount() const { return (int)m_Cameras.size(); }
+	const CameraInfo &getCameraInfo(int camera) const { return m_Cameras[camera].Stream->getInfo(); }
+
+	/// <returns>False at the end of the recording</returns>
+	bool next(int camera, Frame &frame);
+	bool rewind(int camera);
+
+	/// <summary>
+	/// Largest time difference of a vendor frame and the skeleton matched to it
+	/// </summary>
+	double m_SkeletonTolerance{ 0.05 };
+private:
+	struct Camera
+	{
+		std::unique_ptr<Source> Stream;
+		SkeletonSidecar::Reader Skeletons;
+		bool HasSkeletons{ false };
+		bool IsNative{ false };
+	};
+
+	std::vector<Camera> m_Cameras;
+	std::string m_Name;
+	std::string m_Error;
+};
+
+/// <summary>
+/// Sources for the vendor formats, nullptr and an error message if the file can not be opened
+/// </summary>
+std::unique_ptr<SessionReader::Source> openOniSource(const std::filesystem::path &path, std::string &error);
+std::unique_ptr<SessionReader::Source> openBagSource(const std::filesystem::path &path, std::string &error);
@@ -0,0 +1,310 @@
+#include "DepthRecording.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#include "RvlCodec.h"
+#include <GLCore/Profiler.h>
+
+namespace DepthRecording
+{
+	bool Writer::open(const std::filesystem::path &path, const StreamInfo &info, double startTimestamp, Codec encoding)
+	{
+		close();
+
+		// Only whole blocks are written, the stream buffer would just copy them once more
+		m_File.rdbuf()->pubsetbuf(nullptr, 0);
+		m_File.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!m_File.is_open())
+			return false;
+
+		m_PixelCount = (size_t)info.Width * info.Height;
+		m_Encoding = encoding;
+		m_StartTimestamp = startTimestamp;
+
+		Frame prototype;
+		prototype.Depth.resize(m_PixelCount);
+		m_Queue.reset(QueueFrames, prototype);
+		m_Stop = false;
+		m_Frames = 0;
+		m_DroppedFrames = 0;
+		m_MaxQueuedFrames = 0;
+		m_RawBytes = 0;
+		m_EncodedBytes = 0;
+		m_EncodeTime = 0.0;
+		m_WriteThroughput = 0.0;
+
+		m_Index.clear();
+		m_Block.resize(WriteBlockSize);
+		m_BlockUsed = 0;
+		m_WrittenBytes = 0;
+		m_ThroughputBytes = 0;
+		m_ThroughputStart = std::chrono::steady_clock::now();
+
+		// RVL can exceed the raw size on noise, such frames are stored raw
+		m_Encoded.resize(m_PixelCount * sizeof(uint16_t));
+
+		Header header{};
+		std::memcpy(header.Magic, Magic, sizeof(Magic));
+		header.Version = Version;
+		header.Width = info.Width;
+		header.Height = info.Height;
+		header.DepthUnits = info.DepthUnits;
+		header.Fx = info.Fx;
+		header.Fy = info.Fy;
+		header.Cx = info.Cx;
+		header.Cy = info.Cy;
+		header.WriteBlockSize = WriteBlockSize;
+		header.StartTime = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+		// The header goes into the first block, every write starts at a multiple of the block size
+		append(&header, sizeof(header));
+
+		m_Thread = std::thread(&Writer::run, this);
+		return true;
+	}
+
+	bool Writer::push(const uint16_t *depth, uint32_t frameIndex, double timestamp)
+	{
+		if (!isOpen())
+			return false;
+
+		Frame *frame = m_Queue.getFreeSlot();
+		if (!frame)
+		{
+			m_DroppedFrames.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		frame->Depth.assign(depth, depth + m_PixelCount);
+		frame->FrameIndex = frameIndex;
+		frame->Timestamp = std::llround((timestamp - m_StartTimestamp) * 1e6);
+		m_Queue.push();
+
+		uint32_t queued = (uint32_t)m_Queue.getSize();
+		if (queued > m_MaxQueuedFrames.load(std::memory_order_relaxed))
+			m_MaxQueuedFrames.store(queued, std::memory_order_relaxed);
+
+		m_Signal.fetch_add(1, std::memory_order_release);
+		m_Signal.notify_one();
+		return true;
+	}
+
+	void Writer::run()
+	{
+		const size_t rawSize = m_PixelCount * sizeof(uint16_t);
+		PROFILE_THREAD("Depth Writer");
+
+		while (true)
+		{
+			uint32_t signal = m_Signal.load(std::memory_order_acquire);
+			Frame *frame = m_Queue.getFront();
+			if (!frame)
+			{
+				if (m_Stop.load(std::memory_order_acquire))
+					break;
+
+				m_Signal.wait(signal, std::memory_order_acquire);
+				continue;
+			}
+
+			PROFILE_SCOPE("Encode Frame");
+			auto start = std::chrono::high_resolution_clock::now();
+			size_t size = m_Encoding == Codec::Rvl ? RvlCodec::encode(frame->Depth.data(), m_PixelCount, m_Encoded.data(), m_Encoded.size()) : 0;
+
+			FrameHeader header{};
+			header.FrameIndex = frame->FrameIndex;
+			header.Encoding = size > 0 ? Codec::Rvl : Codec::Raw;
+			header.Timestamp = frame->Timestamp;
+			header.Size = (uint32_t)(size > 0 ? size : rawSize);
+
+			m_Index.push_back({ m_WrittenBytes + m_BlockUsed, header.Timestamp, header.FrameIndex, header.Size });
+			append(&header, sizeof(header));
+			append(size > 0 ? (const void *)m_Encoded.data() : (const void *)frame->Depth.data(), header.Size);
+
+			// The slot is free once the frame is in the block
+			m_Queue.pop();
+
+			std::chrono::duration<double, std::milli> encodeTime = std::chrono::high_resolution_clock::now() - start;
+			m_EncodeTime.store(encodeTime.count(), std::memory_order_relaxed);
+			m_Frames.fetch_add(1, std::memory_order_relaxed);
+			m_RawBytes.fetch_add(rawSize, std::memory_order_relaxed);
+			m_EncodedBytes.fetch_add(header.Size + sizeof(FrameHeader), std::memory_order_relaxed);
+		}
+	}
+
+	void Writer::append(const void *data, size_t size)
+	{
+		const uint8_t *bytes = static_cast<const uint8_t *>(data);
+		while (size > 0)
+		{
+			size_t count = std::min(size, m_Block.size() - m_BlockUsed);
+			std::memcpy(m_Block.data() + m_BlockUsed, bytes, count);
+			m_BlockUsed += count;
+			bytes += count;
+			size -= count;
+
+			if (m_BlockUsed == m_Block.size())
+				writeBlocks(false);
+		}
+	}
+
+	void Writer::writeBlocks(bool final)
+	{
+		size_t size = final ? m_BlockUsed : m_BlockUsed / WriteBlockSize * WriteBlockSize;
+		if (size == 0)
+			return;
+
+		m_File.write(reinterpret_cast<const char *>(m_Block.data()), size);
+		m_WrittenBytes += size;
+		m_BlockUsed -= size;
+		std::memmove(m_Block.data(), m_Block.data() + size, m_BlockUsed);
+
+		m_ThroughputBytes += size;
+		auto now = std::chrono::steady_clock::now();
+		double elapsed = std::chrono::duration<double>(now - m_ThroughputStart).count();
+		if (elapsed >= 1.0)
+		{
+			m_WriteThroughput.store(m_ThroughputBytes / elapsed, std::memory_order_relaxed);
+			m_ThroughputBytes = 0;
+			m_ThroughputStart = now;
+		}
+	}
+
+	void Writer::close()
+	{
+		if (!isOpen())
+			return;
+
+		m_Stop.store(true, std::memory_order_release);
+		m_Signal.fetch_add(1, std::memory_order_release);
+		m_Signal.notify_one();
+		m_Thread.join();
+
+		Trailer trailer{};
+		trailer.FooterOffset = m_WrittenBytes + m_BlockUsed;
+		trailer.FrameCount = (uint32_t)m_Index.size();
+		std::memcpy(trailer.Magic, IndexMagic, sizeof(IndexMagic));
+
+		append(m_Index.data(), m_Index.size() * sizeof(IndexEntry));
+		append(&trailer, sizeof(trailer));
+		writeBlocks(true);
+		m_File.close();
+
+		m_Queue.reset(0);
+		m_Block = {};
+	}
+
+	Writer::Stats Writer::getStats() const
+	{
+		Stats stats;
+		stats.Frames = m_Frames.load(std::memory_order_relaxed);
+		stats.DroppedFrames = m_DroppedFrames.load(std::memory_order_relaxed);
+		stats.RawBytes = m_RawBytes.load(std::memory_order_relaxed);
+		stats.EncodedBytes = m_EncodedBytes.load(std::memory_order_relaxed);
+		stats.QueuedFrames = (uint32_t)m_Queue.getSize();
+		stats.MaxQueuedFrames = m_MaxQueuedFrames.load(std::memory_order_relaxed);
+		stats.QueueCapacity = (uint32_t)QueueFrames;
+		stats.EncodeTime = m_EncodeTime.load(std::memory_order_relaxed);
+		stats.WriteThroughput = m_WriteThroughput.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	bool Reader::open(const std::filesystem::path &path)
+	{
+		m_File.close();
+		m_File.clear();
+		m_Index.clear();
+		m_File.open(path, std::ios::in | std::ios::binary);
+		if (!m_File.is_open())
+			return false;
+
+		m_File.seekg(0, std::ios::end);
+		uint64_t fileSize = (uint64_t)m_File.tellg();
+		m_File.seekg(0);
+
+		if (fileSize < sizeof(Header))
+			return false;
+
+		m_File.read(reinterpret_cast<char *>(&m_Header), sizeof(Header));
+		if (std::memcmp(m_Header.Magic, Magic, sizeof(Magic)) != 0 || m_Header.Version != Version)
+			return false;
+
+		Trailer trailer{};
+		if (fileSize >= sizeof(Header) + sizeof(Trailer))
+		{
+			m_File.seekg(fileSize - sizeof(Trailer));
+			m_File.read(reinterpret_cast<char *>(&trailer), sizeof(Trailer));
+		}
+
+		if (std::memcmp(trailer.Magic, IndexMagic, sizeof(IndexMagic)) == 0 &&
+			trailer.FooterOffset + (uint64_t)trailer.FrameCount * sizeof(IndexEntry) + sizeof(Trailer) == fileSize)
+		{
+			m_Index.resize(trailer.FrameCount);
+			m_File.seekg(trailer.FooterOffset);
+			m_File.read(reinterpret_cast<char *>(m_Index.data()), m_Index.size() * sizeof(IndexEntry));
+			return m_File.good();
+		}
+
+		return rebuildIndex(fileSize);
+	}
+
+	bool Reader::rebuildIndex(uint64_t fileSize)
+	{
+		// No index, only complete frames count
+		const uint64_t maxSize = (uint64_t)m_Header.Width * m_Header.Height * sizeof(uint16_t);
+		uint64_t offset = sizeof(Header);
+		FrameHeader header;
+		while (offset + sizeof(FrameHeader) <= fileSize)
+		{
+			m_File.clear();
+			m_File.seekg(offset);
+			m_File.read(reinterpret_cast<char *>(&header), sizeof(FrameHeader));
+			if (!m_File.good() || header.Size > maxSize || offset + sizeof(FrameHeader) + header.Size > fileSize)
+				break;
+
+			m_Index.push_back({ offset, header.Timestamp, header.FrameIndex, header.Size });
+			offset += sizeof(FrameHeader) + header.Size;
+		}
+
+		m_File.clear();
+		return true;
+	}
+
+	bool Reader::readFrame(uint32_t frame, uint16_t *depth)
+	{
+		if (frame >= m_Index.size())
+			return false;
+
+		const auto &entry = m_Index[frame];
+		FrameHeader header;
+		m_File.clear();
+		m_File.seekg(entry.Offset);
+		m_File.read(reinterpret_cast<char *>(&header), sizeof(FrameHeader));
+
+		const size_t pixelCount = (size_t)m_Header.Width * m_Header.Height;
+		if (!m_File.good() || header.Size != entry.Size)
+			return false;
+
+		if (header.Encoding == Codec::Raw)
+		{
+			if (header.Size != pixelCount * sizeof(uint16_t))
+				return false;
+
+			m_File.read(reinterpret_cast<char *>(depth), header.Size);
+			return m_File.good();
+		}
+
+		m_Encoded.resize(header.Size);
+		m_File.read(reinterpret_cast<char *>(m_Encoded.data()), header.Size);
+		return m_File.good() && header.Encoding == Codec::Rvl && RvlCodec::decode(m_Encoded.data(), m_Encoded.size(), depth, pixelCount);
+	}
+
+	uint32_t Reader::findFrame(int64_t timestamp) const
+	{
+		auto next = std::upper_bound(m_Index.begin(), m_Index.end(), timestamp,
+			[](int64_t t, const IndexEntry &entry) { return t < entry.Timestamp; });
+		return next == m_Index.begin() ? 0 : (uint32_t)(next - m_Index.begin() - 1);
+	}
+}
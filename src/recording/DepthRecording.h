@@ -0,0 +1,233 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#include <utilities/SpscRing.h>
+
+/// <summary>
+/// Native depth recording, a compact replacement for the .bag and .oni files of the vendors.
+///
+/// Layout, all little endian:
+///   Header   64 bytes                  "FESDDPTH", version, stream size, depth units, intrinsics, start time (unix seconds)
+///   Frames   n * (24 bytes + payload)  FrameHeader followed by the encoded depth
+///   Footer   n * 24 bytes              IndexEntry per frame: file offset of its FrameHeader, timestamp, frame index, size
+///   Trailer  24 bytes                  footer offset (uint64), frame count, 0, "FESDIDX\0"
+///
+/// Frames are RVL encoded (see RvlCodec.h) and stored raw if that is smaller.
+/// A file without trailer (the recording did not stop cleanly) is still readable, the index is rebuilt from the frame headers.
+/// </summary>
+namespace DepthRecording
+{
+	static const char Magic[8] = { 'F', 'E', 'S', 'D', 'D', 'P', 'T', 'H' };
+	static const char IndexMagic[8] = { 'F', 'E', 'S', 'D', 'I', 'D', 'X', '\0' };
+	static const uint32_t Version = 1;
+
+	enum class Codec : uint32_t
+	{
+		Raw = 0,
+		Rvl = 1
+	};
+
+	struct Header
+	{
+		char Magic[8];
+		uint32_t Version;
+		uint32_t Width;
+		uint32_t Height;
+
+		/// <summary>
+		/// Meters per depth unit
+		/// </summary>
+		float DepthUnits;
+
+		float Fx, Fy, Cx, Cy;
+
+		/// <summary>
+		/// Size of the blocks the writer wrote, only informative
+		/// </summary>
+		uint32_t WriteBlockSize;
+		uint32_t Reserved[3];
+		double StartTime;
+	};
+
+	struct FrameHeader
+	{
+		uint32_t FrameIndex;
+		Codec Encoding;
+
+		/// <summary>
+		/// Microseconds since the start of the recording
+		/// </summary>
+		int64_t Timestamp;
+
+		uint32_t Size;
+		uint32_t Reserved;
+	};
+
+	struct IndexEntry
+	{
+		uint64_t Offset;
+		int64_t Timestamp;
+		uint32_t FrameIndex;
+		uint32_t Size;
+	};
+
+	struct Trailer
+	{
+		uint64_t FooterOffset;
+		uint32_t FrameCount;
+		uint32_t Reserved;
+		char Magic[8];
+	};
+
+	static_assert(sizeof(Header) == 64);
+	static_assert(sizeof(FrameHeader) == 24);
+	static_assert(sizeof(IndexEntry) == 24);
+	static_assert(sizeof(Trailer) == 24);
+
+	/// <summary>
+	/// Size and intrinsics of the recorded stream
+	/// </summary>
+	struct StreamInfo
+	{
+		uint32_t Width;
+		uint32_t Height;
+		float DepthUnits;
+		float Fx, Fy, Cx, Cy;
+	};
+
+	/// <summary>
+	/// Records frames without blocking the thread that captures them.
+	/// push copies the frame into a slot of a bounded lock free ring and returns, a writer thread encodes the
+	/// frames and writes the file in blocks of WriteBlockSize bytes at block aligned offsets. A full ring drops
+	/// the frame instead of waiting, the stats show how close the writer is to falling behind.
+	/// push must always be called from the same thread (one capture thread or the render thread).
+	/// </summary>
+	class Writer
+	{
+	public:
+		struct Stats
+		{
+			uint32_t Frames{ 0 };
+			uint32_t DroppedFrames{ 0 };
+			uint64_t RawBytes{ 0 };
+			uint64_t EncodedBytes{ 0 };
+
+			uint32_t QueuedFrames{ 0 };
+			uint32_t MaxQueuedFrames{ 0 };
+			uint32_t QueueCapacity{ 0 };
+
+			/// <summary>
+			/// Milliseconds spent encoding the last frame
+			/// </summary>
+			double EncodeTime{ 0.0 };
+
+			/// <summary>
+			/// Bytes per second written to the file, averaged over the last second
+			/// </summary>
+			double WriteThroughput{ 0.0 };
+		};
+
+		~Writer() { close(); }
+
+		/// <param name="encoding">Raw writes an indexed dump that readers can map without decoding</param>
+		/// <returns>False if the file could not be created</returns>
+		bool open(const std::filesystem::path &path, const StreamInfo &info, double startTimestamp, Codec encoding = Codec::Rvl);
+		bool isOpen() const { return m_Thread.joinable(); }
+
+		/// <summary>
+		/// Queues a frame of Width * Height depth values, never waits
+		/// </summary>
+		/// <param name="timestamp">Seconds, same clock as the start timestamp</param>
+		/// <returns>False if the queue is full and the frame was dropped</returns>
+		bool push(const uint16_t *depth, uint32_t frameIndex, double timestamp);
+
+		/// <summary>
+		/// Writes the queued frames and the index
+		/// </summary>
+		void close();
+
+		Stats getStats() const;
+
+		/// <summary>
+		/// Frames waiting for the writer before new frames are dropped, two seconds at 30 FPS
+		/// </summary>
+		static const size_t QueueFrames = 60;
+		static const size_t WriteBlockSize = 1 << 20;
+	private:
+		struct Frame
+		{
+			std::vector<uint16_t> Depth;
+			uint32_t FrameIndex;
+			int64_t Timestamp;
+		};
+
+		void run();
+		void append(const void *data, size_t size);
+
+		/// <summary>
+		/// Writes all complete blocks, or everything if final
+		/// </summary>
+		void writeBlocks(bool final);
+
+		std::ofstream m_File;
+		size_t m_PixelCount{ 0 };
+		Codec m_Encoding{ Codec::Rvl };
+		double m_StartTimestamp{ 0.0 };
+
+		std::thread m_Thread;
+		SpscRing<Frame> m_Queue;
+
+		// Incremented on every push and on close, the writer sleeps until it changes
+		std::atomic<uint32_t> m_Signal{ 0 };
+		std::atomic<bool> m_Stop{ false };
+
+		std::atomic<uint32_t> m_Frames{ 0 };
+		std::atomic<uint32_t> m_DroppedFrames{ 0 };
+		std::atomic<uint32_t> m_MaxQueuedFrames{ 0 };
+		std::atomic<uint64_t> m_RawBytes{ 0 };
+		std::atomic<uint64_t> m_EncodedBytes{ 0 };
+		std::atomic<double> m_EncodeTime{ 0.0 };
+		std::atomic<double> m_WriteThroughput{ 0.0 };
+
+		// Only used by the writer thread
+		std::vector<uint8_t> m_Block;
+		size_t m_BlockUsed{ 0 };
+		uint64_t m_WrittenBytes{ 0 };
+		std::vector<uint8_t> m_Encoded;
+		std::vector<IndexEntry> m_Index;
+		uint64_t m_ThroughputBytes{ 0 };
+		std::chrono::steady_clock::time_point m_ThroughputStart;
+	};
+
+	class Reader
+	{
+	public:
+		/// <returns>False if the file is missing or not a depth recording</returns>
+		bool open(const std::filesystem::path &path);
+
+		const Header &getHeader() const { return m_Header; }
+		uint32_t getFrameCount() const { return (uint32_t)m_Index.size(); }
+		const IndexEntry &getEntry(uint32_t frame) const { return m_Index[frame]; }
+
+		/// <summary>
+		/// Decodes a frame into Width * Height depth values
+		/// </summary>
+		bool readFrame(uint32_t frame, uint16_t *depth);
+
+		/// <returns>Number of the last frame at or before the timestamp (microseconds), 0 if there is none</returns>
+		uint32_t findFrame(int64_t timestamp) const;
+	private:
+		bool rebuildIndex(uint64_t fileSize);
+
+		std::ifstream m_File;
+		Header m_Header{ };
+		std::vector<IndexEntry> m_Index;
+		std::vector<uint8_t> m_Encoded;
+	};
+}
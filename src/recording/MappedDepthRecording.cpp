@@ -0,0 +1,118 @@
+#include "MappedDepthRecording.h"
+
+#include <cstring>
+#include <cmath>
+
+#include "RvlCodec.h"
+
+namespace DepthRecording
+{
+	bool MappedReader::open(const std::filesystem::path &path, bool sequential)
+	{
+		close();
+
+		if (!m_File.open(path, sequential) || m_File.getSize() < sizeof(Header))
+		{
+			m_File.close();
+			return false;
+		}
+
+		const uint8_t *data = m_File.getData();
+		const size_t fileSize = m_File.getSize();
+
+		mp_Header = reinterpret_cast<const Header *>(data);
+		if (std::memcmp(mp_Header->Magic, Magic, sizeof(Magic)) != 0 || mp_Header->Version != Version)
+		{
+			close();
+			return false;
+		}
+
+		if (fileSize >= sizeof(Header) + sizeof(Trailer))
+		{
+			const auto *trailer = reinterpret_cast<const Trailer *>(data + fileSize - sizeof(Trailer));
+			if (std::memcmp(trailer->Magic, IndexMagic, sizeof(IndexMagic)) == 0 &&
+				trailer->FooterOffset + (uint64_t)trailer->FrameCount * sizeof(IndexEntry) + sizeof(Trailer) == fileSize)
+			{
+				mp_Index = reinterpret_cast<const IndexEntry *>(data + trailer->FooterOffset);
+				m_FrameCount = trailer->FrameCount;
+				return true;
+			}
+		}
+
+		// No index, only complete frames count
+		const uint64_t maxSize = (uint64_t)getPixelCount() * sizeof(uint16_t);
+		uint64_t offset = sizeof(Header);
+		while (offset + sizeof(FrameHeader) <= fileSize)
+		{
+			const auto *frame = reinterpret_cast<const FrameHeader *>(data + offset);
+			if (frame->Size > maxSize || offset + sizeof(FrameHeader) + frame->Size > fileSize)
+				break;
+
+			m_RebuiltIndex.push_back({ offset, frame->Timestamp, frame->FrameIndex, frame->Size });
+			offset += sizeof(FrameHeader) + frame->Size;
+		}
+
+		mp_Index = m_RebuiltIndex.data();
+		m_FrameCount = (uint32_t)m_RebuiltIndex.size();
+		return true;
+	}
+
+	void MappedReader::close()
+	{
+		m_File.close();
+		mp_Header = nullptr;
+		mp_Index = nullptr;
+		m_FrameCount = 0;
+		m_RebuiltIndex.clear();
+	}
+
+	double MappedReader::getDuration() const
+	{
+		if (m_FrameCount == 0)
+			return 0.0;
+
+		return (mp_Index[m_FrameCount - 1].Timestamp - mp_Index[0].Timestamp) * 1e-6;
+	}
+
+	DepthView MappedReader::getFrame(uint32_t number, std::vector<uint16_t> &buffer) const
+	{
+		if (number >= m_FrameCount)
+			return {};
+
+		const auto &entry = mp_Index[number];
+		const auto *frame = reinterpret_cast<const FrameHeader *>(m_File.getData() + entry.Offset);
+		const uint8_t *payload = reinterpret_cast<const uint8_t *>(frame + 1);
+		const size_t pixelCount = getPixelCount();
+
+		DepthView view;
+		view.Number = number;
+		view.FrameIndex = entry.FrameIndex;
+		view.Timestamp = entry.Timestamp * 1e-6;
+		view.Stream = mp_Header;
+
+		if (entry.Offset + sizeof(FrameHeader) + entry.Size > m_File.getSize() || frame->Size != entry.Size)
+			return {};
+
+		// Frame offsets are always even, raw depth is used in place
+		if (frame->Encoding == Codec::Raw && frame->Size == pixelCount * sizeof(uint16_t))
+		{
+			view.Depth = reinterpret_cast<const uint16_t *>(payload);
+			return view;
+		}
+
+		buffer.resize(pixelCount);
+		if (frame->Encoding != Codec::Rvl || !RvlCodec::decode(payload, frame->Size, buffer.data(), pixelCount))
+			return {};
+
+		view.Depth = buffer.data();
+		return view;
+	}
+
+	uint32_t MappedReader::findFrame(double timestamp) const
+	{
+		const int64_t time = (int64_t)std::llround(timestamp * 1e6);
+		auto next = std::upper_bound(mp_Index, mp_Index + m_FrameCount, time,
+			[](int64_t t, const IndexEntry &entry) { return t < entry.Timestamp; });
+		return next == mp_Index ? 0 : (uint32_t)(next - mp_Index - 1);
+	}
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <execution>
+#include <filesystem>
+
+#include <utilities/MappedFile.h>
+#include "DepthRecording.h"
+
+namespace DepthRecording
+{
+	/// <summary>
+	/// One frame of a mapped recording. Depth points into the mapping for raw frames and into a decode buffer for RVL frames,
+	/// either way it is only valid as long as the reader (and the buffer) live.
+	/// </summary>
+	struct DepthView
+	{
+		const uint16_t *Depth{ nullptr };
+
+		/// <summary>
+		/// Position in the recording, the camera frame index can skip numbers where frames were dropped
+		/// </summary>
+		uint32_t Number{ 0 };
+		uint32_t FrameIndex{ 0 };
+
+		/// <summary>
+		/// Seconds since the start of the recording
+		/// </summary>
+		double Timestamp{ 0.0 };
+
+		/// <summary>
+		/// Size, depth units and intrinsics of the stream
+		/// </summary>
+		const Header *Stream{ nullptr };
+
+		explicit operator bool() const { return Depth != nullptr; }
+
+		uint16_t at(uint32_t x, uint32_t y) const { return Depth[y * Stream->Width + x]; }
+
+		/// <summary>
+		/// Pixel deprojected into the camera frame in meters, (0, 0, 0) without depth
+		/// </summary>
+		void getPoint(uint32_t x, uint32_t y, float &px, float &py, float &pz) const
+		{
+			pz = at(x, y) * Stream->DepthUnits;
+			px = ((float)x - Stream->Cx) / Stream->Fx * pz;
+			py = ((float)y - Stream->Cy) / Stream->Fy * pz;
+		}
+	};
+
+	/// <summary>
+	/// Random access to a native depth recording (see DepthRecording.h) through a memory mapping.
+	/// Nothing is read up front besides the index, recordings written with Codec::Raw are read without any copy.
+	/// All const methods can be called from several threads at once.
+	/// </summary>
+	class MappedReader
+	{
+	public:
+		/// <param name="sequential">The recording is mostly read front to back (batch jobs), the OS reads further ahead</param>
+		/// <returns>False if the file is missing or not a depth recording</returns>
+		bool open(const std::filesystem::path &path, bool sequential = false);
+		void close();
+
+		bool isOpen() const { return m_File.isOpen(); }
+		const Header &getHeader() const { return *mp_Header; }
+		uint32_t getFrameCount() const { return m_FrameCount; }
+		uint32_t getPixelCount() const { return mp_Header->Width * mp_Header->Height; }
+
+		/// <returns>Seconds between the first and the last frame</returns>
+		double getDuration() const;
+
+		/// <summary>
+		/// Gets a frame, RVL frames are decoded into the buffer which is resized as needed
+		/// </summary>
+		/// <returns>Empty view if the frame does not exist or is corrupt</returns>
+		DepthView getFrame(uint32_t number, std::vector<uint16_t> &buffer) const;
+
+		/// <returns>Number of the last frame at or before the time (seconds since the start), 0 if there is none</returns>
+		uint32_t findFrame(double timestamp) const;
+
+		/// <summary>
+		/// Calls function(const DepthView &) for every frame in [first, first + count) on all cores.
+		/// Every worker takes a block of consecutive frames, so reads stay sequential within a block.
+		/// Corrupt frames are skipped.
+		/// </summary>
+		template<typename Function>
+		void forEachFrame(Function &&function, uint32_t first = 0, uint32_t count = UINT32_MAX) const
+		{
+			if (first >= m_FrameCount)
+				return;
+
+			const uint32_t end = count > m_FrameCount - first ? m_FrameCount : first + count;
+			std::vector<uint32_t> blocks((end - first + BlockFrames - 1) / BlockFrames);
+			std::iota(blocks.begin(), blocks.end(), 0);
+
+			std::for_each(std::execution::par, blocks.begin(), blocks.end(), [&](uint32_t block)
+				{
+					std::vector<uint16_t> buffer;
+					const uint32_t blockEnd = std::min(first + (block + 1) * BlockFrames, end);
+					for (uint32_t i = first + block * BlockFrames; i < blockEnd; i++)
+					{
+						if (auto view = getFrame(i, buffer))
+							function(view);
+					}
+				});
+		}
+
+		static const uint32_t BlockFrames = 16;
+	private:
+		MappedFile m_File;
+		const Header *mp_Header{ nullptr };
+
+		// Points into the mapping, or into m_RebuiltIndex for recordings without trailer
+		const IndexEntry *mp_Index{ nullptr };
+		uint32_t m_FrameCount{ 0 };
+		std::vector<IndexEntry> m_RebuiltIndex;
+	};
+}
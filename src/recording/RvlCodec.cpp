@@ -0,0 +1,170 @@
+#include "RvlCodec.h"
+
+#include <cstring>
+
+namespace
+{
+	class NibbleWriter
+	{
+	public:
+		NibbleWriter(uint8_t *out, size_t capacity) : mp_Out(out), m_Words(capacity / 4) { }
+
+		/// <returns>False if the output is full</returns>
+		bool write(uint32_t value)
+		{
+			do
+			{
+				uint32_t nibble = value & 7;
+				value >>= 3;
+				if (value)
+					nibble |= 8;
+
+				m_Word = (m_Word << 4) | nibble;
+				if (++m_Nibbles == 8 && !flush())
+					return false;
+			} while (value);
+
+			return true;
+		}
+
+		/// <returns>Bytes written, 0 if the output was too small</returns>
+		size_t finish()
+		{
+			if (m_Nibbles > 0)
+			{
+				m_Word <<= 4 * (8 - m_Nibbles);
+				if (!flush())
+					return 0;
+			}
+			return m_Written * 4;
+		}
+
+	private:
+		bool flush()
+		{
+			if (m_Written == m_Words)
+				return false;
+
+			std::memcpy(mp_Out + m_Written * 4, &m_Word, 4);
+			m_Written++;
+			m_Word = 0;
+			m_Nibbles = 0;
+			return true;
+		}
+
+		uint8_t *mp_Out;
+		size_t m_Words;
+		size_t m_Written{ 0 };
+		uint32_t m_Word{ 0 };
+		int m_Nibbles{ 0 };
+	};
+
+	class NibbleReader
+	{
+	public:
+		NibbleReader(const uint8_t *data, size_t size) : mp_Data(data), m_Words(size / 4) { }
+
+		/// <returns>False if the data ends inside the value</returns>
+		bool read(uint32_t &value)
+		{
+			value = 0;
+			for (int shift = 0; shift < 32; shift += 3)
+			{
+				if (m_Nibbles == 0)
+				{
+					if (m_Read == m_Words)
+						return false;
+
+					std::memcpy(&m_Word, mp_Data + m_Read * 4, 4);
+					m_Read++;
+					m_Nibbles = 8;
+				}
+
+				uint32_t nibble = m_Word >> 28;
+				m_Word <<= 4;
+				m_Nibbles--;
+
+				value |= (nibble & 7) << shift;
+				if (!(nibble & 8))
+					return true;
+			}
+			return false;
+		}
+
+	private:
+		const uint8_t *mp_Data;
+		size_t m_Words;
+		size_t m_Read{ 0 };
+		uint32_t m_Word{ 0 };
+		int m_Nibbles{ 0 };
+	};
+}
+
+namespace RvlCodec
+{
+	size_t encode(const uint16_t *depth, size_t count, uint8_t *out, size_t capacity)
+	{
+		NibbleWriter writer(out, capacity);
+		const uint16_t *end = depth + count;
+		int32_t previous = 0;
+
+		while (depth != end)
+		{
+			const uint16_t *start = depth;
+			while (depth != end && *depth == 0)
+				depth++;
+			if (!writer.write((uint32_t)(depth - start)))
+				return 0;
+
+			start = depth;
+			while (depth != end && *depth != 0)
+				depth++;
+			if (!writer.write((uint32_t)(depth - start)))
+				return 0;
+
+			for (const uint16_t *p = start; p != depth; p++)
+			{
+				int32_t delta = (int32_t)*p - previous;
+				previous = *p;
+
+				// Zigzag, small differences of either sign become small numbers
+				if (!writer.write(((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31)))
+					return 0;
+			}
+		}
+
+		return writer.finish();
+	}
+
+	bool decode(const uint8_t *data, size_t size, uint16_t *depth, size_t count)
+	{
+		NibbleReader reader(data, size);
+		uint16_t *end = depth + count;
+		int32_t previous = 0;
+
+		while (depth != end)
+		{
+			uint32_t zeros, valid;
+			if (!reader.read(zeros) || zeros > (size_t)(end - depth))
+				return false;
+
+			std::memset(depth, 0, zeros * sizeof(uint16_t));
+			depth += zeros;
+
+			if (!reader.read(valid) || valid > (size_t)(end - depth))
+				return false;
+
+			for (uint32_t i = 0; i < valid; i++)
+			{
+				uint32_t zigzag;
+				if (!reader.read(zigzag))
+					return false;
+
+				previous += (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+				*depth++ = (uint16_t)previous;
+			}
+		}
+
+		return true;
+	}
+}
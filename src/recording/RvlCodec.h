@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// Lossless run length / variable length codec for depth images (Wilson, "Fast Lossless Depth Image Compression", 2017).
+/// The image alternates between runs of invalid (zero) pixels and runs of valid pixels, valid pixels are stored as
+/// the zigzag encoded difference to the previous valid pixel. All counts and differences are written as 3 bit groups
+/// with a continuation bit, eight nibbles per 32 bit word. Depth images with smooth surfaces shrink to a quarter or less.
+/// </summary>
+namespace RvlCodec
+{
+	/// <summary>
+	/// Encodes count pixels
+	/// </summary>
+	/// <param name="capacity">Size of out in bytes, a multiple of 4</param>
+	/// <returns>Bytes written to out, 0 if the encoding does not fit (noisy images can exceed the raw size)</returns>
+	size_t encode(const uint16_t *depth, size_t count, uint8_t *out, size_t capacity);
+
+	/// <summary>
+	/// Decodes count pixels
+	/// </summary>
+	/// <returns>False if the data ends early or describes more than count pixels</returns>
+	bool decode(const uint8_t *data, size_t size, uint16_t *depth, size_t count);
+}
@@ -0,0 +1,297 @@
+#include "SessionCatalog.h"
+
+#include <fstream>
+#include <algorithm>
+#include <execution>
+#include <unordered_map>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+	const char CatalogMagic[8] = { 'F', 'E', 'S', 'D', 'C', 'A', 'T', 'L' };
+
+	void appendString(std::string &strings, const std::string &value, uint32_t (&reference)[2])
+	{
+		reference[0] = (uint32_t)strings.size();
+		reference[1] = (uint32_t)value.size();
+		strings += value;
+	}
+
+	bool readString(const std::string &strings, const uint32_t (&reference)[2], std::string &value)
+	{
+		if ((uint64_t)reference[0] + reference[1] > strings.size())
+			return false;
+		value.assign(strings, reference[0], reference[1]);
+		return true;
+	}
+}
+
+SessionCatalog::SessionCatalog(Logger::Logger *logger, const std::filesystem::path &directory, std::vector<std::string> cameraTypes)
+	: mp_Logger(logger), m_Directory(directory), m_CameraTypes(std::move(cameraTypes))
+{
+	if (!read())
+		m_Sessions.clear();
+}
+
+bool SessionCatalog::refresh()
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	std::unordered_map<std::string, size_t> known;
+	for (size_t i = 0; i < m_Sessions.size(); i++)
+		known[m_Sessions[i].FileName] = i;
+
+	// Only the directory listing is read for unchanged sessions
+	std::vector<Session> sessions;
+	std::vector<size_t> changed;
+	std::vector<std::filesystem::file_time_type> modified;
+	size_t found = 0;
+	std::error_code error;
+	for (const auto &entry : std::filesystem::directory_iterator(m_Directory, error))
+	{
+		if (!entry.is_regular_file() || entry.path().extension() != ".json")
+			continue;
+
+		auto fileName = entry.path().filename().string();
+		auto lastWrite = entry.last_write_time();
+		int64_t modifiedTime = lastWrite.time_since_epoch().count();
+		uint64_t fileSize = entry.file_size();
+
+		auto it = known.find(fileName);
+		found += it != known.end();
+		if (it != known.end() && m_Sessions[it->second].ModifiedTime == modifiedTime && m_Sessions[it->second].FileSize == fileSize)
+		{
+			sessions.push_back(std::move(m_Sessions[it->second]));
+			continue;
+		}
+
+		Session &session = sessions.emplace_back();
+		session.FileName = std::move(fileName);
+		session.ModifiedTime = modifiedTime;
+		session.FileSize = fileSize;
+		changed.push_back(sessions.size() - 1);
+		modified.push_back(lastWrite);
+	}
+
+	if (error)
+	{
+		mp_Logger->log("Could not read '" + m_Directory.generic_string() + "': " + error.message(), Logger::LogLevel::ERR);
+		return false;
+	}
+
+	std::vector<std::string> errors(changed.size());
+	std::vector<uint32_t> indices(changed.size());
+	std::iota(indices.begin(), indices.end(), 0);
+	std::for_each(std::execution::par, indices.begin(), indices.end(), [&](uint32_t i)
+		{
+			errors[i] = parse(sessions[changed[i]], modified[i]);
+		});
+
+	for (uint32_t i = 0; i < changed.size(); i++)
+	{
+		if (!errors[i].empty())
+			mp_Logger->log(sessions[changed[i]].FileName + ": " + errors[i], Logger::LogLevel::ERR);
+	}
+
+	size_t removed = m_Sessions.size() - found;
+	m_Sessions = std::move(sessions);
+
+	if ((!changed.empty() || removed > 0) && !write())
+		mp_Logger->log("Could not write the session catalog to '" + (m_Directory / CatalogFileName).generic_string() + "'", Logger::LogLevel::WARNING);
+
+	std::chrono::duration<double, std::milli> refreshTime = std::chrono::high_resolution_clock::now() - start;
+	mp_Logger->log("Session catalog: " + std::to_string(m_Sessions.size()) + " sessions, " + std::to_string(changed.size()) + " parsed, " +
+		std::to_string(removed) + " removed in " + std::to_string(refreshTime.count()) + "ms");
+	return true;
+}
+
+std::string SessionCatalog::parse(Session &session, std::filesystem::file_time_type modified) const
+{
+	std::ifstream configJson(m_Directory / session.FileName);
+	Json::Value root;
+	Json::CharReaderBuilder builder;
+	JSONCPP_STRING errs;
+
+	if (!parseFromStream(builder, configJson, &root, &errs))
+		return errs;
+
+	session.Name = root["Name"].asString();
+	session.Duration = root["DurationInSec"].asDouble();
+	session.RecordedFrames = root["RecordedFrames"].asInt();
+	for (const auto &camera : root["Cameras"])
+		session.CameraTypes.push_back(camera["Type"].asString());
+
+	// Older session files have no start time, they were written when the recording stopped
+	if (root.isMember("StartTime"))
+		session.StartTime = root["StartTime"].asInt64();
+	else
+	{
+		auto end = std::chrono::file_clock::to_sys(modified);
+		session.StartTime = std::chrono::duration_cast<std::chrono::seconds>(end.time_since_epoch()).count() - (int64_t)session.Duration;
+	}
+
+	session.IsValid = true;
+	updateCameraMask(session);
+	return "";
+}
+
+void SessionCatalog::updateCameraMask(Session &session) const
+{
+	session.CameraMask = 0;
+	for (const auto &type : session.CameraTypes)
+	{
+		auto it = std::find(m_CameraTypes.begin(), m_CameraTypes.end(), type);
+		session.CameraMask |= it == m_CameraTypes.end() ? UnknownCamera : 1u << (it - m_CameraTypes.begin());
+	}
+}
+
+std::vector<uint32_t> SessionCatalog::query(const Filter &filter, SortKey key, bool descending) const
+{
+	std::vector<uint32_t> result;
+	for (uint32_t i = 0; i < m_Sessions.size(); i++)
+	{
+		const auto &session = m_Sessions[i];
+		if (!session.IsValid || (session.CameraMask & filter.Cameras) != filter.Cameras || session.Duration < filter.MinDuration || session.StartTime < filter.After)
+			continue;
+		if (!filter.Name.empty() && session.Name.find(filter.Name) == std::string::npos)
+			continue;
+		result.push_back(i);
+	}
+
+	auto less = [&](uint32_t a, uint32_t b)
+		{
+			const auto &first = m_Sessions[a], &second = m_Sessions[b];
+			switch (key)
+			{
+			case SortKey::Duration:
+				return first.Duration < second.Duration;
+			case SortKey::Name:
+				return first.Name < second.Name;
+			default:
+				return first.StartTime < second.StartTime;
+			}
+		};
+
+	if (descending)
+		std::stable_sort(result.begin(), result.end(), [&](uint32_t a, uint32_t b) { return less(b, a); });
+	else
+		std::stable_sort(result.begin(), result.end(), less);
+	return result;
+}
+
+bool SessionCatalog::load(const Session &session, Json::Value &root) const
+{
+	std::ifstream configJson(m_Directory / session.FileName);
+	Json::CharReaderBuilder builder;
+	JSONCPP_STRING errs;
+
+	if (!parseFromStream(builder, configJson, &root, &errs))
+	{
+		mp_Logger->log(session.FileName + ": " + errs, Logger::LogLevel::ERR);
+		return false;
+	}
+	return true;
+}
+
+bool SessionCatalog::read()
+{
+	std::ifstream file(m_Directory / CatalogFileName, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+		return false;
+
+	const uint64_t fileSize = (uint64_t)file.tellg();
+	file.seekg(0);
+
+	Header header;
+	file.read(reinterpret_cast<char *>(&header), sizeof(header));
+	if (!file.good() || std::memcmp(header.Magic, CatalogMagic, sizeof(CatalogMagic)) != 0 || header.Version != Version)
+		return false;
+
+	// A damaged header must not allocate more than the file holds, the catalog is rebuilt instead
+	const uint64_t entryBytes = (uint64_t)header.EntryCount * sizeof(Entry);
+	if (header.StringBytes > fileSize || sizeof(Header) + entryBytes + header.StringBytes > fileSize)
+		return false;
+
+	std::vector<Entry> entries(header.EntryCount);
+	std::string strings(header.StringBytes, '\0');
+	file.read(reinterpret_cast<char *>(entries.data()), entries.size() * sizeof(Entry));
+	file.read(strings.data(), strings.size());
+	if (!file.good())
+		return false;
+
+	m_Sessions.resize(entries.size());
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const auto &entry = entries[i];
+		auto &session = m_Sessions[i];
+		std::string cameraTypes;
+		if (!readString(strings, entry.FileName, session.FileName) || !readString(strings, entry.Name, session.Name) || !readString(strings, entry.CameraTypes, cameraTypes))
+			return false;
+
+		for (size_t begin = 0; begin < cameraTypes.size();)
+		{
+			size_t end = std::min(cameraTypes.find('\n', begin), cameraTypes.size());
+			session.CameraTypes.push_back(cameraTypes.substr(begin, end - begin));
+			begin = end + 1;
+		}
+
+		session.ModifiedTime = entry.ModifiedTime;
+		session.FileSize = entry.FileSize;
+		session.StartTime = entry.StartTime;
+		session.Duration = entry.Duration;
+		session.RecordedFrames = entry.RecordedFrames;
+		session.IsValid = entry.IsValid != 0;
+		updateCameraMask(session);
+	}
+	return true;
+}
+
+bool SessionCatalog::write() const
+{
+	std::vector<Entry> entries(m_Sessions.size());
+	std::string strings;
+	for (size_t i = 0; i < m_Sessions.size(); i++)
+	{
+		const auto &session = m_Sessions[i];
+		auto &entry = entries[i];
+
+		std::string cameraTypes;
+		for (const auto &type : session.CameraTypes)
+			cameraTypes += (cameraTypes.empty() ? "" : "\n") + type;
+
+		appendString(strings, session.FileName, entry.FileName);
+		appendString(strings, session.Name, entry.Name);
+		appendString(strings, cameraTypes, entry.CameraTypes);
+		entry.ModifiedTime = session.ModifiedTime;
+		entry.FileSize = session.FileSize;
+		entry.StartTime = session.StartTime;
+		entry.Duration = session.Duration;
+		entry.RecordedFrames = session.RecordedFrames;
+		entry.IsValid = session.IsValid;
+	}
+
+	Header header{};
+	std::memcpy(header.Magic, CatalogMagic, sizeof(CatalogMagic));
+	header.Version = Version;
+	header.EntryCount = (uint32_t)entries.size();
+	header.StringBytes = strings.size();
+
+	// Written next to the old catalog and swapped in, a crash never leaves a half written catalog behind
+	auto path = m_Directory / CatalogFileName;
+	auto temporary = path;
+	temporary += ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(Entry));
+		file.write(strings.data(), strings.size());
+		if (!file.good())
+			return false;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporary, path, error);
+	return !error;
+}
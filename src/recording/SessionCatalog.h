@@ -0,0 +1,153 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <json/json.h>
+
+#include <obj/Logger.h>
+
+/// <summary>
+/// Summary of every session file in the recording directory, kept in a flat binary index next to the sessions
+/// (CatalogFileName) so a refresh only parses the session files that are new or changed since the last one.
+/// Sessions are matched by file name, modification time and size.
+///
+/// Catalog file layout (little endian):
+///   Header   32 bytes            "FESDCATL", version, entry count, string bytes, 0
+///   Entries  entry count * 64    see Entry
+///   Strings  string bytes        file names, session names and camera types the entries point into
+/// A catalog that can not be read is rebuilt from the session files.
+/// </summary>
+class SessionCatalog
+{
+public:
+	static const uint32_t Version = 1;
+	static constexpr const char *CatalogFileName = "sessions.fesdcat";
+
+	/// <summary>
+	/// Set in CameraMask for a camera type that is not one of the known types
+	/// </summary>
+	static const uint32_t UnknownCamera = 1u << 31;
+
+	struct Session
+	{
+		std::string FileName;
+		std::string Name;
+
+		/// <summary>
+		/// Type of every camera in the order of the session file
+		/// </summary>
+		std::vector<std::string> CameraTypes;
+
+		/// <summary>
+		/// Bit i is set if the session has a camera of known type i
+		/// </summary>
+		uint32_t CameraMask{ 0 };
+
+		/// <summary>
+		/// Unix time (seconds) the recording started, sessions without it in their file use the modification time minus the duration
+		/// </summary>
+		int64_t StartTime{ 0 };
+		double Duration{ 0.0 };
+		int32_t RecordedFrames{ 0 };
+
+		/// <summary>
+		/// False if the session file could not be parsed, it is parsed again once it changes
+		/// </summary>
+		bool IsValid{ false };
+
+		int64_t ModifiedTime{ 0 };
+		uint64_t FileSize{ 0 };
+	};
+
+	enum class SortKey
+	{
+		Date,
+		Duration,
+		Name
+	};
+
+	struct Filter
+	{
+		/// <summary>
+		/// Part of the session name, case sensitive
+		/// </summary>
+		std::string Name;
+
+		/// <summary>
+		/// Camera types (CameraMask bits) a session must have
+		/// </summary>
+		uint32_t Cameras{ 0 };
+
+		double MinDuration{ 0.0 };
+
+		/// <summary>
+		/// Earliest start time (unix seconds), 0 for any
+		/// </summary>
+		int64_t After{ 0 };
+	};
+
+	/// <param name="cameraTypes">Known camera types in the order of the CameraMask bits</param>
+	SessionCatalog(Logger::Logger *logger, const std::filesystem::path &directory, std::vector<std::string> cameraTypes);
+
+	/// <summary>
+	/// Updates the catalog from the session files in the directory and saves it if anything changed
+	/// </summary>
+	/// <returns>False if the directory can not be read</returns>
+	bool refresh();
+
+	const std::vector<Session> &getSessions() const { return m_Sessions; }
+	const std::filesystem::path &getDirectory() const { return m_Directory; }
+	const std::vector<std::string> &getCameraTypes() const { return m_CameraTypes; }
+
+	/// <returns>Indices of the valid sessions that pass the filter in sort order</returns>
+	std::vector<uint32_t> query(const Filter &filter, SortKey key, bool descending) const;
+
+	/// <summary>
+	/// Parses the full session file, for the camera file names
+	/// </summary>
+	bool load(const Session &session, Json::Value &root) const;
+private:
+	struct Header
+	{
+		char Magic[8];
+		uint32_t Version;
+		uint32_t EntryCount;
+		uint64_t StringBytes;
+		uint64_t Reserved;
+	};
+	static_assert(sizeof(Header) == 32);
+
+	/// <summary>
+	/// Strings are (offset, length) in the string block, camera types are separated by '\n'
+	/// </summary>
+	struct Entry
+	{
+		int64_t ModifiedTime;
+		uint64_t FileSize;
+		int64_t StartTime;
+		double Duration;
+		int32_t RecordedFrames;
+		uint32_t IsValid;
+		uint32_t FileName[2];
+		uint32_t Name[2];
+		uint32_t CameraTypes[2];
+	};
+	static_assert(sizeof(Entry) == 64);
+
+	bool read();
+	bool write() const;
+
+	/// <summary>
+	/// Fills the summary of a session from its file, thread safe
+	/// </summary>
+	/// <returns>Parse error, empty on success</returns>
+	std::string parse(Session &session, std::filesystem::file_time_type modified) const;
+
+	void updateCameraMask(Session &session) const;
+
+	Logger::Logger *mp_Logger;
+	std::filesystem::path m_Directory;
+	std::vector<std::string> m_CameraTypes;
+	std::vector<Session> m_Sessions;
+};
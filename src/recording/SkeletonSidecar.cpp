@@ -0,0 +1,283 @@
+#include "SkeletonSidecar.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace SkeletonSidecar
+{
+	bool Writer::open(const std::filesystem::path &path)
+	{
+		close();
+
+		m_File.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!m_File.is_open())
+			return false;
+
+		m_Chunk.clear();
+		m_Chunk.reserve(2 * ChunkRecords);
+		m_FrameIndices.clear();
+		m_DroppedRecords = 0;
+
+		Header header{};
+		std::memcpy(header.Magic, Magic, sizeof(Magic));
+		header.Version = Version;
+		header.JointCount = Skeleton::JointCount;
+		header.RecordSize = sizeof(SkeletonRecord);
+		header.ChunkRecords = ChunkRecords;
+		header.StartTime = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+		m_File.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		return m_File.good();
+	}
+
+	bool Writer::append(uint32_t frameIndex, double timestamp, const Plane *floor)
+	{
+		if (!isOpen())
+			return false;
+
+		// Readers search the records by frame and by time, both have to increase
+		if (!m_FrameIndices.empty() && (frameIndex <= m_FrameIndices.back() || timestamp <= m_Chunk.back().Timestamp))
+		{
+			m_DroppedRecords++;
+			return false;
+		}
+
+		SkeletonRecord record{};
+		record.FrameIndex = frameIndex;
+		record.Timestamp = timestamp;
+
+		if (floor)
+		{
+			record.Flags |= HasFloor;
+			auto normal = floor->getNormal();
+			record.Floor[0] = normal.x;
+			record.Floor[1] = normal.y;
+			record.Floor[2] = normal.z;
+			record.Floor[3] = -glm::dot(normal, floor->getPoint());
+		}
+
+		m_Chunk.push_back(record);
+		m_FrameIndices.push_back(frameIndex);
+
+		if (m_Chunk.size() == 2 * ChunkRecords)
+			writeChunk(ChunkRecords);
+		return true;
+	}
+
+	bool Writer::setSkeleton(uint32_t frameIndex, const Skeleton &skeleton)
+	{
+		if (!isOpen())
+			return false;
+
+		auto frame = std::lower_bound(m_FrameIndices.begin(), m_FrameIndices.end(), frameIndex);
+		if (frame == m_FrameIndices.end() || *frame != frameIndex)
+			return false;
+
+		size_t written = m_FrameIndices.size() - m_Chunk.size();
+		size_t index = (size_t)(frame - m_FrameIndices.begin());
+		if (index < written)
+			return false;
+
+		SkeletonRecord &record = m_Chunk[index - written];
+		record.Flags |= HasSkeleton;
+		for (int j = 0; j < Skeleton::JointCount; j++)
+		{
+			record.Joints[j][0] = skeleton.Joints[j].x;
+			record.Joints[j][1] = skeleton.Joints[j].y;
+			record.Joints[j][2] = skeleton.Joints[j].z;
+			record.Confidence[j] = skeleton.Confidence[j];
+		}
+		return true;
+	}
+
+	void Writer::writeChunk(size_t count)
+	{
+		m_File.write(reinterpret_cast<const char *>(m_Chunk.data()), count * sizeof(SkeletonRecord));
+		m_File.flush();
+		m_Chunk.erase(m_Chunk.begin(), m_Chunk.begin() + count);
+	}
+
+	void Writer::close()
+	{
+		if (!isOpen())
+			return;
+
+		writeChunk(m_Chunk.size());
+
+		Trailer trailer{};
+		trailer.FooterOffset = (uint64_t)m_File.tellp();
+		trailer.RecordCount = (uint32_t)m_FrameIndices.size();
+		std::memcpy(trailer.Magic, IndexMagic, sizeof(IndexMagic));
+
+		uint32_t firstFrame = 0;
+		std::vector<uint32_t> recordByFrame;
+		if (!m_FrameIndices.empty())
+		{
+			firstFrame = m_FrameIndices.front();
+			recordByFrame.assign(m_FrameIndices.back() - firstFrame + 1, NoRecord);
+
+			for (uint32_t r = 0; r < m_FrameIndices.size(); r++)
+				recordByFrame[m_FrameIndices[r] - firstFrame] = r;
+		}
+
+		uint32_t frameCount = (uint32_t)recordByFrame.size();
+		m_File.write(reinterpret_cast<const char *>(&firstFrame), sizeof(firstFrame));
+		m_File.write(reinterpret_cast<const char *>(&frameCount), sizeof(frameCount));
+		m_File.write(reinterpret_cast<const char *>(recordByFrame.data()), recordByFrame.size() * sizeof(uint32_t));
+		m_File.write(reinterpret_cast<const char *>(&trailer), sizeof(trailer));
+
+		m_File.close();
+	}
+
+	bool Reader::open(const std::filesystem::path &path)
+	{
+		m_File.close();
+		m_File.clear();
+		m_File.open(path, std::ios::in | std::ios::binary);
+		if (!m_File.is_open())
+			return false;
+
+		m_File.seekg(0, std::ios::end);
+		uint64_t fileSize = (uint64_t)m_File.tellg();
+		m_File.seekg(0);
+
+		if (fileSize < sizeof(Header))
+			return false;
+
+		m_File.read(reinterpret_cast<char *>(&m_Header), sizeof(Header));
+		if (std::memcmp(m_Header.Magic, Magic, sizeof(Magic)) != 0 || m_Header.Version != Version ||
+			m_Header.RecordSize != sizeof(SkeletonRecord) || m_Header.JointCount != Skeleton::JointCount)
+			return false;
+
+		Trailer trailer{};
+		if (fileSize >= sizeof(Header) + sizeof(Trailer))
+		{
+			m_File.seekg(fileSize - sizeof(Trailer));
+			m_File.read(reinterpret_cast<char *>(&trailer), sizeof(Trailer));
+		}
+
+		m_RecordByFrame.clear();
+		m_FirstFrame = 0;
+
+		// The footer has to sit right behind the records and end at the trailer
+		const uint64_t footerOffset = sizeof(Header) + (uint64_t)trailer.RecordCount * sizeof(SkeletonRecord);
+		if (std::memcmp(trailer.Magic, IndexMagic, sizeof(IndexMagic)) == 0 && trailer.FooterOffset == footerOffset &&
+			footerOffset + 2 * sizeof(uint32_t) + sizeof(Trailer) <= fileSize)
+		{
+			uint32_t frameCount = 0;
+			m_File.seekg(trailer.FooterOffset);
+			m_File.read(reinterpret_cast<char *>(&m_FirstFrame), sizeof(m_FirstFrame));
+			m_File.read(reinterpret_cast<char *>(&frameCount), sizeof(frameCount));
+
+			if (m_File.good() && footerOffset + 2 * sizeof(uint32_t) + (uint64_t)frameCount * sizeof(uint32_t) + sizeof(Trailer) == fileSize)
+			{
+				m_RecordCount = trailer.RecordCount;
+				m_RecordByFrame.resize(frameCount);
+				m_File.read(reinterpret_cast<char *>(m_RecordByFrame.data()), frameCount * sizeof(uint32_t));
+				return m_File.good();
+			}
+		}
+
+		return rebuildIndex(fileSize);
+	}
+
+	bool Reader::rebuildIndex(uint64_t fileSize)
+	{
+		// No index, only complete records count
+		m_RecordCount = (uint32_t)((fileSize - sizeof(Header)) / sizeof(SkeletonRecord));
+		m_FirstFrame = 0;
+
+		std::vector<uint32_t> frameIndices;
+		SkeletonRecord record;
+		double lastTimestamp = 0.0;
+		for (uint32_t r = 0; r < m_RecordCount; r++)
+		{
+			if (!readRecord(r, record))
+				return false;
+
+			// Records are written in frame and time order, anything else is the footer of a damaged file or garbage
+			if (r > 0 && (record.FrameIndex <= frameIndices.back() || record.Timestamp <= lastTimestamp))
+				break;
+			frameIndices.push_back(record.FrameIndex);
+			lastTimestamp = record.Timestamp;
+		}
+		m_RecordCount = (uint32_t)frameIndices.size();
+
+		m_RecordByFrame.clear();
+		if (m_RecordCount > 0)
+		{
+			m_FirstFrame = frameIndices.front();
+			m_RecordByFrame.assign(frameIndices.back() - m_FirstFrame + 1, NoRecord);
+			for (uint32_t r = 0; r < m_RecordCount; r++)
+				m_RecordByFrame[frameIndices[r] - m_FirstFrame] = r;
+		}
+
+		return true;
+	}
+
+	bool Reader::readRecord(uint32_t record, SkeletonRecord &out)
+	{
+		if (record >= m_RecordCount)
+			return false;
+
+		m_File.clear();
+		m_File.seekg(sizeof(Header) + (uint64_t)record * sizeof(SkeletonRecord));
+		m_File.read(reinterpret_cast<char *>(&out), sizeof(SkeletonRecord));
+		return m_File.good();
+	}
+
+	bool Reader::readFrame(uint32_t frameIndex, SkeletonRecord &out)
+	{
+		if (frameIndex < m_FirstFrame || frameIndex - m_FirstFrame >= m_RecordByFrame.size())
+			return false;
+
+		uint32_t record = m_RecordByFrame[frameIndex - m_FirstFrame];
+		return record != NoRecord && readRecord(record, out);
+	}
+
+	bool Reader::readClosest(double timestamp, SkeletonRecord &out)
+	{
+		if (m_RecordCount == 0)
+			return false;
+
+		// First record at or after the timestamp
+		uint32_t low = 0, high = m_RecordCount - 1;
+		while (low < high)
+		{
+			uint32_t middle = (low + high) / 2;
+			if (!readRecord(middle, out))
+				return false;
+
+			if (out.Timestamp < timestamp)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+
+		if (!readRecord(low, out))
+			return false;
+
+		if (low > 0)
+		{
+			SkeletonRecord previous;
+			if (readRecord(low - 1, previous) && timestamp - previous.Timestamp < out.Timestamp - timestamp)
+				out = previous;
+		}
+
+		return true;
+	}
+
+	Skeleton Reader::toSkeleton(const SkeletonRecord &record)
+	{
+		Skeleton skeleton;
+		skeleton.Timestamp = record.Timestamp;
+		skeleton.FrameIndex = record.FrameIndex;
+		for (int j = 0; j < Skeleton::JointCount; j++)
+		{
+			skeleton.Joints[j] = { record.Joints[j][0], record.Joints[j][1], record.Joints[j][2] };
+			skeleton.Confidence[j] = record.Confidence[j];
+		}
+		return skeleton;
+	}
+}
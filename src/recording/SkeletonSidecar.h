@@ -0,0 +1,161 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <atomic>
+
+#include <skeleton/Skeleton.h>
+#include <obj/Plane.h>
+
+/// <summary>
+/// Binary file next to a depth recording holding the skeletons (and floor) of its frames.
+///
+/// Layout, all little endian:
+///   Header   32 bytes       "FESDSKEL", version, joint count, record size, chunk size, start time (unix seconds, double)
+///   Records  n * 160 bytes  SkeletonRecord, one per recorded frame in frame order, appended chunk by chunk
+///   Footer                  first frame index, frame count, record number per frame (0xFFFFFFFF if none)
+///   Trailer  24 bytes       footer offset (uint64), record count, 0, "FESDIDX\0"
+///
+/// Frames are numbered and timed by the camera, counted from the first recorded frame, the same numbering the
+/// native depth recording uses. The footer maps a frame index to its record, so any frame is one seek away.
+/// A file without a valid trailer (the recording did not stop cleanly) is still readable, the index is rebuilt from the records.
+/// </summary>
+namespace SkeletonSidecar
+{
+	static const char Magic[8] = { 'F', 'E', 'S', 'D', 'S', 'K', 'E', 'L' };
+	static const char IndexMagic[8] = { 'F', 'E', 'S', 'D', 'I', 'D', 'X', '\0' };
+	static const uint32_t Version = 2;
+	static const uint32_t NoRecord = 0xFFFFFFFF;
+
+	enum Flags : uint32_t
+	{
+		HasSkeleton = 1 << 0,
+		HasFloor = 1 << 1
+	};
+
+	struct Header
+	{
+		char Magic[8];
+		uint32_t Version;
+		uint32_t JointCount;
+		uint32_t RecordSize;
+		uint32_t ChunkRecords;
+		double StartTime;
+	};
+
+	struct SkeletonRecord
+	{
+		uint32_t FrameIndex;
+		uint32_t Flags;
+
+		/// <summary>
+		/// Seconds since the first recorded frame, device clock
+		/// </summary>
+		double Timestamp;
+
+		float Joints[Skeleton::JointCount][3];
+		float Confidence[Skeleton::JointCount];
+
+		/// <summary>
+		/// Floor plane n * p + d = 0 as (n.x, n.y, n.z, d)
+		/// </summary>
+		float Floor[4];
+	};
+
+	struct Trailer
+	{
+		uint64_t FooterOffset;
+		uint32_t RecordCount;
+		uint32_t Reserved;
+		char Magic[8];
+	};
+
+	static_assert(sizeof(Header) == 32);
+	static_assert(sizeof(SkeletonRecord) == 160);
+	static_assert(sizeof(Trailer) == 24);
+
+	class Writer
+	{
+	public:
+		~Writer() { close(); }
+
+		/// <returns>False if the file could not be created</returns>
+		bool open(const std::filesystem::path &path);
+		bool isOpen() const { return m_File.is_open(); }
+
+		/// <summary>
+		/// Adds the record of a recorded frame, frame index and timestamp have to increase from frame to frame
+		/// </summary>
+		/// <param name="timestamp">Seconds since the first recorded frame, device clock</param>
+		/// <returns>False if the frame is not newer than the last one and was dropped</returns>
+		bool append(uint32_t frameIndex, double timestamp, const Plane *floor);
+
+		/// <summary>
+		/// Fills in the skeleton of an appended frame, skeletons are detected a few frames after their frame
+		/// </summary>
+		/// <returns>False if the frame was not appended or is already written</returns>
+		bool setSkeleton(uint32_t frameIndex, const Skeleton &skeleton);
+
+		/// <summary>
+		/// Writes the remaining records and the index
+		/// </summary>
+		void close();
+
+		uint32_t getRecordCount() const { return (uint32_t)m_FrameIndices.size(); }
+		/// <returns>Frames dropped because they were not newer than the last one, safe to call from any thread</returns>
+		uint32_t getDroppedCount() const { return m_DroppedRecords; }
+
+		/// <summary>
+		/// Records are written in chunks, the newest chunk is held back so late skeletons still find their frame
+		/// </summary>
+		static const uint32_t ChunkRecords = 256;
+	private:
+		/// <summary>
+		/// Writes the oldest records that are not written yet
+		/// </summary>
+		void writeChunk(size_t count);
+
+		std::ofstream m_File;
+
+		// Appended but not written, the last records of the file
+		std::vector<SkeletonRecord> m_Chunk;
+		std::vector<uint32_t> m_FrameIndices;
+		std::atomic<uint32_t> m_DroppedRecords{ 0 };
+	};
+
+	class Reader
+	{
+	public:
+		/// <returns>False if the file is missing or not a sidecar</returns>
+		bool open(const std::filesystem::path &path);
+
+		const Header &getHeader() const { return m_Header; }
+		uint32_t getRecordCount() const { return m_RecordCount; }
+
+		bool readRecord(uint32_t record, SkeletonRecord &out);
+
+		/// <returns>False if the frame has no record</returns>
+		bool readFrame(uint32_t frameIndex, SkeletonRecord &out);
+
+		/// <summary>
+		/// Binary search over the record timestamps
+		/// </summary>
+		/// <returns>False if there are no records</returns>
+		bool readClosest(double timestamp, SkeletonRecord &out);
+
+		static Skeleton toSkeleton(const SkeletonRecord &record);
+	private:
+		/// <summary>
+		/// Indexes the records up to the first one that is not newer than the one before
+		/// </summary>
+		bool rebuildIndex(uint64_t fileSize);
+
+		std::ifstream m_File;
+		Header m_Header{ };
+		uint32_t m_RecordCount{ 0 };
+
+		uint32_t m_FirstFrame{ 0 };
+		std::vector<uint32_t> m_RecordByFrame;
+	};
+}
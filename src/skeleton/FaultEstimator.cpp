@@ -0,0 +1,366 @@
+#include "FaultEstimator.h"
+
+#include <fstream>
+#include <cstring>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <imgui.h>
+
+#include <utilities/helper/ImGuiHelper.h>
+
+namespace
+{
+	const char Magic[8] = { 'F', 'E', 'S', 'D', 'M', 'L', 'P', '\0' };
+	const uint32_t Version = 1;
+
+	template<typename T>
+	bool readValues(std::ifstream &file, T *values, size_t count)
+	{
+		file.read(reinterpret_cast<char *>(values), count * sizeof(T));
+		return file.good();
+	}
+}
+
+bool FaultEstimator::load(const std::filesystem::path &path)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Error.clear();
+	m_History.clear();
+
+	if (read(path))
+		return true;
+
+	m_Layers.clear();
+	m_FrameCount = 0;
+	return false;
+}
+
+void FaultEstimator::unload()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Layers.clear();
+	m_History.clear();
+	m_FrameCount = 0;
+}
+
+bool FaultEstimator::isLoaded() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return !m_Layers.empty();
+}
+
+bool FaultEstimator::read(const std::filesystem::path &path)
+{
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	if (!file.is_open())
+	{
+		m_Error = "Could not open " + path.string();
+		return false;
+	}
+
+	char magic[8];
+	uint32_t header[5];
+	if (!readValues(file, magic, 8) || std::memcmp(magic, Magic, sizeof(Magic)) != 0 || !readValues(file, header, 5))
+	{
+		m_Error = "Not a FESD model file";
+		return false;
+	}
+
+	auto [version, frameCount, jointCount, featuresPerJoint, layerCount] = header;
+	if (version != Version)
+	{
+		m_Error = "Unsupported model version " + std::to_string(version);
+		return false;
+	}
+	if (jointCount != Skeleton::JointCount || (featuresPerJoint != 3 && featuresPerJoint != 4) || frameCount == 0 || frameCount > 1000 || layerCount == 0)
+	{
+		m_Error = "Model does not fit the skeleton (" + std::to_string(jointCount) + " joints, " + std::to_string(featuresPerJoint) + " features per joint)";
+		return false;
+	}
+
+	m_FrameCount = (int)frameCount;
+	m_FeaturesPerJoint = (int)featuresPerJoint;
+	const size_t inputs = (size_t)frameCount * jointCount * featuresPerJoint;
+
+	m_InputMean.resize(inputs);
+	m_InputScale.resize(inputs);
+	if (!readValues(file, m_InputMean.data(), inputs) || !readValues(file, m_InputScale.data(), inputs))
+	{
+		m_Error = "Model file ends in the input normalization";
+		return false;
+	}
+
+	m_Layers.resize(layerCount);
+	std::vector<float> weights, bias;
+	size_t layerInputs = inputs;
+	for (uint32_t l = 0; l < layerCount; l++)
+	{
+		uint32_t shape[3];
+		if (!readValues(file, shape, 3))
+		{
+			m_Error = "Model file ends in layer " + std::to_string(l);
+			return false;
+		}
+
+		auto [layerIn, layerOut, activation] = shape;
+		if (layerIn != layerInputs || layerOut == 0 || layerOut > 65536 || activation > (uint32_t)Activation::Tanh)
+		{
+			m_Error = "Layer " + std::to_string(l) + " does not fit (" + std::to_string(layerIn) + " inputs, expected " + std::to_string(layerInputs) + ")";
+			return false;
+		}
+
+		weights.resize((size_t)layerOut * layerIn);
+		bias.resize(layerOut);
+		if (!readValues(file, weights.data(), weights.size()) || !readValues(file, bias.data(), bias.size()))
+		{
+			m_Error = "Model file ends in layer " + std::to_string(l);
+			return false;
+		}
+
+		m_Layers[l].Weights.pack(weights.data(), bias.data(), (int)layerOut, (int)layerIn);
+		m_Layers[l].Function = (Activation)activation;
+		layerInputs = layerOut;
+	}
+
+	if (layerInputs != Skeleton::JointCount)
+	{
+		m_Error = "The last layer has " + std::to_string(layerInputs) + " outputs, expected one per joint";
+		return false;
+	}
+
+	return true;
+}
+
+void FaultEstimator::extractFeatures(const Skeleton *sequence, float *features) const
+{
+	const auto &origin = sequence[m_FrameCount - 1][Joint::Torso];
+
+	int f = 0;
+	for (int s = 0; s < m_FrameCount; s++)
+	{
+		for (int j = 0; j < Skeleton::JointCount; j++)
+		{
+			auto p = sequence[s].Joints[j] - origin;
+			features[f] = (p.x - m_InputMean[f]) * m_InputScale[f]; f++;
+			features[f] = (p.y - m_InputMean[f]) * m_InputScale[f]; f++;
+			features[f] = (p.z - m_InputMean[f]) * m_InputScale[f]; f++;
+
+			if (m_FeaturesPerJoint == 4)
+			{
+				features[f] = (sequence[s].Confidence[j] - m_InputMean[f]) * m_InputScale[f];
+				f++;
+			}
+		}
+	}
+}
+
+void FaultEstimator::activate(Activation function, float *values, size_t count) const
+{
+	switch (function)
+	{
+	case Activation::ReLU:
+		for (size_t i = 0; i < count; i++)
+			values[i] = std::max(values[i], 0.0f);
+		break;
+	case Activation::Sigmoid:
+		for (size_t i = 0; i < count; i++)
+			values[i] = 1.0f / (1.0f + std::exp(-values[i]));
+		break;
+	case Activation::Tanh:
+		for (size_t i = 0; i < count; i++)
+			values[i] = std::tanh(values[i]);
+		break;
+	default:
+		break;
+	}
+}
+
+bool FaultEstimator::estimate(const Skeleton *skeletons, int sequenceCount, int frameCount, Faults *faults)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	// A model loaded after the sequences were put together may expect longer ones
+	if (m_Layers.empty() || sequenceCount <= 0 || frameCount != m_FrameCount)
+		return false;
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	const int inputs = (int)m_InputMean.size();
+	m_Input.resize((size_t)sequenceCount * inputs);
+	for (int s = 0; s < sequenceCount; s++)
+		extractFeatures(skeletons + (size_t)s * m_FrameCount, &m_Input[(size_t)s * inputs]);
+
+	// Hidden activations keep the padded row stride of their layer
+	const float *x = m_Input.data();
+	int xStride = inputs;
+	for (int l = 0; l < (int)m_Layers.size(); l++)
+	{
+		auto &layer = m_Layers[l];
+		auto &y = m_Hidden[l % 2];
+		int yStride = layer.Weights.getPaddedOutputs();
+		y.resize((size_t)sequenceCount * yStride);
+
+		layer.Weights.multiply(x, xStride, sequenceCount, y.data(), yStride);
+		activate(layer.Function, y.data(), y.size());
+
+		x = y.data();
+		xStride = yStride;
+	}
+
+	for (int s = 0; s < sequenceCount; s++)
+		std::copy_n(x + (size_t)s * xStride, Skeleton::JointCount, faults[s].begin());
+
+	m_LastRunTime = std::chrono::high_resolution_clock::now() - start;
+	return true;
+}
+
+bool FaultEstimator::update(const Skeleton &skeleton, Faults &faults)
+{
+	int frameCount;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_Layers.empty())
+			return false;
+
+		m_History.push_back(skeleton);
+		while ((int)m_History.size() > m_FrameCount)
+			m_History.pop_front();
+
+		if ((int)m_History.size() < m_FrameCount)
+			return false;
+
+		m_Sequence.assign(m_History.begin(), m_History.end());
+		frameCount = m_FrameCount;
+	}
+
+	if (!estimate(m_Sequence.data(), 1, frameCount, &faults))
+		return false;
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_LastFaults = faults;
+	return true;
+}
+
+void FaultEstimator::runBenchmark()
+{
+	int batchSize = m_BenchmarkRequest;
+	if (batchSize <= 0)
+		return;
+
+	BenchmarkResult result;
+	bool isDone = benchmark(batchSize, result);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (isDone)
+		m_Benchmark = result;
+	m_BenchmarkRequest = 0;
+}
+
+bool FaultEstimator::benchmark(int batchSize, BenchmarkResult &result)
+{
+	int frameCount;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		frameCount = m_FrameCount;
+	}
+	if (frameCount == 0)
+		return false;
+
+	// A standing person with some noise on every joint
+	std::mt19937 generator(42);
+	std::normal_distribution<float> noise(0.0f, 0.02f);
+	std::vector<Skeleton> skeletons((size_t)batchSize * frameCount);
+	for (auto &skeleton : skeletons)
+	{
+		skeleton[Joint::Head] = { 0.0f, 0.7f, 2.0f };
+		skeleton[Joint::Neck] = { 0.0f, 0.5f, 2.0f };
+		skeleton[Joint::Torso] = { 0.0f, 0.2f, 2.0f };
+		skeleton[Joint::Pelvis] = { 0.0f, -0.1f, 2.0f };
+		skeleton[Joint::LeftHand] = { 0.3f, -0.1f, 2.0f };
+		skeleton[Joint::RightHand] = { -0.3f, -0.1f, 2.0f };
+		skeleton[Joint::LeftFoot] = { 0.15f, -0.9f, 2.0f };
+		skeleton[Joint::RightFoot] = { -0.15f, -0.9f, 2.0f };
+		for (int j = 0; j < Skeleton::JointCount; j++)
+		{
+			skeleton.Joints[j] += glm::vec3{ noise(generator), noise(generator), noise(generator) };
+			skeleton.Confidence[j] = 1.0f;
+		}
+	}
+
+	std::vector<Faults> faults(batchSize);
+	const int repetitions = 20;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int r = 0; r < repetitions; r++)
+	{
+		if (!estimate(skeletons.data(), batchSize, frameCount, faults.data()))
+			return false;
+	}
+	std::chrono::duration<double, std::milli> batchTime = std::chrono::high_resolution_clock::now() - start;
+
+	start = std::chrono::high_resolution_clock::now();
+	for (int r = 0; r < repetitions; r++)
+	{
+		for (int s = 0; s < batchSize; s++)
+		{
+			if (!estimate(skeletons.data() + (size_t)s * frameCount, 1, frameCount, &faults[s]))
+				return false;
+		}
+	}
+	std::chrono::duration<double, std::milli> singleTime = std::chrono::high_resolution_clock::now() - start;
+
+	result.BatchSize = batchSize;
+	result.BatchTime = batchTime.count() / repetitions;
+	result.SingleTime = singleTime.count() / repetitions;
+	return true;
+}
+
+void FaultEstimator::OnImGuiRender()
+{
+	ImGui::InputText("Model", m_ModelPath, sizeof(m_ModelPath));
+	ImGui::SameLine(); ImGuiHelper::HelpMarker("Multilayer perceptron exported from the Python training in the FESD model format (see FaultEstimator.h).");
+
+	if (ImGui::Button("Load Model"))
+		load(m_ModelPath);
+	ImGui::SameLine();
+	if (ImGui::Button("Unload"))
+		unload();
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (!m_Error.empty())
+		ImGui::TextColored({ 1.0f, 0.3f, 0.3f, 1.0f }, "%s", m_Error.c_str());
+
+	if (m_Layers.empty())
+	{
+		ImGui::Text("No model loaded");
+		return;
+	}
+
+	ImGui::Text("%d layers, %d frames per sequence, %d inputs", (int)m_Layers.size(), m_FrameCount, (int)m_InputMean.size());
+	ImGui::SliderFloat("Fault Threshold", &m_Threshold, 0.0f, 1.0f);
+	ImGui::Text("History: %d / %d, Last run: %.3f ms", (int)m_History.size(), m_FrameCount, m_LastRunTime.count());
+
+	for (int j = 0; j < Skeleton::JointCount; j++)
+	{
+		bool isFaulty = m_LastFaults[j] > m_Threshold;
+		ImGui::TextColored(isFaulty ? ImVec4{ 1.0f, 0.3f, 0.3f, 1.0f } : ImGui::GetStyleColorVec4(ImGuiCol_Text), "%-10s %.2f", Skeleton::JointNames[j], m_LastFaults[j]);
+	}
+
+	// The skeleton worker picks the request up between two detections
+	ImGui::BeginDisabled(hasBenchmarkRequest());
+	if (ImGui::Button("Benchmark"))
+		m_BenchmarkRequest = 256;
+	ImGui::EndDisabled();
+	if (hasBenchmarkRequest())
+	{
+		ImGui::SameLine();
+		ImGui::Text("Waiting for the skeleton worker");
+	}
+
+	if (m_Benchmark.BatchSize > 0)
+	{
+		ImGui::Text("%d sequences: batched %.3f ms, one by one %.3f ms (%.4f ms per sequence)", m_Benchmark.BatchSize,
+			m_Benchmark.BatchTime, m_Benchmark.SingleTime, m_Benchmark.SingleTime / m_Benchmark.BatchSize);
+	}
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <array>
+#include <deque>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+
+#include <utilities/Gemm.h>
+
+#include "Skeleton.h"
+
+/// <summary>
+/// Estimates per joint fault probabilities from a short sequence of skeletons with a multilayer perceptron
+/// trained in Python. Inference runs batched on the CPU (see PackedMatrix).
+///
+/// Model file, little endian:
+///   char[8]  "FESDMLP\0"
+///   uint32   Version (1), FrameCount, JointCount, FeaturesPerJoint (3: position, 4: position and confidence), LayerCount
+///   float    InputMean[inputs], InputScale[inputs]    with inputs = FrameCount * JointCount * FeaturesPerJoint
+///   per layer:
+///     uint32 Inputs, Outputs, Activation (0 linear, 1 relu, 2 sigmoid, 3 tanh)
+///     float  Weights[Outputs][Inputs]                 (torch.nn.Linear.weight)
+///     float  Bias[Outputs]
+///
+/// The features of a sequence are the joints of its skeletons, oldest first, relative to the torso of the newest
+/// skeleton, normalized as (x - mean) * scale. The last layer has one output per joint and should end in a sigmoid.
+/// </summary>
+class FaultEstimator
+{
+public:
+	using Faults = std::array<float, Skeleton::JointCount>;
+
+	enum class Activation : uint32_t
+	{
+		Linear,
+		ReLU,
+		Sigmoid,
+		Tanh
+	};
+
+	/// <returns>False if the file is missing or malformed, the reason is available from getError</returns>
+	bool load(const std::filesystem::path &path);
+	void unload();
+
+	bool isLoaded() const;
+	const std::string &getError() const { return m_Error; }
+
+	/// <returns>Number of skeletons in one input sequence</returns>
+	int getFrameCount() const { return m_FrameCount; }
+
+	/// <summary>
+	/// Batched inference
+	/// </summary>
+	/// <param name="skeletons">sequenceCount * frameCount skeletons, every sequence oldest first</param>
+	/// <param name="frameCount">Skeletons per sequence, has to match the loaded model (see getFrameCount)</param>
+	/// <param name="faults">One fault probability per joint and sequence</param>
+	/// <returns>False if no model is loaded or it expects a different frame count</returns>
+	bool estimate(const Skeleton *skeletons, int sequenceCount, int frameCount, Faults *faults);
+
+	/// <summary>
+	/// Adds the newest live skeleton and estimates the faults of the last getFrameCount() skeletons
+	/// </summary>
+	/// <returns>False while the history is not filled yet or no model is loaded</returns>
+	bool update(const Skeleton &skeleton, Faults &faults);
+
+	/// <returns>True if the benchmark button was pressed and runBenchmark has not run yet</returns>
+	bool hasBenchmarkRequest() const { return m_BenchmarkRequest > 0; }
+
+	/// <summary>
+	/// Runs a requested benchmark, called by the skeleton worker so the UI does not wait for it
+	/// </summary>
+	void runBenchmark();
+
+	void OnImGuiRender();
+
+	/// <summary>
+	/// Joints above this probability are shown as faulty
+	/// </summary>
+	float m_Threshold{ 0.5f };
+private:
+	struct Layer
+	{
+		PackedMatrix Weights;
+		Activation Function{ Activation::Linear };
+	};
+
+	bool read(const std::filesystem::path &path);
+	void extractFeatures(const Skeleton *sequence, float *features) const;
+	void activate(Activation function, float *values, size_t count) const;
+
+	// Guards the model, it is loaded from the render thread and used on the skeleton worker
+	mutable std::mutex m_Mutex;
+
+	int m_FrameCount{ 0 };
+	int m_FeaturesPerJoint{ 0 };
+	std::vector<float> m_InputMean;
+	std::vector<float> m_InputScale;
+	std::vector<Layer> m_Layers;
+
+	// Activations of the whole batch, reused between calls
+	std::vector<float> m_Input;
+	std::vector<float> m_Hidden[2];
+
+	std::deque<Skeleton> m_History;
+	std::vector<Skeleton> m_Sequence;
+
+	std::string m_Error;
+	char m_ModelPath[256]{ "resources/models/fault_estimator.mlp" };
+	Faults m_LastFaults{ };
+	std::chrono::duration<double, std::milli> m_LastRunTime{ 0.0 };
+
+	// Batch size of the requested benchmark, 0 if none
+	std::atomic<int> m_BenchmarkRequest{ 0 };
+
+	struct BenchmarkResult
+	{
+		int BatchSize{ 0 };
+		double BatchTime{ 0.0 };
+		double SingleTime{ 0.0 };
+	} m_Benchmark;
+
+	/// <returns>False if the model changed while it ran</returns>
+	bool benchmark(int batchSize, BenchmarkResult &result);
+};
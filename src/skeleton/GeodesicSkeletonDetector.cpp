@@ -0,0 +1,243 @@
+#include "GeodesicSkeletonDetector.h"
+
+#include <algorithm>
+#include <queue>
+#include <limits>
+#include <cmath>
+#include <imgui.h>
+
+static const float Unreached = std::numeric_limits<float>::infinity();
+
+void GeodesicSkeletonDetector::buildGraph(const SkeletonInput &input, const Settings &settings)
+{
+	const int stride = std::max(settings.Stride, 1);
+	const float maxEdgeLength = settings.MaxEdgeLength * stride;
+
+	m_NodeByGrid.assign((size_t)input.Width * input.Height, -1);
+	m_Nodes.clear();
+
+	for (int k = 0; k < (int)input.Points.size(); k++)
+	{
+		int g = input.GridIndices[k];
+		if ((g % input.Width) % stride != 0 || (g / input.Width) % stride != 0)
+			continue;
+
+		m_NodeByGrid[g] = (int)m_Nodes.size();
+		m_Nodes.push_back(k);
+	}
+
+	m_EdgeOffsets.resize(m_Nodes.size() + 1);
+	m_Edges.clear();
+	m_Weights.clear();
+
+	for (int n = 0; n < (int)m_Nodes.size(); n++)
+	{
+		m_EdgeOffsets[n] = (int)m_Edges.size();
+
+		auto p = input.Points[m_Nodes[n]];
+		int g = input.GridIndices[m_Nodes[n]];
+		int x = g % input.Width;
+		int y = g / input.Width;
+
+		for (int dy = -stride; dy <= stride; dy += stride)
+		{
+			for (int dx = -stride; dx <= stride; dx += stride)
+			{
+				int nx = x + dx;
+				int ny = y + dy;
+				if ((dx == 0 && dy == 0) || nx < 0 || ny < 0 || nx >= input.Width || ny >= input.Height)
+					continue;
+
+				int neighbour = m_NodeByGrid[ny * input.Width + nx];
+				if (neighbour < 0)
+					continue;
+
+				float length = glm::length(input.Points[m_Nodes[neighbour]] - p);
+				if (length > maxEdgeLength)
+					continue;
+
+				m_Edges.push_back(neighbour);
+				m_Weights.push_back(length);
+			}
+		}
+	}
+	m_EdgeOffsets[m_Nodes.size()] = (int)m_Edges.size();
+}
+
+void GeodesicSkeletonDetector::shortestPaths(int source, std::vector<float> &distances, std::vector<int> *predecessors)
+{
+	using Entry = std::pair<float, int>;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+
+	distances[source] = 0.0f;
+	if (predecessors)
+		(*predecessors)[source] = -1;
+	queue.push({ 0.0f, source });
+
+	while (!queue.empty())
+	{
+		auto [distance, node] = queue.top();
+		queue.pop();
+
+		if (distance > distances[node])
+			continue;
+
+		for (int e = m_EdgeOffsets[node]; e < m_EdgeOffsets[node + 1]; e++)
+		{
+			int neighbour = m_Edges[e];
+			float candidate = distance + m_Weights[e];
+			if (candidate >= distances[neighbour])
+				continue;
+
+			distances[neighbour] = candidate;
+			if (predecessors)
+				(*predecessors)[neighbour] = node;
+			queue.push({ candidate, neighbour });
+		}
+	}
+}
+
+glm::vec3 GeodesicSkeletonDetector::pointOnPath(int node, float distance) const
+{
+	while (m_TorsoPredecessors[node] >= 0 && m_TorsoDistances[node] > distance)
+		node = m_TorsoPredecessors[node];
+
+	return mp_Input->Points[m_Nodes[node]];
+}
+
+float GeodesicSkeletonDetector::getConfidence(float distance, float expected, float tolerance) const
+{
+	float d = (distance - expected) / tolerance;
+	return std::exp(-d * d);
+}
+
+bool GeodesicSkeletonDetector::detect(const SkeletonInput &input, Skeleton &skeleton)
+{
+	Settings settings;
+	{
+		std::lock_guard<std::mutex> lock(m_SettingsMutex);
+		settings = m_Settings;
+	}
+
+	if (input.Points.size() < 50 || input.Width <= 0)
+		return false;
+
+	mp_Input = &input;
+	buildGraph(input, settings);
+
+	const int nodeCount = (int)m_Nodes.size();
+	if (nodeCount < 10)
+		return false;
+
+	// The torso is the node closest to the centroid
+	glm::vec3 centroid{ 0.0f };
+	for (auto node : m_Nodes)
+		centroid += input.Points[node];
+	centroid /= (float)nodeCount;
+
+	int torso = 0;
+	float closest = Unreached;
+	for (int n = 0; n < nodeCount; n++)
+	{
+		auto d = input.Points[m_Nodes[n]] - centroid;
+		if (glm::dot(d, d) < closest)
+		{
+			closest = glm::dot(d, d);
+			torso = n;
+		}
+	}
+
+	m_TorsoDistances.assign(nodeCount, Unreached);
+	m_TorsoPredecessors.assign(nodeCount, -1);
+	shortestPaths(torso, m_TorsoDistances, &m_TorsoPredecessors);
+
+	// Every extremum becomes a source, the next one is furthest from all previous ones
+	m_Distances = m_TorsoDistances;
+	std::vector<int> extrema;
+	for (int k = 0; k < 5; k++)
+	{
+		int furthest = -1;
+		float maxDistance = 0.0f;
+		for (int n = 0; n < nodeCount; n++)
+		{
+			if (m_Distances[n] != Unreached && m_Distances[n] > maxDistance)
+			{
+				maxDistance = m_Distances[n];
+				furthest = n;
+			}
+		}
+
+		if (furthest < 0)
+			break;
+
+		extrema.push_back(furthest);
+		shortestPaths(furthest, m_Distances, nullptr);
+	}
+
+	int reached = (int)std::count_if(m_TorsoDistances.begin(), m_TorsoDistances.end(), [](float d) { return d != Unreached; });
+	float torsoConfidence = (float)reached / (float)nodeCount;
+
+	auto up = glm::normalize(input.Up);
+	auto torsoPoint = input.Points[m_Nodes[torso]];
+	auto height = [&](int node) { return glm::dot(input.Points[m_Nodes[node]] - torsoPoint, up); };
+
+	// Pointing to the right of a person that faces the camera
+	auto right = glm::normalize(glm::cross(up, glm::vec3{ 0.0f, 0.0f, 1.0f }));
+	auto side = [&](int node) { return glm::dot(input.Points[m_Nodes[node]] - torsoPoint, right); };
+
+	skeleton = Skeleton{};
+	skeleton.Joints.fill(torsoPoint);
+	skeleton[Joint::Torso] = torsoPoint;
+	skeleton.confidence(Joint::Torso) = torsoConfidence;
+
+	// Highest extremum is the head, the two lowest are the feet and the rest are the hands
+	std::sort(extrema.begin(), extrema.end(), [&](int a, int b) { return height(a) > height(b); });
+
+	auto setJoint = [&](Joint joint, int node, float expected)
+		{
+			skeleton[joint] = input.Points[m_Nodes[node]];
+			skeleton.confidence(joint) = torsoConfidence * getConfidence(m_TorsoDistances[node], expected, settings.Tolerance);
+		};
+
+	auto setPair = [&](Joint left, Joint right, int a, int b, float expected)
+		{
+			if (side(a) > side(b))
+				std::swap(a, b);
+			setJoint(left, a, expected);
+			setJoint(right, b, expected);
+		};
+
+	if (!extrema.empty())
+	{
+		int head = extrema.front();
+		setJoint(Joint::Head, head, settings.HeadDistance);
+		if (height(head) <= 0.0f)
+			skeleton.confidence(Joint::Head) *= 0.5f;
+
+		skeleton[Joint::Neck] = pointOnPath(head, m_TorsoDistances[head] - 0.25f);
+		skeleton.confidence(Joint::Neck) = skeleton.confidence(Joint::Head);
+	}
+
+	if (extrema.size() == 5)
+	{
+		setPair(Joint::LeftHand, Joint::RightHand, extrema[1], extrema[2], settings.HandDistance);
+		setPair(Joint::LeftFoot, Joint::RightFoot, extrema[3], extrema[4], settings.FootDistance);
+
+		const float pelvisDistance = 0.3f;
+		skeleton[Joint::Pelvis] = (pointOnPath(extrema[3], pelvisDistance) + pointOnPath(extrema[4], pelvisDistance)) * 0.5f;
+		skeleton.confidence(Joint::Pelvis) = std::min(skeleton.confidence(Joint::LeftFoot), skeleton.confidence(Joint::RightFoot));
+	}
+
+	mp_Input = nullptr;
+	return true;
+}
+
+void GeodesicSkeletonDetector::showSettings()
+{
+	ImGui::SliderFloat("Max Edge Length (m)", &m_Settings.MaxEdgeLength, 0.01f, 0.2f);
+	ImGui::SliderInt("Grid Stride", &m_Settings.Stride, 1, 8);
+	ImGui::SliderFloat("Head Distance (m)", &m_Settings.HeadDistance, 0.1f, 1.0f);
+	ImGui::SliderFloat("Hand Distance (m)", &m_Settings.HandDistance, 0.2f, 1.5f);
+	ImGui::SliderFloat("Foot Distance (m)", &m_Settings.FootDistance, 0.3f, 2.0f);
+	ImGui::SliderFloat("Distance Tolerance (m)", &m_Settings.Tolerance, 0.05f, 1.0f);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <vector>
+
+#include "SkeletonDetector.h"
+
+/// <summary>
+/// Reference CPU detector based on geodesic extrema (AGEX).
+/// The points form a graph over their depth grid neighbours, the five points with the largest geodesic
+/// distance from the torso and from each other are taken as head, hands and feet.
+/// Neck and pelvis are read off the shortest paths from the torso to the head and the feet.
+/// Left and right assume the person faces the camera.
+/// </summary>
+class GeodesicSkeletonDetector : public SkeletonDetector
+{
+public:
+	bool detect(const SkeletonInput &input, Skeleton &skeleton) override;
+
+	std::string getName() const override { return "Geodesic Extrema"; }
+
+	struct Settings
+	{
+		/// <summary>
+		/// Neighbours further apart than this are not connected, in meters
+		/// </summary>
+		float MaxEdgeLength{ 0.05f };
+
+		/// <summary>
+		/// Only every n-th row and column of the grid is used
+		/// </summary>
+		int Stride{ 2 };
+
+		/// <summary>
+		/// Expected geodesic distances from the torso in meters, used for the confidence
+		/// </summary>
+		float HeadDistance{ 0.7f };
+		float HandDistance{ 0.95f };
+		float FootDistance{ 1.05f };
+		float Tolerance{ 0.3f };
+	};
+protected:
+	void showSettings() override;
+private:
+	void buildGraph(const SkeletonInput &input, const Settings &settings);
+
+	/// <summary>
+	/// Dijkstra from source, distances are only lowered so several runs give the distance to the closest source
+	/// </summary>
+	void shortestPaths(int source, std::vector<float> &distances, std::vector<int> *predecessors);
+
+	/// <returns>Point on the shortest path from node to the torso at the given geodesic distance from the torso</returns>
+	glm::vec3 pointOnPath(int node, float distance) const;
+
+	float getConfidence(float distance, float expected, float tolerance) const;
+
+	Settings m_Settings;
+
+	// Graph in compressed row layout
+	std::vector<int> m_Nodes;
+	std::vector<int> m_EdgeOffsets;
+	std::vector<int> m_Edges;
+	std::vector<float> m_Weights;
+
+	std::vector<int> m_NodeByGrid;
+
+	const SkeletonInput *mp_Input{ nullptr };
+	std::vector<float> m_TorsoDistances;
+	std::vector<int> m_TorsoPredecessors;
+	std::vector<float> m_Distances;
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <glm/glm.hpp>
+
+enum class Joint
+{
+	Head,
+	Neck,
+	Torso,
+	Pelvis,
+	LeftHand,
+	RightHand,
+	LeftFoot,
+	RightFoot,
+	Count
+};
+
+/// <summary>
+/// Joints of one person in point cloud coordinates (meters, y up)
+/// </summary>
+struct Skeleton
+{
+	static const int JointCount = (int)Joint::Count;
+	static constexpr const char *JointNames[JointCount] = { "Head", "Neck", "Torso", "Pelvis", "Left Hand", "Right Hand", "Left Foot", "Right Foot" };
+
+	std::array<glm::vec3, JointCount> Joints{ };
+
+	/// <summary>
+	/// 0 (not found) to 1 per joint
+	/// </summary>
+	std::array<float, JointCount> Confidence{ };
+
+	/// <summary>
+	/// Probability that the joint is faulty, zero without a fault estimator
+	/// </summary>
+	std::array<float, JointCount> Fault{ };
+
+	/// <summary>
+	/// Time the frame was captured in seconds
+	/// </summary>
+	double Timestamp{ 0.0 };
+
+	/// <summary>
+	/// Index of the frame the skeleton was detected in
+	/// </summary>
+	unsigned int FrameIndex{ 0 };
+
+	inline glm::vec3 &operator[](Joint joint) { return Joints[(int)joint]; }
+	inline const glm::vec3 &operator[](Joint joint) const { return Joints[(int)joint]; }
+
+	inline float &confidence(Joint joint) { return Confidence[(int)joint]; }
+	inline float confidence(Joint joint) const { return Confidence[(int)joint]; }
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <mutex>
+#include <glm/glm.hpp>
+
+#include "Skeleton.h"
+
+/// <summary>
+/// Points of one person (a foreground cluster), copied so the detection can run on another thread
+/// </summary>
+struct SkeletonInput
+{
+	std::vector<glm::vec3> Points;
+
+	/// <summary>
+	/// Position of every point on the depth grid (y * Width + x)
+	/// </summary>
+	std::vector<int> GridIndices;
+
+	int Width{ 0 };
+	int Height{ 0 };
+
+	/// <summary>
+	/// Up direction, the floor normal if it is known
+	/// </summary>
+	glm::vec3 Up{ 0.0f, 1.0f, 0.0f };
+
+	double Timestamp{ 0.0 };
+	unsigned int FrameIndex{ 0 };
+};
+
+/// <summary>
+/// Base class for skeleton detectors. Detection runs on the worker thread while the settings are
+/// changed from the render thread, implementations copy their settings under m_SettingsMutex.
+/// </summary>
+class SkeletonDetector
+{
+public:
+	virtual ~SkeletonDetector() = default;
+
+	/// <summary>
+	/// Fits the joints, timestamp and frame index are set by the caller
+	/// </summary>
+	/// <returns>False if no skeleton could be fitted</returns>
+	virtual bool detect(const SkeletonInput &input, Skeleton &skeleton) = 0;
+
+	virtual std::string getName() const = 0;
+
+	void OnImGuiRender()
+	{
+		std::lock_guard<std::mutex> lock(m_SettingsMutex);
+		showSettings();
+	}
+protected:
+	virtual void showSettings() = 0;
+
+	std::mutex m_SettingsMutex;
+};
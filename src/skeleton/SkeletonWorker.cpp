@@ -0,0 +1,151 @@
+#include "SkeletonWorker.h"
+
+#include <imgui.h>
+#include <GLCore/Profiler.h>
+
+SkeletonWorker::SkeletonWorker(std::unique_ptr<SkeletonDetector> detector) : mp_Detector(std::move(detector))
+{
+}
+
+SkeletonWorker::~SkeletonWorker()
+{
+	stop();
+}
+
+void SkeletonWorker::start()
+{
+	if (isRunning())
+		return;
+
+	m_Stop = false;
+	m_Thread = std::thread(&SkeletonWorker::run, this);
+}
+
+void SkeletonWorker::stop()
+{
+	if (!isRunning())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+		m_HasPending = false;
+	}
+	m_Condition.notify_one();
+	m_Thread.join();
+}
+
+void SkeletonWorker::submit(SkeletonInput &&input)
+{
+	if (!isRunning())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_HasPending)
+			m_DroppedCount++;
+
+		m_Pending = std::move(input);
+		m_HasPending = true;
+	}
+	m_Condition.notify_one();
+}
+
+bool SkeletonWorker::getSkeleton(Skeleton &skeleton) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_DetectionCount == 0)
+		return false;
+
+	skeleton = m_Skeleton;
+	return true;
+}
+
+unsigned int SkeletonWorker::getDetectionCount() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_DetectionCount;
+}
+
+void SkeletonWorker::run()
+{
+	Profiler::setThreadName("Skeleton");
+	SkeletonInput input;
+	Skeleton skeleton;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this] { return m_Stop || m_HasPending || m_FaultEstimator.hasBenchmarkRequest(); });
+			if (m_Stop)
+				return;
+
+			if (m_FaultEstimator.hasBenchmarkRequest())
+			{
+				lock.unlock();
+				m_FaultEstimator.runBenchmark();
+				continue;
+			}
+
+			// Swapping hands the old buffers back, so they are reused by the next submit
+			std::swap(input, m_Pending);
+			m_HasPending = false;
+		}
+
+		PROFILE_SCOPE("Detect Skeleton");
+		auto start = std::chrono::high_resolution_clock::now();
+		bool isDetected = mp_Detector->detect(input, skeleton);
+		skeleton.Timestamp = input.Timestamp;
+		skeleton.FrameIndex = input.FrameIndex;
+
+		skeleton.Fault.fill(0.0f);
+		if (isDetected)
+			m_FaultEstimator.update(skeleton, skeleton.Fault);
+		auto runTime = std::chrono::high_resolution_clock::now() - start;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_LastRunTime = runTime;
+		if (isDetected)
+		{
+			m_Skeleton = skeleton;
+			m_DetectionCount++;
+		}
+	}
+}
+
+void SkeletonWorker::OnImGuiRender()
+{
+	ImGui::Text("Detector: %s", mp_Detector->getName().c_str());
+	mp_Detector->OnImGuiRender();
+
+	if (ImGui::TreeNode("Fault Estimation"))
+	{
+		bool hadRequest = m_FaultEstimator.hasBenchmarkRequest();
+		m_FaultEstimator.OnImGuiRender();
+		if (!isRunning())
+			ImGui::TextDisabled("Benchmarks run once skeleton detection is enabled");
+		ImGui::TreePop();
+
+		// The lock orders the request before the wait of the worker, so the notification is not lost
+		if (!hadRequest && m_FaultEstimator.hasBenchmarkRequest())
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+			}
+			m_Condition.notify_one();
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	ImGui::Text("Detections: %u, Dropped Frames: %u, Last run: %.3f ms", m_DetectionCount, m_DroppedCount, m_LastRunTime.count());
+
+	if (m_DetectionCount == 0)
+		return;
+
+	for (int j = 0; j < Skeleton::JointCount; j++)
+	{
+		auto &joint = m_Skeleton.Joints[j];
+		ImGui::Text("%-10s %6.2f %6.2f %6.2f  (%.2f)", Skeleton::JointNames[j], joint.x, joint.y, joint.z, m_Skeleton.Confidence[j]);
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#include "SkeletonDetector.h"
+#include "FaultEstimator.h"
+
+/// <summary>
+/// Runs a skeleton detector on its own thread so the render loop never waits for it.
+/// Only the newest input is kept, inputs that arrive while the detector is busy replace the pending one.
+/// The thread only runs between start and stop, inputs submitted while it is stopped are dropped.
+/// </summary>
+class SkeletonWorker
+{
+public:
+	SkeletonWorker(std::unique_ptr<SkeletonDetector> detector);
+	~SkeletonWorker();
+
+	SkeletonWorker(const SkeletonWorker &) = delete;
+	SkeletonWorker &operator=(const SkeletonWorker &) = delete;
+
+	/// <summary>
+	/// Starts the detection thread, does nothing if it is running
+	/// </summary>
+	void start();
+
+	/// <summary>
+	/// Joins the detection thread, a pending input is dropped
+	/// </summary>
+	void stop();
+
+	bool isRunning() const { return m_Thread.joinable(); }
+
+	/// <summary>
+	/// Hands a new input to the worker, never blocks on a running detection
+	/// </summary>
+	void submit(SkeletonInput &&input);
+
+	/// <summary>
+	/// Copies the newest skeleton
+	/// </summary>
+	/// <returns>False if no skeleton was detected yet</returns>
+	bool getSkeleton(Skeleton &skeleton) const;
+
+	/// <returns>Number of skeletons detected so far, changes whenever a new one is available</returns>
+	unsigned int getDetectionCount() const;
+
+	/// <returns>Fault probability above which a joint counts as faulty</returns>
+	float getFaultThreshold() const { return m_FaultEstimator.m_Threshold; }
+
+	void OnImGuiRender();
+private:
+	void run();
+
+	std::unique_ptr<SkeletonDetector> mp_Detector;
+
+	// Runs on every detected skeleton once a model is loaded
+	FaultEstimator m_FaultEstimator;
+
+	std::thread m_Thread;
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	bool m_Stop{ false };
+
+	SkeletonInput m_Pending;
+	bool m_HasPending{ false };
+
+	Skeleton m_Skeleton;
+	unsigned int m_DetectionCount{ 0 };
+	unsigned int m_DroppedCount{ 0 };
+	std::chrono::duration<double, std::milli> m_LastRunTime{ 0.0 };
+};
@@ -0,0 +1,165 @@
+#include "Gemm.h"
+
+#include <algorithm>
+#include <numeric>
+#include <execution>
+
+#include "Simd.h"
+
+namespace
+{
+#if defined(FESD_AVX2)
+	struct Lanes
+	{
+		using V = __m256;
+		static const int Width = 8;
+
+		static V load(const float *p) { return _mm256_loadu_ps(p); }
+		static void store(float *p, V v) { _mm256_storeu_ps(p, v); }
+		static V broadcast(float f) { return _mm256_set1_ps(f); }
+		static V multiplyAdd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+	};
+#elif defined(FESD_SSSE3)
+	struct Lanes
+	{
+		using V = __m128;
+		static const int Width = 4;
+
+		static V load(const float *p) { return _mm_loadu_ps(p); }
+		static void store(float *p, V v) { _mm_storeu_ps(p, v); }
+		static V broadcast(float f) { return _mm_set1_ps(f); }
+		static V multiplyAdd(V a, V b, V c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+	};
+#else
+	struct Lanes
+	{
+		using V = float;
+		static const int Width = 1;
+
+		static V load(const float *p) { return *p; }
+		static void store(float *p, V v) { *p = v; }
+		static V broadcast(float f) { return f; }
+		static V multiplyAdd(V a, V b, V c) { return a * b + c; }
+	};
+#endif
+
+	/// <summary>
+	/// Rows x (Panels * 8) block of Y, kept in registers over all inputs
+	/// </summary>
+	template<int Rows, int Panels>
+	void kernel(const float *x, int xStride, const float *panels, size_t panelSize, const float *bias, int inputs, float *y, int yStride)
+	{
+		constexpr int Vectors = Panels * PackedMatrix::PanelWidth / Lanes::Width;
+		constexpr int VectorsPerPanel = PackedMatrix::PanelWidth / Lanes::Width;
+
+		Lanes::V sums[Rows][Vectors];
+		for (int v = 0; v < Vectors; v++)
+		{
+			auto b = Lanes::load(bias + v * Lanes::Width);
+			for (int r = 0; r < Rows; r++)
+				sums[r][v] = b;
+		}
+
+		for (int k = 0; k < inputs; k++)
+		{
+			Lanes::V weights[Vectors];
+			for (int v = 0; v < Vectors; v++)
+				weights[v] = Lanes::load(panels + (v / VectorsPerPanel) * panelSize + k * PackedMatrix::PanelWidth + (v % VectorsPerPanel) * Lanes::Width);
+
+			for (int r = 0; r < Rows; r++)
+			{
+				auto value = Lanes::broadcast(x[r * xStride + k]);
+				for (int v = 0; v < Vectors; v++)
+					sums[r][v] = Lanes::multiplyAdd(value, weights[v], sums[r][v]);
+			}
+		}
+
+		for (int r = 0; r < Rows; r++)
+		{
+			for (int v = 0; v < Vectors; v++)
+				Lanes::store(y + r * yStride + v * Lanes::Width, sums[r][v]);
+		}
+	}
+
+	const int BlockRows = 4;
+	const int BlockPanels = 2;
+}
+
+void PackedMatrix::pack(const float *weights, const float *bias, int outputs, int inputs)
+{
+	m_Outputs = outputs;
+	m_Inputs = inputs;
+	m_PanelCount = (outputs + PanelWidth - 1) / PanelWidth;
+
+	// Padding outputs have zero weights and bias, so they come out as zero
+	m_Panels.assign((size_t)m_PanelCount * inputs * PanelWidth, 0.0f);
+	m_Bias.assign((size_t)m_PanelCount * PanelWidth, 0.0f);
+
+	for (int o = 0; o < outputs; o++)
+	{
+		float *panel = &m_Panels[(size_t)(o / PanelWidth) * inputs * PanelWidth];
+		for (int k = 0; k < inputs; k++)
+			panel[k * PanelWidth + o % PanelWidth] = weights[(size_t)o * inputs + k];
+
+		if (bias)
+			m_Bias[o] = bias[o];
+	}
+}
+
+void PackedMatrix::multiply(const float *x, int xStride, int batch, float *y, int yStride) const
+{
+	auto multiplyRows = [&](int firstRow)
+		{
+			int rows = std::min(BlockRows, batch - firstRow);
+			for (int p = 0; p < m_PanelCount; p += BlockPanels)
+			{
+				multiplyPanels(x + (size_t)firstRow * xStride, xStride, rows, p, std::min(BlockPanels, m_PanelCount - p),
+					y + (size_t)firstRow * yStride + p * PanelWidth, yStride);
+			}
+		};
+
+	// Live inference runs one sequence, only large batches are worth spreading over threads
+	if (batch < 16 * BlockRows)
+	{
+		for (int r = 0; r < batch; r += BlockRows)
+			multiplyRows(r);
+		return;
+	}
+
+	std::vector<int> blocks((batch + BlockRows - 1) / BlockRows);
+	std::iota(blocks.begin(), blocks.end(), 0);
+	std::for_each(std::execution::par, blocks.begin(), blocks.end(), [&](int block) { multiplyRows(block * BlockRows); });
+}
+
+void PackedMatrix::multiplyPanels(const float *x, int xStride, int rows, int firstPanel, int panels, float *y, int yStride) const
+{
+	const size_t panelSize = (size_t)m_Inputs * PanelWidth;
+	const float *w = m_Panels.data() + firstPanel * panelSize;
+	const float *b = m_Bias.data() + firstPanel * PanelWidth;
+
+	switch ((rows - 1) * BlockPanels + panels - 1)
+	{
+	case 0: kernel<1, 1>(x, xStride, w, panelSize, b, m_Inputs, y, yStride); break;
+	case 1: kernel<1, 2>(x, xStride, w, panelSize, b, m_Inputs, y, yStride); break;
+	case 2: kernel<2, 1>(x, xStride, w, panelSize, b, m_Inputs, y, yStride); break;
+	case 3: kernel<2, 2>(x, xStride, w, panelSize, b, m_Inputs, y, yStride); break;
+	case 4: kernel<3, 1>(x, xStride, w, panelSize, b, m_Inputs, y, yStride); break;
+	case 5: kernel<3, 2>(x, xStride, w, panelSize, b, m_Inputs, y, yStride); break;
+	case 6: kernel<4, 1>(x, xStride, w, panelSize, b, m_Inputs, y, yStride); break;
+	case 7: kernel<4, 2>(x, xStride, w, panelSize, b, m_Inputs, y, yStride); break;
+	}
+}
+
+void PackedMatrix::multiplyReference(const float *x, int batch, const float *weights, const float *bias, int outputs, int inputs, float *y)
+{
+	for (int r = 0; r < batch; r++)
+	{
+		for (int o = 0; o < outputs; o++)
+		{
+			float sum = bias ? bias[o] : 0.0f;
+			for (int k = 0; k < inputs; k++)
+				sum += x[(size_t)r * inputs + k] * weights[(size_t)o * inputs + k];
+			y[(size_t)r * outputs + o] = sum;
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+
+/// <summary>
+/// Dense matrix product for small fully connected layers, Y = X * W^T + b.
+/// The weights are repacked once into panels of 8 outputs so the kernel streams them with contiguous
+/// 8 wide loads and keeps a 4 x 16 block of Y in registers (AVX2 with FMA, SSE and scalar fallbacks).
+/// </summary>
+class PackedMatrix
+{
+public:
+	static const int PanelWidth = 8;
+
+	/// <summary>
+	/// Packs a row major outputs x inputs weight matrix (the layout of torch.nn.Linear)
+	/// </summary>
+	/// <param name="bias">Outputs values, zero if null</param>
+	void pack(const float *weights, const float *bias, int outputs, int inputs);
+
+	int getOutputs() const { return m_Outputs; }
+	int getInputs() const { return m_Inputs; }
+
+	/// <returns>Outputs rounded up to full panels, the row stride Y needs</returns>
+	int getPaddedOutputs() const { return m_PanelCount * PanelWidth; }
+
+	/// <summary>
+	/// Y = X * W^T + b for a batch of rows. Padding columns of Y are written as zero.
+	/// </summary>
+	/// <param name="x">batch x inputs, rows xStride floats apart</param>
+	/// <param name="y">batch x getPaddedOutputs(), rows yStride floats apart</param>
+	void multiply(const float *x, int xStride, int batch, float *y, int yStride) const;
+
+	/// <summary>
+	/// Plain triple loop on the unpacked weights, reference for the kernel
+	/// </summary>
+	static void multiplyReference(const float *x, int batch, const float *weights, const float *bias, int outputs, int inputs, float *y);
+private:
+	void multiplyPanels(const float *x, int xStride, int rows, int firstPanel, int panels, float *y, int yStride) const;
+
+	int m_Outputs{ 0 };
+	int m_Inputs{ 0 };
+	int m_PanelCount{ 0 };
+
+	// Panel p holds inputs x 8 weights, element (k, j) is W[8p + j][k]
+	std::vector<float> m_Panels;
+	std::vector<float> m_Bias;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+
+/// <summary>
+/// Read only memory mapping of a whole file. Pages are loaded by the OS on first access,
+/// so random access into large recordings only reads what is touched.
+/// </summary>
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile() { close(); }
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	/// <param name="sequential">Hint that the file is read front to back, the OS reads further ahead</param>
+	/// <returns>False if the file could not be opened or is empty</returns>
+	bool open(const std::filesystem::path &path, bool sequential = false);
+	void close();
+
+	bool isOpen() const { return mp_Data != nullptr; }
+	const uint8_t *getData() const { return mp_Data; }
+	size_t getSize() const { return m_Size; }
+private:
+	const uint8_t *mp_Data{ nullptr };
+	size_t m_Size{ 0 };
+
+#ifdef _WIN32
+	void *m_File{ nullptr };
+	void *m_Mapping{ nullptr };
+#endif
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/// <summary>
+/// Bounded lock free queue for any number of producer threads and exactly one consumer thread.
+/// Every slot carries a sequence number that tells whose turn it is: producers claim the tail with a compare exchange
+/// and publish the slot by advancing its sequence, the consumer releases it by advancing it by the capacity.
+/// A full ring never blocks, tryPush fails and the producer decides what to drop.
+/// </summary>
+template<typename T>
+class MpscRing
+{
+public:
+	/// <param name="capacity">Rounded up to a power of two</param>
+	explicit MpscRing(size_t capacity)
+	{
+		size_t size = 1;
+		while (size < capacity)
+			size *= 2;
+
+		m_Slots = std::vector<Slot>(size);
+		m_Mask = size - 1;
+		for (size_t i = 0; i < size; i++)
+			m_Slots[i].Sequence.store(i, std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Producer: moves the value into the ring
+	/// </summary>
+	/// <returns>False if the ring is full, the value is left untouched</returns>
+	bool tryPush(T &value)
+	{
+		size_t tail = m_Tail.load(std::memory_order_relaxed);
+		while (true)
+		{
+			Slot &slot = m_Slots[tail & m_Mask];
+			size_t sequence = slot.Sequence.load(std::memory_order_acquire);
+			intptr_t difference = (intptr_t)sequence - (intptr_t)tail;
+
+			if (difference == 0)
+			{
+				if (m_Tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+				{
+					std::swap(slot.Value, value);
+					slot.Sequence.store(tail + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			// The consumer has not released the slot of the previous lap yet
+			else if (difference < 0)
+				return false;
+			else
+				tail = m_Tail.load(std::memory_order_relaxed);
+		}
+	}
+
+	/// <summary>
+	/// Consumer: takes the oldest value, swapped so the slot keeps the buffers of value for the next producer
+	/// </summary>
+	/// <returns>False if the ring is empty</returns>
+	bool tryPop(T &value)
+	{
+		Slot &slot = m_Slots[m_Head & m_Mask];
+		if (slot.Sequence.load(std::memory_order_acquire) != m_Head + 1)
+			return false;
+
+		std::swap(value, slot.Value);
+		slot.Sequence.store(m_Head + m_Slots.size(), std::memory_order_release);
+		m_Head++;
+		return true;
+	}
+
+	size_t getCapacity() const { return m_Slots.size(); }
+private:
+	struct alignas(64) Slot
+	{
+		std::atomic<size_t> Sequence{ 0 };
+		T Value{ };
+	};
+
+	std::vector<Slot> m_Slots;
+	size_t m_Mask{ 0 };
+
+	alignas(64) std::atomic<size_t> m_Tail{ 0 };
+
+	// Only used by the consumer
+	alignas(64) size_t m_Head{ 0 };
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+// Every x64 CPU we record on supports SSSE3, but MSVC only defines __SSSE3__/__AVX2__ when /arch asks for it,
+// so the x64 target itself is used as the SSSE3 switch.
+#if defined(_M_X64) || defined(__SSSE3__)
+#define FESD_SSSE3
+#include <immintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define FESD_AVX2
+#endif
@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+/// <summary>
+/// Bounded lock free queue for exactly one producer and one consumer thread.
+/// The slots are allocated once and reused, the producer fills a slot in place and publishes it,
+/// the consumer reads it in place and releases it, so large elements (frames) are never moved.
+/// </summary>
+template<typename T>
+class SpscRing
+{
+public:
+	explicit SpscRing(size_t capacity = 0) : m_Slots(capacity) { }
+
+	/// <summary>
+	/// Empties the ring, only while neither thread uses it
+	/// </summary>
+	/// <param name="prototype">Every slot starts as a copy, so buffers in it are allocated up front</param>
+	void reset(size_t capacity, const T &prototype = T())
+	{
+		m_Slots.clear();
+		m_Slots.resize(capacity, prototype);
+		m_Head.store(0, std::memory_order_relaxed);
+		m_Tail.store(0, std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Producer: next free slot, publish it with push
+	/// </summary>
+	/// <returns>nullptr if the ring is full</returns>
+	T *getFreeSlot()
+	{
+		size_t tail = m_Tail.load(std::memory_order_relaxed);
+		if (tail - m_Head.load(std::memory_order_acquire) == m_Slots.size())
+			return nullptr;
+
+		return &m_Slots[tail % m_Slots.size()];
+	}
+
+	/// <summary>
+	/// Producer: publishes the slot returned by getFreeSlot
+	/// </summary>
+	void push()
+	{
+		m_Tail.store(m_Tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	/// <summary>
+	/// Consumer: oldest published slot, release it with pop
+	/// </summary>
+	/// <returns>nullptr if the ring is empty</returns>
+	T *getFront()
+	{
+		size_t head = m_Head.load(std::memory_order_relaxed);
+		if (head == m_Tail.load(std::memory_order_acquire))
+			return nullptr;
+
+		return &m_Slots[head % m_Slots.size()];
+	}
+
+	/// <summary>
+	/// Consumer: hands the slot returned by getFront back to the producer
+	/// </summary>
+	void pop()
+	{
+		m_Head.store(m_Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	/// <returns>Published slots, a snapshot on any other thread</returns>
+	size_t getSize() const
+	{
+		// The head never passes the tail read after it
+		size_t head = m_Head.load(std::memory_order_acquire);
+		return m_Tail.load(std::memory_order_acquire) - head;
+	}
+	size_t getCapacity() const { return m_Slots.size(); }
+private:
+	std::vector<T> m_Slots;
+
+	// Own cache lines, the producer writes the tail and the consumer the head
+	alignas(64) std::atomic<size_t> m_Head{ 0 };
+	alignas(64) std::atomic<size_t> m_Tail{ 0 };
+};
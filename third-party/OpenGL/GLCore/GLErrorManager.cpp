@@ -17,3 +17,15 @@ bool GLLogCall(const char *function, const char *file, int line)
 
     return true;
 }
+
+bool GLCheckErrors(const char *where)
+{
+    bool isOk = true;
+    while (GLenum error = glGetError())
+    {
+        std::cout << "[OpenGL Error] (" << error << "): " << where << std::endl;
+        isOk = false;
+    }
+
+    return isOk;
+}
@@ -1,7 +1,17 @@
 #define ASSERT(x) if (!(x)) __debugbreak();
+
+// glGetError after every call stalls the pipeline, release builds only check once per frame with GLCheckErrors.
+// Define GL_CHECK_CALLS to check every call in a release build.
+#if !defined(NDEBUG) || defined(GL_CHECK_CALLS)
 #define GLCall(x) GLClearError();\
     x;\
     ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+#else
+#define GLCall(x) x;
+#endif
 
 void GLClearError();
 bool GLLogCall(const char *function, const char *file, int line);
+
+// Logs the errors raised since the last check, returns false if there were any
+bool GLCheckErrors(const char *where);
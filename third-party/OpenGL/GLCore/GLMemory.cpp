@@ -0,0 +1,107 @@
+#include "GLMemory.h"
+
+#include <unordered_map>
+#include <algorithm>
+#include <numeric>
+#include <imgui.h>
+
+namespace
+{
+    struct Owner
+    {
+        std::string Name;
+        std::array<size_t, (size_t)GLMemory::Kind::Count> Bytes{};
+    };
+
+    // Resources created outside of a scope are accounted to nullptr
+    std::unordered_map<const void *, Owner> s_Owners{ { nullptr, { "Other" } } };
+    const void *s_CurrentOwner = nullptr;
+
+    const char *KindNames[] = { "Vertex Buffers", "Index Buffers", "Textures" };
+}
+
+size_t GLMemory::Usage::Total() const
+{
+    return std::accumulate(Bytes.begin(), Bytes.end(), (size_t)0);
+}
+
+GLMemory::OwnerScope::OwnerScope(const void *owner, const std::string &name) : mp_Previous(s_CurrentOwner)
+{
+    s_Owners[owner].Name = name;
+    s_CurrentOwner = owner;
+}
+
+GLMemory::OwnerScope::~OwnerScope()
+{
+    s_CurrentOwner = mp_Previous;
+}
+
+const void *GLMemory::allocate(Kind kind, size_t bytes)
+{
+    s_Owners[s_CurrentOwner].Bytes[(size_t)kind] += bytes;
+    return s_CurrentOwner;
+}
+
+void GLMemory::release(const void *owner, Kind kind, size_t bytes)
+{
+    auto entry = s_Owners.find(owner);
+    if (entry == s_Owners.end())
+        return;
+
+    auto &allocated = entry->second.Bytes[(size_t)kind];
+    allocated -= std::min(allocated, bytes);
+
+    // The address may be reused by the next object
+    bool isEmpty = std::all_of(entry->second.Bytes.begin(), entry->second.Bytes.end(), [](size_t b) { return b == 0; });
+    if (isEmpty && owner != nullptr && owner != s_CurrentOwner)
+        s_Owners.erase(entry);
+}
+
+std::vector<GLMemory::Usage> GLMemory::getUsage()
+{
+    std::vector<Usage> usage;
+    for (const auto &[owner, entry] : s_Owners)
+    {
+        Usage ownerUsage{ entry.Name, entry.Bytes };
+        if (ownerUsage.Total() > 0)
+            usage.push_back(ownerUsage);
+    }
+
+    std::sort(usage.begin(), usage.end(), [](const Usage &a, const Usage &b) { return a.Total() > b.Total(); });
+    return usage;
+}
+
+void GLMemory::OnImGuiRender()
+{
+    auto usage = getUsage();
+
+    Usage total;
+    for (const auto &ownerUsage : usage)
+    {
+        for (size_t k = 0; k < total.Bytes.size(); k++)
+            total.Bytes[k] += ownerUsage.Bytes[k];
+    }
+    ImGui::Text("GPU Memory: %.2f MB", total.Total() / (1024.0 * 1024.0));
+
+    if (!ImGui::BeginTable("GLMemory", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp))
+        return;
+
+    ImGui::TableSetupColumn("Object");
+    for (const char *kind : KindNames)
+        ImGui::TableSetupColumn(kind);
+    ImGui::TableSetupColumn("Total");
+    ImGui::TableHeadersRow();
+
+    for (const auto &ownerUsage : usage)
+    {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn(); ImGui::TextUnformatted(ownerUsage.Owner.c_str());
+        for (size_t bytes : ownerUsage.Bytes)
+        {
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f MB", bytes / (1024.0 * 1024.0));
+        }
+        ImGui::TableNextColumn(); ImGui::Text("%.2f MB", ownerUsage.Total() / (1024.0 * 1024.0));
+    }
+    ImGui::EndTable();
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <array>
+#include <cstddef>
+
+/// <summary>
+/// Accounts the GPU memory of the vertex buffers, index buffers and textures to the object that created them.
+/// An object opens an OwnerScope while it creates its GL resources, resources created outside of any scope are
+/// listed as Other. Only used on the thread owning the GL context.
+/// </summary>
+class GLMemory
+{
+public:
+	enum class Kind
+	{
+		VertexBuffer,
+		IndexBuffer,
+		Texture,
+		Count
+	};
+
+	struct Usage
+	{
+		std::string Owner;
+		std::array<size_t, (size_t)Kind::Count> Bytes{};
+		size_t Total() const;
+	};
+
+	class OwnerScope
+	{
+	public:
+		OwnerScope(const void *owner, const std::string &name);
+		~OwnerScope();
+
+		OwnerScope(const OwnerScope &) = delete;
+		OwnerScope &operator=(const OwnerScope &) = delete;
+	private:
+		const void *mp_Previous;
+	};
+
+	/// <returns>Owner the bytes are accounted to, to be passed to release</returns>
+	static const void *allocate(Kind kind, size_t bytes);
+	static void release(const void *owner, Kind kind, size_t bytes);
+
+	/// <summary>
+	/// Usage of every owner with allocated resources, the largest first
+	/// </summary>
+	static std::vector<Usage> getUsage();
+
+	static void OnImGuiRender();
+};
@@ -1,9 +1,10 @@
 #include "IndexBuffer.h"
 #include "GLErrorManager.h"
+#include "GLMemory.h"
 #include <GL/glew.h>
 
 IndexBuffer::IndexBuffer(unsigned int count)
-    : m_Count(count)
+    : m_Count(count), mp_MemoryOwner(GLMemory::allocate(GLMemory::Kind::IndexBuffer, count * sizeof(unsigned int)))
 {
     ASSERT(sizeof(unsigned int) == sizeof(GLuint));
     GLCall(glGenBuffers(1, &m_RendererID));
@@ -12,7 +13,7 @@ IndexBuffer::IndexBuffer(unsigned int count)
 }
 
 IndexBuffer::IndexBuffer(const unsigned int *data, unsigned int count)
-    : m_Count(count)
+    : m_Count(count), mp_MemoryOwner(GLMemory::allocate(GLMemory::Kind::IndexBuffer, count * sizeof(unsigned int)))
 {
     ASSERT(sizeof(unsigned int) == sizeof(GLuint));
     GLCall(glGenBuffers(1, &m_RendererID));
@@ -22,6 +23,7 @@ IndexBuffer::IndexBuffer(const unsigned int *data, unsigned int count)
 
 IndexBuffer::~IndexBuffer()
 {
+    GLMemory::release(mp_MemoryOwner, GLMemory::Kind::IndexBuffer, m_Count * sizeof(unsigned int));
     GLCall(glDeleteBuffers(1, &m_RendererID));
 }
 
@@ -3,8 +3,9 @@
 class IndexBuffer
 {
 private:
-	unsigned int m_RendererID;
-	unsigned int m_Count;
+	unsigned int m_RendererID{ 0 };
+	unsigned int m_Count{ 0 };
+	const void *mp_MemoryOwner{ nullptr };
 public:
 	IndexBuffer() = default;
 	IndexBuffer(unsigned int count);
@@ -0,0 +1,565 @@
+#include "Profiler.h"
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <fstream>
+#include <map>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+#include <GL/glew.h>
+#include <imgui.h>
+
+std::atomic<bool> Profiler::s_IsEnabled{ true };
+
+namespace
+{
+    // Zones beyond this are dropped while nobody calls endFrame, e.g. in the command line tools
+    const size_t MaxThreadEvents = 65536;
+
+    struct ThreadBuffer
+    {
+        std::mutex Mutex;
+        std::vector<Profiler::Event> Events;
+        uint32_t Index{ 0 };
+
+        // Only used by the owning thread
+        uint32_t Depth{ 0 };
+    };
+
+    struct GpuQuery
+    {
+        const char *Name;
+        GLuint Start;
+        GLuint End;
+        uint32_t Depth;
+    };
+
+    struct GpuFrame
+    {
+        uint64_t Number{ 0 };
+        GLuint FrameQuery{ 0 };
+        std::vector<GpuQuery> Queries;
+    };
+
+    struct State
+    {
+        // Buffers are never freed, a thread that ends leaves its index behind
+        std::mutex ThreadsMutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> Threads;
+        std::vector<std::string> ThreadNames;
+
+        // Only used by the render thread
+        std::deque<Profiler::Frame> History;
+        uint64_t FrameNumber{ 0 };
+        int64_t FrameStart{ 0 };
+
+        GpuFrame CurrentGpu;
+        std::deque<GpuFrame> PendingGpu;
+        std::vector<GLuint> FreeQueries;
+        uint32_t GpuDepth{ 0 };
+
+        std::vector<Profiler::Event> LatestGpuEvents;
+        bool HasLatestGpuEvents{ false };
+
+        bool IsPaused{ false };
+        int SelectedFrame{ -1 };
+        float Zoom{ 1.0f };
+        char TracePath[256]{ "profile.json" };
+        char CsvPath[256]{ "profile.csv" };
+        std::string DumpStatus;
+    };
+
+    State &getState()
+    {
+        static State state;
+        return state;
+    }
+
+    const auto s_Epoch = std::chrono::steady_clock::now();
+    thread_local ThreadBuffer *t_Buffer = nullptr;
+
+    ThreadBuffer &getThreadBuffer()
+    {
+        if (t_Buffer)
+            return *t_Buffer;
+
+        auto &state = getState();
+        std::lock_guard<std::mutex> lock(state.ThreadsMutex);
+        auto &buffer = state.Threads.emplace_back(std::make_unique<ThreadBuffer>());
+        buffer->Index = (uint32_t)state.Threads.size() - 1;
+        state.ThreadNames.push_back("Thread " + std::to_string(buffer->Index));
+        t_Buffer = buffer.get();
+        return *t_Buffer;
+    }
+
+    GLuint acquireQuery()
+    {
+        auto &queries = getState().FreeQueries;
+        if (queries.empty())
+        {
+            queries.resize(64);
+            glGenQueries((GLsizei)queries.size(), queries.data());
+        }
+        GLuint query = queries.back();
+        queries.pop_back();
+        return query;
+    }
+
+    std::string escapeJson(const char *text)
+    {
+        std::string escaped;
+        for (; *text; text++)
+        {
+            if (*text == '"' || *text == '\\')
+                escaped += '\\';
+            escaped += *text;
+        }
+        return escaped;
+    }
+
+    ImU32 getZoneColor(const char *name)
+    {
+        // Same name, same color, over all frames
+        uint32_t hash = 2166136261u;
+        for (; *name; name++)
+            hash = (hash ^ (uint8_t)*name) * 16777619u;
+        return ImColor::HSV((hash % 360) / 360.0f, 0.5f, 0.65f);
+    }
+}
+
+Profiler::Zone::Zone(const char *name) : m_Name(name)
+{
+    if (!isEnabled())
+        return;
+
+    getThreadBuffer().Depth++;
+    m_Start = now();
+}
+
+Profiler::Zone::~Zone()
+{
+    if (m_Start < 0)
+        return;
+
+    int64_t end = now();
+    auto &buffer = getThreadBuffer();
+    buffer.Depth--;
+
+    std::lock_guard<std::mutex> lock(buffer.Mutex);
+    if (buffer.Events.size() < MaxThreadEvents)
+        buffer.Events.push_back({ m_Name, m_Start, end, buffer.Depth, buffer.Index });
+}
+
+Profiler::GpuZone::GpuZone(const char *name)
+{
+    auto &state = getState();
+    if (!isEnabled() || state.CurrentGpu.FrameQuery == 0)
+        return;
+
+    GpuQuery query{ name, acquireQuery(), acquireQuery(), state.GpuDepth++ };
+    glQueryCounter(query.Start, GL_TIMESTAMP);
+    m_Index = (int)state.CurrentGpu.Queries.size();
+    state.CurrentGpu.Queries.push_back(query);
+}
+
+Profiler::GpuZone::~GpuZone()
+{
+    if (m_Index < 0)
+        return;
+
+    auto &state = getState();
+    state.GpuDepth--;
+    glQueryCounter(state.CurrentGpu.Queries[m_Index].End, GL_TIMESTAMP);
+}
+
+int64_t Profiler::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_Epoch).count();
+}
+
+void Profiler::setThreadName(const std::string &name)
+{
+    auto &buffer = getThreadBuffer();
+    auto &state = getState();
+    std::lock_guard<std::mutex> lock(state.ThreadsMutex);
+    state.ThreadNames[buffer.Index] = name;
+}
+
+void Profiler::beginFrame()
+{
+    auto &state = getState();
+    state.FrameStart = now();
+    state.CurrentGpu.Number = state.FrameNumber;
+    state.CurrentGpu.Queries.clear();
+    state.CurrentGpu.FrameQuery = 0;
+
+    if (isEnabled())
+    {
+        state.CurrentGpu.FrameQuery = acquireQuery();
+        glQueryCounter(state.CurrentGpu.FrameQuery, GL_TIMESTAMP);
+    }
+}
+
+void Profiler::endFrame()
+{
+    auto &state = getState();
+
+    Frame frame;
+    frame.Number = state.FrameNumber++;
+    frame.Start = state.FrameStart;
+    frame.End = now();
+
+    {
+        std::lock_guard<std::mutex> lock(state.ThreadsMutex);
+        for (auto &buffer : state.Threads)
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->Mutex);
+            frame.Events.insert(frame.Events.end(), buffer->Events.begin(), buffer->Events.end());
+            buffer->Events.clear();
+        }
+    }
+
+    if (state.CurrentGpu.FrameQuery != 0)
+        state.PendingGpu.push_back(std::move(state.CurrentGpu));
+    state.CurrentGpu = GpuFrame();
+
+    // A paused panel keeps showing the frames it has
+    if (!state.IsPaused && isEnabled())
+    {
+        state.History.push_back(std::move(frame));
+        while (state.History.size() > HistoryFrames)
+            state.History.pop_front();
+    }
+
+    collectGpuEvents();
+}
+
+void Profiler::collectGpuEvents()
+{
+    auto &state = getState();
+    while (!state.PendingGpu.empty())
+    {
+        auto &pending = state.PendingGpu.front();
+
+        // Frames finish in order, a frame that is not done yet holds back the later ones
+        GLint isAvailable = 0;
+        glGetQueryObjectiv(pending.FrameQuery, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+        for (size_t q = 0; q < pending.Queries.size() && isAvailable; q++)
+            glGetQueryObjectiv(pending.Queries[q].End, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+        if (!isAvailable)
+            break;
+
+        GLuint64 frameStart = 0;
+        glGetQueryObjectui64v(pending.FrameQuery, GL_QUERY_RESULT, &frameStart);
+
+        state.LatestGpuEvents.clear();
+        for (const auto &query : pending.Queries)
+        {
+            GLuint64 start = 0, end = 0;
+            glGetQueryObjectui64v(query.Start, GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(query.End, GL_QUERY_RESULT, &end);
+            state.LatestGpuEvents.push_back({ query.Name, (int64_t)(start - frameStart), (int64_t)(end - frameStart), query.Depth, GpuThread });
+
+            state.FreeQueries.push_back(query.Start);
+            state.FreeQueries.push_back(query.End);
+        }
+        state.HasLatestGpuEvents = true;
+
+        auto frame = std::find_if(state.History.begin(), state.History.end(), [&](const Frame &f) { return f.Number == pending.Number; });
+        if (frame != state.History.end())
+        {
+            frame->GpuEvents = state.LatestGpuEvents;
+            frame->HasGpuEvents = true;
+        }
+
+        state.FreeQueries.push_back(pending.FrameQuery);
+        state.PendingGpu.pop_front();
+    }
+}
+
+bool Profiler::takeLatestGpuEvents(std::vector<Event> &events)
+{
+    auto &state = getState();
+    if (!state.HasLatestGpuEvents)
+        return false;
+
+    events.swap(state.LatestGpuEvents);
+    state.LatestGpuEvents.clear();
+    state.HasLatestGpuEvents = false;
+    return true;
+}
+
+bool Profiler::writeChromeTrace(const std::string &path)
+{
+    auto &state = getState();
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    const uint32_t gpuThreadId = 1000;
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    {
+        std::lock_guard<std::mutex> lock(state.ThreadsMutex);
+        for (uint32_t t = 0; t < state.ThreadNames.size(); t++)
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t << ",\"args\":{\"name\":\"" << escapeJson(state.ThreadNames[t].c_str()) << "\"}},\n";
+    }
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << gpuThreadId << ",\"args\":{\"name\":\"GPU\"}}";
+
+    char line[512];
+    for (const auto &frame : state.History)
+    {
+        snprintf(line, sizeof(line), ",\n{\"name\":\"Frame %llu\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+            (unsigned long long)frame.Number, frame.Start * 1e-3, (frame.End - frame.Start) * 1e-3, 0u);
+        file << line;
+
+        for (const auto &event : frame.Events)
+        {
+            snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"cat\":\"cpu\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                escapeJson(event.Name).c_str(), event.Start * 1e-3, (event.End - event.Start) * 1e-3, event.Thread);
+            file << line;
+        }
+
+        for (const auto &event : frame.GpuEvents)
+        {
+            snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"cat\":\"gpu\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                escapeJson(event.Name).c_str(), (frame.Start + event.Start) * 1e-3, (event.End - event.Start) * 1e-3, gpuThreadId);
+            file << line;
+        }
+    }
+    file << "\n]}\n";
+    return file.good();
+}
+
+bool Profiler::writeCsv(const std::string &path)
+{
+    auto &state = getState();
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    std::vector<std::string> threadNames;
+    {
+        std::lock_guard<std::mutex> lock(state.ThreadsMutex);
+        threadNames = state.ThreadNames;
+    }
+
+    file << "frame,thread,zone,depth,start_ms,duration_ms\n";
+    char line[512];
+    for (const auto &frame : state.History)
+    {
+        // Start relative to the frame, GPU zones relative to the start of the frame on the GPU
+        for (const auto &event : frame.Events)
+        {
+            snprintf(line, sizeof(line), "%llu,%s,%s,%u,%.4f,%.4f\n", (unsigned long long)frame.Number, threadNames[event.Thread].c_str(), event.Name,
+                event.Depth, (event.Start - frame.Start) * 1e-6, (event.End - event.Start) * 1e-6);
+            file << line;
+        }
+        for (const auto &event : frame.GpuEvents)
+        {
+            snprintf(line, sizeof(line), "%llu,GPU,%s,%u,%.4f,%.4f\n", (unsigned long long)frame.Number, event.Name, event.Depth, event.Start * 1e-6, (event.End - event.Start) * 1e-6);
+            file << line;
+        }
+    }
+    return file.good();
+}
+
+void Profiler::OnImGuiRender()
+{
+    auto &state = getState();
+    ImGui::Begin("Profiler");
+
+    bool isEnabled = Profiler::isEnabled();
+    if (ImGui::Checkbox("Enabled", &isEnabled))
+        setEnabled(isEnabled);
+    ImGui::SameLine();
+    ImGui::Checkbox("Pause", &state.IsPaused);
+
+    if (state.History.empty())
+    {
+        ImGui::Text("No frames recorded");
+        ImGui::End();
+        return;
+    }
+
+    std::vector<float> frameTimes(state.History.size());
+    for (size_t f = 0; f < state.History.size(); f++)
+        frameTimes[f] = (state.History[f].End - state.History[f].Start) * 1e-6f;
+
+    ImGui::PlotHistogram("##Frames", frameTimes.data(), (int)frameTimes.size(), 0, "Frame time (ms), click to select", 0.0f, 50.0f, ImVec2(-FLT_MIN, 60.0f));
+    if (ImGui::IsItemHovered() && ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+    {
+        float x = (ImGui::GetMousePos().x - ImGui::GetItemRectMin().x) / ImGui::GetItemRectSize().x;
+        state.SelectedFrame = std::clamp((int)(x * frameTimes.size()), 0, (int)frameTimes.size() - 1);
+        state.IsPaused = true;
+    }
+    if (!state.IsPaused)
+        state.SelectedFrame = -1;
+
+    // The newest frame with GPU times, the GPU lags a few frames behind
+    int shown = state.SelectedFrame;
+    if (shown < 0 || shown >= (int)state.History.size())
+    {
+        shown = (int)state.History.size() - 1;
+        while (shown > 0 && !state.History[shown].HasGpuEvents && (int)state.History.size() - shown < 8)
+            shown--;
+    }
+
+    const Frame &frame = state.History[shown];
+    ImGui::Text("Frame %llu: %.2f ms, %d zones", (unsigned long long)frame.Number, frameTimes[shown], (int)(frame.Events.size() + frame.GpuEvents.size()));
+    ImGui::SliderFloat("Zoom", &state.Zoom, 1.0f, 50.0f, "%.1fx", ImGuiSliderFlags_Logarithmic);
+
+    showTimeline(frame);
+
+    if (ImGui::TreeNode("Zones"))
+    {
+        showZoneTable();
+        ImGui::TreePop();
+    }
+
+    if (ImGui::TreeNode("Dump"))
+    {
+        ImGui::InputText("Trace File", state.TracePath, sizeof(state.TracePath));
+        ImGui::SameLine();
+        if (ImGui::Button("Save Trace"))
+            state.DumpStatus = writeChromeTrace(state.TracePath) ? std::string("Wrote ") + state.TracePath : std::string("Could not write ") + state.TracePath;
+
+        ImGui::InputText("CSV File", state.CsvPath, sizeof(state.CsvPath));
+        ImGui::SameLine();
+        if (ImGui::Button("Save CSV"))
+            state.DumpStatus = writeCsv(state.CsvPath) ? std::string("Wrote ") + state.CsvPath : std::string("Could not write ") + state.CsvPath;
+
+        if (!state.DumpStatus.empty())
+            ImGui::TextUnformatted(state.DumpStatus.c_str());
+        ImGui::TreePop();
+    }
+
+    ImGui::End();
+}
+
+void Profiler::showTimeline(const Frame &frame)
+{
+    auto &state = getState();
+
+    // One lane per thread that has zones in the frame, one row per nesting depth
+    std::map<uint32_t, uint32_t> laneDepths;
+    for (const auto &event : frame.Events)
+        laneDepths[event.Thread] = std::max(laneDepths[event.Thread], event.Depth + 1);
+    for (const auto &event : frame.GpuEvents)
+        laneDepths[GpuThread] = std::max(laneDepths[GpuThread], event.Depth + 1);
+
+    std::vector<std::string> threadNames;
+    {
+        std::lock_guard<std::mutex> lock(state.ThreadsMutex);
+        threadNames = state.ThreadNames;
+    }
+
+    const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+    const float labelWidth = 100.0f;
+    float height = 0.0f;
+    for (const auto &[thread, depth] : laneDepths)
+        height += (depth + 0.5f) * rowHeight;
+
+    ImGui::BeginChild("Timeline", ImVec2(0, height + ImGui::GetStyle().ScrollbarSize + 8.0f), true, ImGuiWindowFlags_HorizontalScrollbar);
+    const float width = std::max(ImGui::GetContentRegionAvail().x - labelWidth, 100.0f) * state.Zoom;
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::Dummy(ImVec2(labelWidth + width, height));
+
+    auto *drawList = ImGui::GetWindowDrawList();
+    const double duration = (double)std::max<int64_t>(frame.End - frame.Start, 1);
+    const ImVec2 mouse = ImGui::GetMousePos();
+    const float labelX = ImGui::GetWindowPos().x + ImGui::GetStyle().WindowPadding.x;
+
+    float laneY = origin.y;
+    for (const auto &[thread, depth] : laneDepths)
+    {
+        const auto &events = thread == GpuThread ? frame.GpuEvents : frame.Events;
+        for (const auto &event : events)
+        {
+            if (event.Thread != thread)
+                continue;
+
+            // Zones of other threads may have started in the previous frame
+            float x0 = origin.x + labelWidth + (float)(std::max<int64_t>(event.Start - (thread == GpuThread ? 0 : frame.Start), 0) / duration) * width;
+            float x1 = origin.x + labelWidth + (float)((event.End - (thread == GpuThread ? 0 : frame.Start)) / duration) * width;
+            x1 = std::max(x1, x0 + 1.0f);
+            float y0 = laneY + event.Depth * rowHeight;
+            ImVec2 min{ x0, y0 }, max{ x1, y0 + rowHeight - 1.0f };
+
+            drawList->AddRectFilled(min, max, getZoneColor(event.Name));
+            if (x1 - x0 > 20.0f)
+            {
+                drawList->PushClipRect(min, max, true);
+                drawList->AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), IM_COL32_WHITE, event.Name);
+                drawList->PopClipRect();
+            }
+
+            if (ImGui::IsWindowHovered() && mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y)
+                ImGui::SetTooltip("%s\n%.3f ms", event.Name, (event.End - event.Start) * 1e-6);
+        }
+
+        // Labels stay in view while scrolling
+        const char *label = thread == GpuThread ? "GPU" : (thread < threadNames.size() ? threadNames[thread].c_str() : "?");
+        drawList->AddRectFilled(ImVec2(labelX, laneY), ImVec2(labelX + labelWidth - 4.0f, laneY + rowHeight), ImGui::GetColorU32(ImGuiCol_WindowBg));
+        drawList->AddText(ImVec2(labelX, laneY + 2.0f), ImGui::GetColorU32(ImGuiCol_Text), label);
+
+        laneY += (depth + 0.5f) * rowHeight;
+    }
+
+    ImGui::EndChild();
+}
+
+void Profiler::showZoneTable()
+{
+    auto &state = getState();
+
+    struct Statistics
+    {
+        uint64_t Calls{ 0 };
+        double Total{ 0.0 };
+        double Max{ 0.0 };
+    };
+
+    // GPU zones are listed apart, the same name may be timed on both
+    std::map<std::string, Statistics> zones;
+    for (const auto &frame : state.History)
+    {
+        auto add = [&](const Event &event, const char *prefix)
+            {
+                auto &statistics = zones[std::string(prefix) + event.Name];
+                double duration = (event.End - event.Start) * 1e-6;
+                statistics.Calls++;
+                statistics.Total += duration;
+                statistics.Max = std::max(statistics.Max, duration);
+            };
+        for (const auto &event : frame.Events)
+            add(event, "");
+        for (const auto &event : frame.GpuEvents)
+            add(event, "[GPU] ");
+    }
+
+    if (!ImGui::BeginTable("ZoneTable", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp))
+        return;
+
+    ImGui::TableSetupColumn("Zone");
+    ImGui::TableSetupColumn("Calls / Frame");
+    ImGui::TableSetupColumn("ms / Frame");
+    ImGui::TableSetupColumn("ms / Call");
+    ImGui::TableSetupColumn("Max ms");
+    ImGui::TableHeadersRow();
+
+    const double frames = (double)state.History.size();
+    for (const auto &[name, statistics] : zones)
+    {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn(); ImGui::TextUnformatted(name.c_str());
+        ImGui::TableNextColumn(); ImGui::Text("%.1f", statistics.Calls / frames);
+        ImGui::TableNextColumn(); ImGui::Text("%.3f", statistics.Total / frames);
+        ImGui::TableNextColumn(); ImGui::Text("%.3f", statistics.Total / statistics.Calls);
+        ImGui::TableNextColumn(); ImGui::Text("%.3f", statistics.Max);
+    }
+    ImGui::EndTable();
+}
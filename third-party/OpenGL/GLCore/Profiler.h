@@ -0,0 +1,141 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// Projects that do not link the profiler (FESDReader) define FESD_NO_PROFILER, the macros then compile to nothing
+#ifdef FESD_NO_PROFILER
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_GPU_SCOPE(name) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#else
+/// <summary>
+/// Times the rest of the enclosing scope on the CPU, name must be a string literal
+/// </summary>
+#define PROFILE_SCOPE(name) Profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+
+/// <summary>
+/// Times the GL commands issued in the rest of the enclosing scope on the GPU, only on the thread owning the GL context
+/// </summary>
+#define PROFILE_GPU_SCOPE(name) Profiler::GpuZone PROFILE_CONCAT(profileGpuZone, __LINE__)(name)
+
+/// <summary>
+/// Names the calling thread, for code that is also built without the profiler
+/// </summary>
+#define PROFILE_THREAD(name) Profiler::setThreadName(name)
+#endif
+
+/// <summary>
+/// Frame timing instrumentation. Zones are RAII timers that append to a buffer of their thread, so threads never
+/// wait on each other while timing. endFrame collects the zones of all threads into the frame history that the panel
+/// shows as a timeline and that can be dumped as CSV or Chrome trace (chrome://tracing, Perfetto).
+/// GPU zones are pairs of GL_TIMESTAMP queries that are read a few frames later, once their results are available,
+/// so they never stall the pipeline.
+/// </summary>
+class Profiler
+{
+public:
+	struct Event
+	{
+		const char *Name;
+
+		/// <summary>
+		/// Nanoseconds since the profiler started, GPU events since the start of their frame on the GPU
+		/// </summary>
+		int64_t Start;
+		int64_t End;
+
+		uint32_t Depth;
+
+		/// <summary>
+		/// Index into the thread names, GpuThread for GPU events
+		/// </summary>
+		uint32_t Thread;
+	};
+
+	struct Frame
+	{
+		uint64_t Number{ 0 };
+		int64_t Start{ 0 };
+		int64_t End{ 0 };
+		std::vector<Event> Events;
+
+		/// <summary>
+		/// Filled in once the queries are available, usually two or three frames later
+		/// </summary>
+		std::vector<Event> GpuEvents;
+		bool HasGpuEvents{ false };
+	};
+
+	class Zone
+	{
+	public:
+		explicit Zone(const char *name);
+		~Zone();
+
+		Zone(const Zone &) = delete;
+		Zone &operator=(const Zone &) = delete;
+	private:
+		const char *m_Name;
+		int64_t m_Start{ -1 };
+	};
+
+	class GpuZone
+	{
+	public:
+		explicit GpuZone(const char *name);
+		~GpuZone();
+
+		GpuZone(const GpuZone &) = delete;
+		GpuZone &operator=(const GpuZone &) = delete;
+	private:
+		int m_Index{ -1 };
+	};
+
+	static constexpr uint32_t GpuThread = 0xFFFFFFFF;
+	static constexpr size_t HistoryFrames = 300;
+
+	/// <summary>
+	/// Zones are only recorded while enabled, a disabled zone costs one atomic load
+	/// </summary>
+	static void setEnabled(bool isEnabled) { s_IsEnabled.store(isEnabled, std::memory_order_relaxed); }
+	static bool isEnabled() { return s_IsEnabled.load(std::memory_order_relaxed); }
+
+	/// <summary>
+	/// Name of the calling thread in the timeline and the dumps
+	/// </summary>
+	static void setThreadName(const std::string &name);
+
+	/// <summary>
+	/// Called by the render thread around every frame, with the GL context current
+	/// </summary>
+	static void beginFrame();
+	static void endFrame();
+
+	/// <returns>Nanoseconds since the profiler started</returns>
+	static int64_t now();
+
+	/// <summary>
+	/// Chrome trace event format, the GPU lane is shifted to the CPU start of its frame
+	/// </summary>
+	static bool writeChromeTrace(const std::string &path);
+	static bool writeCsv(const std::string &path);
+
+	/// <summary>
+	/// GPU zones of the newest frame collected since the last call, also while the panel is paused
+	/// </summary>
+	/// <returns>False if no frame was collected since the last call</returns>
+	static bool takeLatestGpuEvents(std::vector<Event> &events);
+
+	static void OnImGuiRender();
+private:
+	static void collectGpuEvents();
+	static void showTimeline(const Frame &frame);
+	static void showZoneTable();
+
+	static std::atomic<bool> s_IsEnabled;
+};
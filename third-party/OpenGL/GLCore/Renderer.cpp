@@ -1,10 +1,93 @@
 #include <iostream>
 #include "Renderer.h"
 #include "GLErrorManager.h"
+#include "GLMemory.h"
+#include "Profiler.h"
 #include <GL/glew.h>
+#include <imgui.h>
+#include <algorithm>
+#include <unordered_set>
 
-void Renderer::Draw(const VertexArray &va, const IndexBuffer &ib, const Shader &shader) const
+namespace
 {
+    // Profiler zones keep the name pointer for as long as the frame history, renderers come and go (the test menu)
+    const char *getZoneName(const std::string &pass)
+    {
+        static std::unordered_set<std::string> names;
+        return names.insert(pass).first->c_str();
+    }
+}
+
+void Renderer::BeginFrame()
+{
+    std::fill(m_FrameDraws.begin(), m_FrameDraws.end(), 0);
+    std::fill(m_FrameElements.begin(), m_FrameElements.end(), 0);
+}
+
+void Renderer::EndFrame()
+{
+    for (size_t p = 0; p < m_Passes.size(); p++)
+    {
+        m_Passes[p].Draws = m_FrameDraws[p];
+        m_Passes[p].Elements = m_FrameElements[p];
+    }
+
+    // Draws of a pass are separate zones of the same name
+    if (Profiler::takeLatestGpuEvents(m_GpuEvents))
+    {
+        m_GpuTimes.assign(m_Passes.size(), -1.0);
+        for (const auto &event : m_GpuEvents)
+        {
+            auto zone = std::find(m_ZoneNames.begin(), m_ZoneNames.end(), event.Name);
+            if (zone == m_ZoneNames.end())
+                continue;
+
+            size_t p = zone - m_ZoneNames.begin();
+            m_GpuTimes[p] = std::max(m_GpuTimes[p], 0.0) + (event.End - event.Start) * 1e-6;
+        }
+
+        for (size_t p = 0; p < m_Passes.size(); p++)
+        {
+            if (m_GpuTimes[p] < 0.0)
+                continue;
+
+            auto &pass = m_Passes[p];
+            pass.AverageGpuTime = pass.GpuTime == 0.0 ? m_GpuTimes[p] : pass.AverageGpuTime * 0.95 + m_GpuTimes[p] * 0.05;
+            pass.GpuTime = m_GpuTimes[p];
+        }
+    }
+
+    // Release builds do not check every call
+    GLCheckErrors("Frame");
+
+    m_Shaders.CheckForChanges();
+}
+
+size_t Renderer::getPassIndex(const std::string &pass) const
+{
+    auto index = m_PassIndices.find(pass);
+    if (index != m_PassIndices.end())
+        return index->second;
+
+    size_t p = m_Passes.size();
+    m_PassIndices.emplace(pass, p);
+    m_ZoneNames.push_back(getZoneName(pass));
+    m_Passes.push_back({ pass });
+    m_FrameDraws.push_back(0);
+    m_FrameElements.push_back(0);
+    return p;
+}
+
+void Renderer::Draw(const VertexArray &va, const IndexBuffer &ib, const Shader &shader, const std::string &pass) const
+{
+    PROFILE_SCOPE("Draw");
+
+    size_t p = getPassIndex(pass);
+    m_FrameDraws[p]++;
+    m_FrameElements[p] += ib.GetCount();
+
+    Profiler::GpuZone gpuZone(m_ZoneNames[p]);
+
     shader.Bind();
     va.Bind();
     ib.Bind();
@@ -14,5 +97,45 @@ void Renderer::Draw(const VertexArray &va, const IndexBuffer &ib, const Shader &
 
 void Renderer::Clear() const
 {
+    PROFILE_GPU_SCOPE("Clear");
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-}
\ No newline at end of file
+}
+
+void Renderer::OnImGuiRender()
+{
+    // GPU times come from the profiler zones
+    const bool hasGpuTimes = Profiler::isEnabled();
+    if (!hasGpuTimes)
+        ImGui::TextDisabled("Enable the profiler for GPU times");
+
+    if (ImGui::BeginTable("Passes", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp))
+    {
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("Draws");
+        ImGui::TableSetupColumn("Indices");
+        ImGui::TableSetupColumn("GPU ms");
+        ImGui::TableSetupColumn("Average GPU ms");
+        ImGui::TableHeadersRow();
+
+        for (const auto &pass : m_Passes)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(pass.Name.c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%u", pass.Draws);
+            ImGui::TableNextColumn(); ImGui::Text("%u", pass.Elements);
+            ImGui::BeginDisabled(!hasGpuTimes);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", pass.GpuTime);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", pass.AverageGpuTime);
+            ImGui::EndDisabled();
+        }
+        ImGui::EndTable();
+    }
+
+    GLMemory::OnImGuiRender();
+
+    if (ImGui::TreeNode("Shaders"))
+    {
+        m_Shaders.OnImGuiRender();
+        ImGui::TreePop();
+    }
+}
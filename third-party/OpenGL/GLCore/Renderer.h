@@ -1,12 +1,81 @@
 #pragma once
 
+#include <string>
+#include <vector>
+#include <unordered_map>
+
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
+#include "ShaderManager.h"
+#include "Profiler.h"
 
+/// <summary>
+/// Issues the draw calls. Every draw is a GPU zone of the profiler named after its pass, the zones the profiler
+/// collected are summed per pass, so the GPU time of every point cloud is known without waiting on the GPU.
+/// </summary>
 class Renderer
 {
 public:
-    void Draw(const VertexArray& va, const IndexBuffer &ib, const Shader& shader) const;
+    struct PassStatistics
+    {
+        std::string Name;
+
+        /// <summary>
+        /// Draw calls and indices of the last frame
+        /// </summary>
+        unsigned int Draws{ 0 };
+        unsigned int Elements{ 0 };
+
+        /// <summary>
+        /// GPU time of the last frame with results and its moving average in milliseconds
+        /// </summary>
+        double GpuTime{ 0.0 };
+        double AverageGpuTime{ 0.0 };
+    };
+
+    Renderer() = default;
+
+    Renderer(const Renderer &) = delete;
+    Renderer &operator=(const Renderer &) = delete;
+
+    /// <summary>
+    /// Called around every frame, EndFrame takes the GPU times the profiler collected and checks for GL errors
+    /// </summary>
+    void BeginFrame();
+    void EndFrame();
+
+    /// <param name="pass">Draws of the same pass are summed in the statistics</param>
+    void Draw(const VertexArray& va, const IndexBuffer &ib, const Shader& shader, const std::string &pass = "Draw") const;
     void Clear() const;
-};
\ No newline at end of file
+
+    const std::vector<PassStatistics> &GetPassStatistics() const { return m_Passes; }
+
+    /// <summary>
+    /// Shared programs, changed shader files are reloaded in EndFrame
+    /// </summary>
+    ShaderManager &GetShaderManager() { return m_Shaders; }
+
+    /// <summary>
+    /// Pass timings and the GPU memory per object
+    /// </summary>
+    void OnImGuiRender();
+private:
+    size_t getPassIndex(const std::string &pass) const;
+
+    ShaderManager m_Shaders;
+
+    // Statistics only, Draw updates them without changing how anything is drawn
+    mutable std::vector<PassStatistics> m_Passes;
+    mutable std::unordered_map<std::string, size_t> m_PassIndices;
+
+    // GPU zone name of every pass, the zones the profiler collected are matched by pointer
+    mutable std::vector<const char *> m_ZoneNames;
+
+    // Counts of the frame being drawn, moved to the statistics in EndFrame
+    mutable std::vector<unsigned int> m_FrameDraws;
+    mutable std::vector<unsigned int> m_FrameElements;
+
+    std::vector<Profiler::Event> m_GpuEvents;
+    std::vector<double> m_GpuTimes;
+};
@@ -16,16 +16,35 @@ Shader::Shader(const std::string &filepath)
     m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
 }
 
+Shader::Shader(const std::string &filepath, unsigned int program)
+    : m_FilePath(filepath), m_RendererID(program)
+{
+}
+
 Shader::~Shader()
 {
     GLCall(glDeleteProgram(m_RendererID));
 }
 
+void Shader::Replace(unsigned int program)
+{
+    GLCall(glDeleteProgram(m_RendererID));
+    m_RendererID = program;
+
+    m_UniformLocationCache.clear();
+    for (auto &[name, location] : m_Uniforms)
+        location = GetUniformLocation(name);
+}
+
 
 ShaderProgramSource Shader::ParseShader(const std::string &filepath)
 {
     std::ifstream stream(filepath);
+    return ParseShader(stream);
+}
 
+ShaderProgramSource Shader::ParseShader(std::istream &stream)
+{
     enum class ShaderType
     {
         NONE = -1, VERTEX = 0, FRAGMENT = 1
@@ -83,12 +102,16 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string &source)
 }
 
 
-unsigned int Shader::CreateShader(const std::string &vertexShader, const std::string &fragmentShader)
+unsigned int Shader::CreateShader(const std::string &vertexShader, const std::string &fragmentShader, bool isRetrievable)
 {
     unsigned int program = glCreateProgram();
     unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
     unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
 
+    // Lets the ShaderManager read the linked program back with glGetProgramBinary
+    if ( isRetrievable )
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
     glAttachShader(program, vs);
     glAttachShader(program, fs);
     glLinkProgram(program);
@@ -97,6 +120,15 @@ unsigned int Shader::CreateShader(const std::string &vertexShader, const std::st
     glDeleteShader(vs);
     glDeleteShader(fs);
 
+    int result;
+    glGetProgramiv(program, GL_LINK_STATUS, &result);
+    if ( result == GL_FALSE || vs == 0 || fs == 0 )
+    {
+        std::cout << "Failed to link shader program!" << std::endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+
     return program;
 }
 
@@ -135,10 +167,48 @@ void Shader::SetUniformMat4f(const std::string &name, const glm::mat4 &matrix)
     GLCall(glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &matrix[0][0]));
 }
 
+Shader::Uniform Shader::GetUniform(const std::string &name)
+{
+    for ( int i = 0; i < (int)m_Uniforms.size(); i++ )
+    {
+        if ( m_Uniforms[i].first == name )
+            return Uniform(i);
+    }
+
+    m_Uniforms.emplace_back(name, GetUniformLocation(name));
+    return Uniform((int)m_Uniforms.size() - 1);
+}
+
+void Shader::SetUniform1i(Uniform uniform, int value)
+{
+    GLCall(glUniform1i(GetUniformLocation(uniform), value));
+}
+
+void Shader::SetUniform1f(Uniform uniform, float value)
+{
+    GLCall(glUniform1f(GetUniformLocation(uniform), value));
+}
+
+void Shader::SetUniform4f(Uniform uniform, float v0, float v1, float v2, float v3)
+{
+    GLCall(glUniform4f(GetUniformLocation(uniform), v0, v1, v2, v3));
+}
+
+void Shader::SetUniformMat3f(Uniform uniform, const glm::mat3 &matrix)
+{
+    GLCall(glUniformMatrix3fv(GetUniformLocation(uniform), 1, GL_FALSE, &matrix[0][0]));
+}
+
+void Shader::SetUniformMat4f(Uniform uniform, const glm::mat4 &matrix)
+{
+    GLCall(glUniformMatrix4fv(GetUniformLocation(uniform), 1, GL_FALSE, &matrix[0][0]));
+}
+
 int Shader::GetUniformLocation(const std::string &name) const
 {
-    if ( m_UniformLocationCache.find(name) != m_UniformLocationCache.end() )
-        return m_UniformLocationCache[name];
+    auto cached = m_UniformLocationCache.find(name);
+    if ( cached != m_UniformLocationCache.end() )
+        return cached->second;
     
     GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
 
@@ -1,5 +1,7 @@
 #pragma once
 #include <string>
+#include <vector>
+#include <istream>
 #include <unordered_map>
 #include "glm/glm.hpp"
 
@@ -11,19 +13,41 @@ struct ShaderProgramSource
 
 class Shader
 {
+	friend class ShaderManager;
+public:
+	/// <summary>
+	/// Pre-resolved uniform for code that sets it every frame, stays valid when the program is reloaded
+	/// </summary>
+	class Uniform
+	{
+	public:
+		Uniform() = default;
+	private:
+		friend class Shader;
+		explicit Uniform(int index) : m_Index(index) { }
+		int m_Index{ -1 };
+	};
 private:
 	std::string m_FilePath;
-	unsigned int m_RendererID;
+	unsigned int m_RendererID{ 0 };
 	// caching for uniforms
 	mutable std::unordered_map<std::string, int> m_UniformLocationCache;
+	// Names and locations of the handed out uniforms
+	std::vector<std::pair<std::string, int>> m_Uniforms;
 public:
 	Shader() =default;
 	Shader(const std::string &filepath);
 	~Shader();
 
+	Shader(const Shader &) = delete;
+	Shader &operator=(const Shader &) = delete;
+
 	void Bind() const;
 	void Unbind() const;
 
+	const std::string &GetFilePath() const { return m_FilePath; }
+	unsigned int GetRendererID() const { return m_RendererID; }
+
 	// Set uniforms
 
 	void SetUniform1i(const std::string &name, int value);
@@ -31,10 +55,28 @@ public:
 	void SetUniform4f(const std::string &name, float v0, float v1, float v2, float v3);
 	void SetUniformMat3f(const std::string &name, const glm::mat3 &matrix);
 	void SetUniformMat4f(const std::string &name, const glm::mat4 &matrix);
+
+	Uniform GetUniform(const std::string &name);
+
+	void SetUniform1i(Uniform uniform, int value);
+	void SetUniform1f(Uniform uniform, float value);
+	void SetUniform4f(Uniform uniform, float v0, float v1, float v2, float v3);
+	void SetUniformMat3f(Uniform uniform, const glm::mat3 &matrix);
+	void SetUniformMat4f(Uniform uniform, const glm::mat4 &matrix);
 private:
-	unsigned int CreateShader(const std::string &vertexShader, const std::string &fragmentShader);
-	ShaderProgramSource ParseShader(const std::string &filepath);
-	unsigned int CompileShader(unsigned int type, const std::string &source);
+	// Takes over a program built by the ShaderManager
+	Shader(const std::string &filepath, unsigned int program);
+
+	/// <summary>
+	/// Replaces the program and resolves the uniforms again
+	/// </summary>
+	void Replace(unsigned int program);
+
+	static unsigned int CreateShader(const std::string &vertexShader, const std::string &fragmentShader, bool isRetrievable = false);
+	static ShaderProgramSource ParseShader(const std::string &filepath);
+	static ShaderProgramSource ParseShader(std::istream &stream);
+	static unsigned int CompileShader(unsigned int type, const std::string &source);
 
 	int GetUniformLocation(const std::string &name) const;
-};
\ No newline at end of file
+	int GetUniformLocation(Uniform uniform) const { return uniform.m_Index < 0 ? -1 : m_Uniforms[uniform.m_Index].second; }
+};
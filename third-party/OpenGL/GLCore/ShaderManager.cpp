@@ -0,0 +1,253 @@
+#include "ShaderManager.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <vector>
+#include <cstring>
+
+#include <GL/glew.h>
+#include <imgui.h>
+
+#include "GLErrorManager.h"
+
+namespace
+{
+    const char BinaryMagic[8] = { 'F', 'E', 'S', 'D', 'S', 'H', 'D', 'R' };
+    const uint32_t BinaryVersion = 1;
+
+    uint64_t hashBytes(const void *data, size_t size, uint64_t hash = 14695981039346656037ull)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < size; i++)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return hash;
+    }
+
+    uint64_t hashString(const char *text, uint64_t hash = 14695981039346656037ull)
+    {
+        return text ? hashBytes(text, std::strlen(text), hash) : hash;
+    }
+
+    std::string normalizePath(const std::string &filepath)
+    {
+        return std::filesystem::path(filepath).lexically_normal().generic_string();
+    }
+}
+
+ShaderManager::ShaderManager(const std::filesystem::path &cacheDirectory)
+    : m_CacheDirectory(cacheDirectory), m_LastCheck(std::chrono::steady_clock::now())
+{
+}
+
+std::shared_ptr<Shader> ShaderManager::Load(const std::string &filepath)
+{
+    std::string key = normalizePath(filepath);
+    auto existing = m_Shaders.find(key);
+    if (existing != m_Shaders.end())
+        return existing->second.Program;
+
+    Entry entry;
+    unsigned int program = Build(key, entry);
+    entry.Program = std::shared_ptr<Shader>(new Shader(key, program));
+    return m_Shaders.emplace(key, std::move(entry)).first->second.Program;
+}
+
+void ShaderManager::CheckForChanges()
+{
+    auto now = std::chrono::steady_clock::now();
+    if (!m_HotReload || now - m_LastCheck < std::chrono::milliseconds(500))
+        return;
+    m_LastCheck = now;
+
+    for (auto &[filepath, entry] : m_Shaders)
+    {
+        std::error_code error;
+        auto writeTime = std::filesystem::last_write_time(filepath, error);
+        if (!error && writeTime != entry.WriteTime)
+            Reload(filepath, entry);
+    }
+}
+
+void ShaderManager::Reload(const std::string &filepath, Entry &entry)
+{
+    // A failed build is not retried until the file changes again
+    Entry rebuilt;
+    unsigned int program = Build(filepath, rebuilt);
+    entry.WriteTime = rebuilt.WriteTime;
+    if (program == 0)
+    {
+        std::cout << "[WARNING] Reloading '" << filepath << "' failed, keeping the previous program" << std::endl;
+        return;
+    }
+
+    entry.Program->Replace(program);
+    entry.IsFromCache = rebuilt.IsFromCache;
+    entry.BuildTime = rebuilt.BuildTime;
+    std::cout << "Reloaded shader '" << filepath << "'" << std::endl;
+}
+
+unsigned int ShaderManager::Build(const std::string &filepath, Entry &entry)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::error_code error;
+    entry.WriteTime = std::filesystem::last_write_time(filepath, error);
+
+    std::ifstream file(filepath);
+    if (!file.is_open())
+    {
+        std::cout << "[ERROR] Could not open shader '" << filepath << "'" << std::endl;
+        return 0;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    std::string source = text.str();
+
+    const uint64_t sourceHash = hashBytes(source.data(), source.size());
+    const bool useCache = m_UseBinaryCache && IsBinarySupported();
+    const auto cacheFile = GetCacheFile(filepath);
+
+    unsigned int program = useCache ? LoadBinary(cacheFile, sourceHash) : 0;
+    entry.IsFromCache = program != 0;
+    if (program == 0)
+    {
+        std::istringstream stream(source);
+        ShaderProgramSource sources = Shader::ParseShader(stream);
+        program = Shader::CreateShader(sources.VertexSource, sources.FragmentSource, useCache);
+
+        if (program != 0 && useCache)
+            SaveBinary(program, cacheFile, sourceHash);
+    }
+
+    std::chrono::duration<double, std::milli> buildTime = std::chrono::high_resolution_clock::now() - start;
+    entry.BuildTime = buildTime.count();
+    return program;
+}
+
+bool ShaderManager::IsBinarySupported()
+{
+    if (m_IsBinarySupported < 0)
+    {
+        GLint formats = 0;
+        if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        m_IsBinarySupported = formats > 0;
+
+        m_DriverHash = hashString(reinterpret_cast<const char *>(glGetString(GL_VENDOR)));
+        m_DriverHash = hashString(reinterpret_cast<const char *>(glGetString(GL_RENDERER)), m_DriverHash);
+        m_DriverHash = hashString(reinterpret_cast<const char *>(glGetString(GL_VERSION)), m_DriverHash);
+    }
+    return m_IsBinarySupported > 0;
+}
+
+std::filesystem::path ShaderManager::GetCacheFile(const std::string &filepath) const
+{
+    // One file per shader, a changed source overwrites its old binary
+    char name[32];
+    snprintf(name, sizeof(name), "-%016llx.glbin", (unsigned long long)hashString(filepath.c_str()));
+    return m_CacheDirectory / (std::filesystem::path(filepath).stem().string() + name);
+}
+
+unsigned int ShaderManager::LoadBinary(const std::filesystem::path &cacheFile, uint64_t sourceHash)
+{
+    std::ifstream file(cacheFile, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return 0;
+
+    BinaryHeader header{};
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file.good() || std::memcmp(header.Magic, BinaryMagic, sizeof(BinaryMagic)) != 0 || header.Version != BinaryVersion ||
+        header.SourceHash != sourceHash || header.DriverHash != m_DriverHash || header.Length == 0)
+        return 0;
+
+    std::vector<char> binary(header.Length);
+    file.read(binary.data(), binary.size());
+    if (!file.good())
+        return 0;
+
+    // The driver may still reject a binary, the caller then compiles from source
+    unsigned int program = glCreateProgram();
+    glProgramBinary(program, header.Format, binary.data(), (GLsizei)binary.size());
+
+    int result = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &result);
+    if (result == GL_FALSE)
+    {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void ShaderManager::SaveBinary(unsigned int program, const std::filesystem::path &cacheFile, uint64_t sourceHash)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(m_CacheDirectory, error);
+
+    BinaryHeader header{};
+    std::memcpy(header.Magic, BinaryMagic, sizeof(BinaryMagic));
+    header.Version = BinaryVersion;
+    header.Format = format;
+    header.DriverHash = m_DriverHash;
+    header.SourceHash = sourceHash;
+    header.Length = (uint32_t)length;
+
+    // Written next to the cache file and renamed, a crash never leaves a half written binary
+    auto temporary = cacheFile;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(binary.data(), length);
+        if (!file.good())
+            return;
+    }
+    std::filesystem::rename(temporary, cacheFile, error);
+    if (error)
+        std::cout << "[WARNING] Could not write shader cache '" << cacheFile.string() << "': " << error.message() << std::endl;
+}
+
+void ShaderManager::OnImGuiRender()
+{
+    ImGui::Checkbox("Hot Reload Shaders", &m_HotReload);
+    ImGui::SameLine();
+    ImGui::Checkbox("Binary Cache", &m_UseBinaryCache);
+
+    if (!ImGui::BeginTable("Shaders", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp))
+        return;
+
+    ImGui::TableSetupColumn("Shader");
+    ImGui::TableSetupColumn("Users");
+    ImGui::TableSetupColumn("Build");
+    ImGui::TableSetupColumn("");
+    ImGui::TableHeadersRow();
+
+    for (auto &[filepath, entry] : m_Shaders)
+    {
+        ImGui::PushID(filepath.c_str());
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn(); ImGui::TextUnformatted(filepath.c_str());
+        ImGui::TableNextColumn(); ImGui::Text("%ld", entry.Program.use_count() - 1);
+        ImGui::TableNextColumn();
+        if (entry.Program->GetRendererID() == 0)
+            ImGui::TextColored({ 1.0f, 0.3f, 0.3f, 1.0f }, "Failed");
+        else
+            ImGui::Text("%.2f ms%s", entry.BuildTime, entry.IsFromCache ? " (cached)" : "");
+
+        ImGui::TableNextColumn();
+        if (ImGui::SmallButton("Reload"))
+            Reload(filepath, entry);
+        ImGui::PopID();
+    }
+    ImGui::EndTable();
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <filesystem>
+#include <chrono>
+#include <cstdint>
+
+#include "Shader.h"
+
+/// <summary>
+/// Owns the shader programs, every file is built once and shared by all objects that load it.
+/// Linked programs are cached on disk as program binaries, checked against the source and the driver, so later
+/// starts skip compiling. Changed shader files are rebuilt while running and swapped into the shared Shader,
+/// a file that fails to build keeps the program it had.
+/// </summary>
+class ShaderManager
+{
+public:
+	ShaderManager(const std::filesystem::path &cacheDirectory = "shadercache");
+
+	/// <returns>The shared program of the file, its program id is 0 if the first build failed</returns>
+	std::shared_ptr<Shader> Load(const std::string &filepath);
+
+	/// <summary>
+	/// Rebuilds the shaders whose file changed, looks at the files at most twice a second
+	/// </summary>
+	void CheckForChanges();
+
+	void OnImGuiRender();
+
+	bool m_HotReload{ true };
+	bool m_UseBinaryCache{ true };
+private:
+	struct Entry
+	{
+		std::shared_ptr<Shader> Program;
+		std::filesystem::file_time_type WriteTime;
+		bool IsFromCache{ false };
+		double BuildTime{ 0.0 };
+	};
+
+	struct BinaryHeader
+	{
+		char Magic[8];
+		uint32_t Version;
+		uint32_t Format;
+		uint64_t DriverHash;
+		uint64_t SourceHash;
+		uint32_t Length;
+		uint32_t Reserved;
+	};
+	static_assert(sizeof(BinaryHeader) == 40);
+
+	/// <returns>The linked program, 0 if the file could not be built</returns>
+	unsigned int Build(const std::string &filepath, Entry &entry);
+
+	/// <summary>
+	/// Builds the file again and swaps the program into the shared Shader if it succeeds
+	/// </summary>
+	void Reload(const std::string &filepath, Entry &entry);
+
+	unsigned int LoadBinary(const std::filesystem::path &cacheFile, uint64_t sourceHash);
+	void SaveBinary(unsigned int program, const std::filesystem::path &cacheFile, uint64_t sourceHash);
+	std::filesystem::path GetCacheFile(const std::string &filepath) const;
+	bool IsBinarySupported();
+
+	std::filesystem::path m_CacheDirectory;
+	std::unordered_map<std::string, Entry> m_Shaders;
+	std::chrono::steady_clock::time_point m_LastCheck;
+
+	// Vendor, renderer and version, a driver update makes the cached binaries useless
+	uint64_t m_DriverHash{ 0 };
+	int m_IsBinarySupported{ -1 };
+};
@@ -1,6 +1,7 @@
 #include "Texture.h"
 #include <GL/glew.h>
 #include "GLErrorManager.h"
+#include "GLMemory.h"
 #include "stb_image/stb_image.h"
 
 Texture::Texture(const std::string &path)
@@ -21,12 +22,16 @@ Texture::Texture(const std::string &path)
 	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
 	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
 
+	// Stored as RGBA8 without mipmaps
+	mp_MemoryOwner = GLMemory::allocate(GLMemory::Kind::Texture, (size_t)m_Width * m_Height * 4);
+
 	if (m_LocalBuffer)
 		stbi_image_free(m_LocalBuffer);	
 }
 
 Texture::~Texture()
 {
+	GLMemory::release(mp_MemoryOwner, GLMemory::Kind::Texture, (size_t)m_Width * m_Height * 4);
 	GLCall(glDeleteTextures(1, &m_RendererID))
 }
 
@@ -22,10 +22,11 @@ public:
 	}
 
 private:
-	unsigned int m_RendererID;
+	unsigned int m_RendererID{ 0 };
 	std::string m_FilePath;
 	unsigned char *m_LocalBuffer;
-	int m_Width;
-	int m_Height;
+	int m_Width{ 0 };
+	int m_Height{ 0 };
 	int m_BPP;
+	const void *mp_MemoryOwner{ nullptr };
 };
\ No newline at end of file
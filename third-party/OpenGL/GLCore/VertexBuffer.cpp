@@ -1,10 +1,12 @@
 #include "VertexBuffer.h"
 
 #include "GLErrorManager.h"
+#include "GLMemory.h"
 
 #include <GL/glew.h>
 
 VertexBuffer::VertexBuffer(const void *data, unsigned int size)
+    : m_Size(size), mp_MemoryOwner(GLMemory::allocate(GLMemory::Kind::VertexBuffer, size))
 {
     GLCall(glGenBuffers(1, &m_RendererID));
     GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
@@ -12,6 +14,7 @@ VertexBuffer::VertexBuffer(const void *data, unsigned int size)
 }
 
 VertexBuffer::VertexBuffer(unsigned int size)
+    : m_Size(size), mp_MemoryOwner(GLMemory::allocate(GLMemory::Kind::VertexBuffer, size))
 {
     GLCall(glGenBuffers(1, &m_RendererID));
     GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
@@ -20,6 +23,7 @@ VertexBuffer::VertexBuffer(unsigned int size)
 
 VertexBuffer::~VertexBuffer()
 {
+    GLMemory::release(mp_MemoryOwner, GLMemory::Kind::VertexBuffer, m_Size);
     GLCall(glDeleteBuffers(1, &m_RendererID));
 }
 
@@ -3,7 +3,9 @@
 class VertexBuffer
 {
 private:
-	unsigned int m_RendererID;
+	unsigned int m_RendererID{ 0 };
+	unsigned int m_Size{ 0 };
+	const void *mp_MemoryOwner{ nullptr };
 public:
 	VertexBuffer() = default;
 	VertexBuffer(const void* data, unsigned int size);